@@ -266,6 +266,22 @@ int ogs_app_context_parse_config(void)
                 } else if (!strcmp(logger_key, "domain")) {
                     self.logger.domain =
                         ogs_yaml_iter_value(&logger_iter);
+                } else if (!strcmp(logger_key, "async")) {
+                    ogs_yaml_iter_t async_iter;
+                    ogs_yaml_iter_recurse(&logger_iter, &async_iter);
+                    while (ogs_yaml_iter_next(&async_iter)) {
+                        const char *async_key =
+                            ogs_yaml_iter_key(&async_iter);
+                        ogs_assert(async_key);
+                        if (!strcmp(async_key, "enabled")) {
+                            self.logger.async.enabled =
+                                ogs_yaml_iter_bool(&async_iter);
+                        } else if (!strcmp(async_key, "size")) {
+                            const char *v = ogs_yaml_iter_value(&async_iter);
+                            if (v) self.logger.async.size = atoll(v);
+                        } else
+                            ogs_warn("unknown key `%s`", async_key);
+                    }
                 }
             }
         } else if (!strcmp(root_key, "parameter")) {
@@ -515,6 +531,16 @@ int ogs_app_context_parse_config(void)
                         } else
                             ogs_warn("unknown key `%s`", msg_key);
                     }
+                } else if (!strcmp(time_key, "timer")) {
+                    const char *v = ogs_yaml_iter_value(&time_iter);
+                    if (v) {
+                        if (!strcmp(v, "wheel"))
+                            self.time.timer_wheel = true;
+                        else if (!strcmp(v, "rbtree"))
+                            self.time.timer_wheel = false;
+                        else
+                            ogs_warn("unknown timer `%s`", v);
+                    }
                 } else if (!strcmp(time_key, "t3502")) {
                     /* handle config in amf */
                 } else if (!strcmp(time_key, "t3512")) {
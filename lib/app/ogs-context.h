@@ -47,6 +47,11 @@ typedef struct ogs_app_context_s {
         const char *file;
         const char *level;
         const char *domain;
+
+        struct {
+            bool enabled;
+            size_t size;
+        } async;
     } logger;
 
     ogs_queue_t *queue;
@@ -172,6 +177,7 @@ typedef struct ogs_app_context_s {
             ogs_time_t complete_delay;
         } handover;
 
+        bool timer_wheel;
     } time;
 
     struct metrics {
@@ -110,6 +110,11 @@ int ogs_app_initialize(
             ogs_app()->logger.domain, ogs_app()->logger.level);
     if (rv != OGS_OK) return rv;
 
+    if (ogs_app()->logger.async.enabled) {
+        rv = ogs_log_async_start(ogs_app()->logger.async.size);
+        if (rv != OGS_OK) return rv;
+    }
+
     /**************************************************************************
      * Stage 5 : Setup Database Module
      */
@@ -137,11 +142,16 @@ int ogs_app_initialize(
     }
 
     /**************************************************************************
-     * Stage 7 : Queue, Timer and Poll
+     * Stage 7 : Event, Queue, Timer and Poll
      */
+    ogs_event_init(ogs_app()->pool.event);
     ogs_app()->queue = ogs_queue_create(ogs_app()->pool.event);
     ogs_assert(ogs_app()->queue);
-    ogs_app()->timer_mgr = ogs_timer_mgr_create(ogs_app()->pool.timer);
+    if (ogs_app()->time.timer_wheel)
+        ogs_app()->timer_mgr =
+            ogs_timer_mgr_create_wheel(ogs_app()->pool.timer);
+    else
+        ogs_app()->timer_mgr = ogs_timer_mgr_create(ogs_app()->pool.timer);
     ogs_assert(ogs_app()->timer_mgr);
     ogs_app()->pollset = ogs_pollset_create(ogs_app()->pool.socket);
     ogs_assert(ogs_app()->pollset);
@@ -153,6 +163,8 @@ void ogs_app_terminate(void)
 {
     ogs_app_context_final();
 
+    ogs_event_final();
+
     ogs_pkbuf_default_destroy();
 
     ogs_core_terminate();
@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "asn_arena.h"
+
+#define OGS_ASN_ARENA_MIN_SIZE 4096
+
+/* Every block is prefixed with its size, so that REALLOC can copy it */
+typedef struct ogs_asn_arena_block_s {
+    size_t size;
+} ogs_asn_arena_block_t;
+
+#define OGS_ASN_ARENA_ALIGN(size) (((size) + 7) & ~((size_t)7))
+#define OGS_ASN_ARENA_HEADER OGS_ASN_ARENA_ALIGN(sizeof(ogs_asn_arena_block_t))
+
+#define arena_block_of(ptr) \
+    ((ogs_asn_arena_block_t *)((char *)(ptr) - OGS_ASN_ARENA_HEADER))
+
+typedef struct ogs_asn_arena_chunk_s {
+    struct ogs_asn_arena_chunk_s *next;
+    size_t size;
+    size_t used;
+    uint64_t data[1];
+} ogs_asn_arena_chunk_t;
+
+#define OGS_ASN_ARENA_CHUNK_HEADER offsetof(ogs_asn_arena_chunk_t, data)
+
+struct ogs_asn_arena_s {
+    ogs_lnode_t lnode;              /* live arenas of this thread */
+
+    const void *owner;
+    bool detached;                  /* 'owner' may hold non-arena blocks */
+
+    ogs_asn_arena_chunk_t *chunk;   /* current chunk, head of the chain */
+    void *last;                     /* last block, may grow in place */
+
+    ogs_asn_arena_t *prev;          /* arena entered before this one */
+};
+
+/*
+ * Arenas still holding a decoded structure on this thread, newest first.
+ * There are rarely more than one or two, so a list costs no allocation
+ * and is short to search.
+ */
+static ogs_thread_local ogs_list_t arena_list;
+static ogs_thread_local ogs_asn_arena_t *current;
+
+static ogs_asn_arena_chunk_t *chunk_alloc(size_t size)
+{
+    ogs_asn_arena_chunk_t *chunk = NULL;
+
+    chunk = ogs_malloc(OGS_ASN_ARENA_CHUNK_HEADER + size);
+    if (!chunk) {
+        ogs_fatal("ogs_malloc() failed [size=%d]", (int)size);
+        ogs_assert_if_reached();
+    }
+
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+
+    return chunk;
+}
+
+static bool chunk_owns(ogs_asn_arena_chunk_t *chunk, const void *ptr)
+{
+    const char *data = (const char *)chunk->data;
+
+    return (const char *)ptr >= data && (const char *)ptr < data + chunk->size;
+}
+
+ogs_asn_arena_t *ogs_asn_arena_create(const void *owner, size_t hint)
+{
+    ogs_asn_arena_t *arena = NULL;
+
+    ogs_assert(owner);
+
+    /* The previous content of 'owner' is about to be overwritten */
+    arena = ogs_asn_arena_find(owner);
+    if (arena)
+        ogs_asn_arena_destroy(arena);
+
+    arena = ogs_calloc(1, sizeof(*arena));
+    if (!arena) {
+        ogs_fatal("ogs_calloc() failed");
+        ogs_assert_if_reached();
+    }
+
+    arena->owner = owner;
+    arena->chunk = chunk_alloc(
+            OGS_ASN_ARENA_ALIGN(ogs_max(hint, OGS_ASN_ARENA_MIN_SIZE)));
+
+    ogs_list_prepend(&arena_list, arena);
+
+    return arena;
+}
+
+void ogs_asn_arena_destroy(ogs_asn_arena_t *arena)
+{
+    ogs_asn_arena_chunk_t *chunk = NULL, *next = NULL;
+
+    ogs_assert(arena);
+    ogs_assert(arena != current);
+
+    ogs_list_remove(&arena_list, arena);
+
+    for (chunk = arena->chunk; chunk; chunk = next) {
+        next = chunk->next;
+        ogs_free(chunk);
+    }
+
+    ogs_free(arena);
+}
+
+ogs_asn_arena_t *ogs_asn_arena_find(const void *owner)
+{
+    ogs_asn_arena_t *arena = NULL;
+
+    ogs_list_for_each(&arena_list, arena) {
+        if (arena->owner == owner)
+            return arena;
+    }
+
+    return NULL;
+}
+
+void ogs_asn_arena_detach(ogs_asn_arena_t *arena)
+{
+    ogs_assert(arena);
+    arena->detached = true;
+}
+
+bool ogs_asn_arena_attached(ogs_asn_arena_t *arena)
+{
+    ogs_assert(arena);
+    return arena->detached == false;
+}
+
+void ogs_asn_arena_enter(ogs_asn_arena_t *arena)
+{
+    ogs_assert(arena);
+
+    arena->prev = current;
+    current = arena;
+}
+
+void ogs_asn_arena_leave(ogs_asn_arena_t *arena)
+{
+    ogs_assert(arena);
+    ogs_assert(arena == current);
+
+    current = arena->prev;
+    arena->prev = NULL;
+}
+
+static void *arena_alloc(ogs_asn_arena_t *arena, size_t size)
+{
+    ogs_asn_arena_chunk_t *chunk = NULL;
+    ogs_asn_arena_block_t *block = NULL;
+    size_t need;
+
+    ogs_assert(arena);
+
+    need = OGS_ASN_ARENA_HEADER + OGS_ASN_ARENA_ALIGN(size);
+
+    chunk = arena->chunk;
+    if (chunk->size - chunk->used < need) {
+        chunk = chunk_alloc(ogs_max(chunk->size * 2, need));
+        chunk->next = arena->chunk;
+        arena->chunk = chunk;
+    }
+
+    block = (ogs_asn_arena_block_t *)((char *)chunk->data + chunk->used);
+    chunk->used += need;
+
+    block->size = size;
+    arena->last = (char *)block + OGS_ASN_ARENA_HEADER;
+
+    return arena->last;
+}
+
+/*
+ * 'ptr' may come from the heap, so only the chunk ranges are looked at :
+ * the block header in front of it is read once 'ptr' is known to be
+ * an arena block.
+ */
+static ogs_asn_arena_t *arena_find_by_ptr(const void *ptr)
+{
+    ogs_asn_arena_t *arena = NULL;
+    ogs_asn_arena_chunk_t *chunk = NULL;
+
+    ogs_list_for_each(&arena_list, arena) {
+        for (chunk = arena->chunk; chunk; chunk = chunk->next) {
+            if (chunk_owns(chunk, ptr))
+                return arena;
+        }
+    }
+
+    return NULL;
+}
+
+void *ogs_asn_arena_malloc(size_t size)
+{
+    if (!current)
+        return NULL;
+
+    return arena_alloc(current, size);
+}
+
+void *ogs_asn_arena_realloc(void *oldptr, size_t size)
+{
+    ogs_asn_arena_t *arena = NULL;
+    ogs_asn_arena_chunk_t *chunk = NULL;
+    size_t oldsize;
+    void *ptr = NULL;
+
+    if (!oldptr)
+        return ogs_asn_arena_malloc(size);
+
+    arena = arena_find_by_ptr(oldptr);
+    if (!arena)
+        return NULL;
+
+    oldsize = arena_block_of(oldptr)->size;
+
+    /* The last block of the current chunk grows in place */
+    chunk = arena->chunk;
+    if (oldptr == arena->last &&
+        OGS_ASN_ARENA_ALIGN(size) <= OGS_ASN_ARENA_ALIGN(oldsize) +
+            (chunk->size - chunk->used)) {
+        chunk->used += OGS_ASN_ARENA_ALIGN(size);
+        chunk->used -= OGS_ASN_ARENA_ALIGN(oldsize);
+        arena_block_of(oldptr)->size = size;
+        return oldptr;
+    }
+
+    ptr = arena_alloc(arena, size);
+    memcpy(ptr, oldptr, ogs_min(oldsize, size));
+
+    return ptr;
+}
+
+bool ogs_asn_arena_owns(const void *ptr)
+{
+    if (!ptr)
+        return false;
+
+    return arena_find_by_ptr(ptr) != NULL;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef OGS_ASN_ARENA_H
+#define OGS_ASN_ARENA_H
+
+#include "ogs-core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Decode Arena
+ *
+ * A PDU is decoded with an arena entered on the current thread.
+ * Until it is left, CALLOC/MALLOC/REALLOC of the asn1c support code
+ * bump-allocate from the arena. FREEMEM of an arena pointer does nothing,
+ * and the whole PDU is released at once with ogs_asn_arena_destroy().
+ *
+ * An arena belongs to the decoded structure ('owner') and to the thread
+ * that created it. It must be destroyed on that same thread.
+ *
+ * The owner is taken to hold only arena blocks until the arena is
+ * detached, which a caller does before storing heap blocks in it or
+ * building another structure at its address. A detached owner is freed
+ * field by field; FREEMEM still skips the blocks of the arena, which
+ * is destroyed afterwards.
+ */
+typedef struct ogs_asn_arena_s ogs_asn_arena_t;
+
+ogs_asn_arena_t *ogs_asn_arena_create(const void *owner, size_t hint);
+void ogs_asn_arena_destroy(ogs_asn_arena_t *arena);
+ogs_asn_arena_t *ogs_asn_arena_find(const void *owner);
+
+void ogs_asn_arena_detach(ogs_asn_arena_t *arena);
+bool ogs_asn_arena_attached(ogs_asn_arena_t *arena);
+
+void ogs_asn_arena_enter(ogs_asn_arena_t *arena);
+void ogs_asn_arena_leave(ogs_asn_arena_t *arena);
+
+/* Used by CALLOC/MALLOC/REALLOC/FREEMEM in asn_internal.h */
+void *ogs_asn_arena_malloc(size_t size);
+void *ogs_asn_arena_realloc(void *oldptr, size_t size);
+bool ogs_asn_arena_owns(const void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_ASN_ARENA_H */
@@ -19,6 +19,13 @@
 
 #include "conv.h"
 
+#include "INTEGER.h"
+#include "NULL.h"
+#include "NativeInteger.h"
+#include "constr_CHOICE.h"
+#include "constr_SEQUENCE.h"
+#include "constr_SET_OF.h"
+
 void ogs_asn_uint8_to_OCTET_STRING(
         uint8_t uint8, OCTET_STRING_t *octet_string)
 {
@@ -211,16 +218,13 @@ int ogs_asn_ip_to_BIT_STRING(ogs_ip_t *ip, BIT_STRING_t *bit_string)
     return OGS_OK;
 }
 
-int ogs_asn_copy_ie(const asn_TYPE_descriptor_t *td, void *src, void *dst)
+static int copy_ie_by_aper(
+        const asn_TYPE_descriptor_t *td, void *src, void *dst)
 {
     asn_enc_rval_t enc_ret = {0};
     asn_dec_rval_t dec_ret = {0};
     uint8_t *buffer = NULL;
 
-    ogs_assert(td);
-    ogs_assert(src);
-    ogs_assert(dst);
-
     buffer = ogs_calloc(1, OGS_MAX_SDU_LEN);
     if (!buffer) {
         ogs_error("ogs_calloc() failed");
@@ -247,3 +251,176 @@ int ogs_asn_copy_ie(const asn_TYPE_descriptor_t *td, void *src, void *dst)
 
     return OGS_OK;
 }
+
+/*
+ * Structural Deep Copy
+ *
+ * The kind of a type is told by its free_struct operation, which is
+ * shared by every type derived from the same base (e.g. all the BIT STRING
+ * and OCTET STRING types use OCTET_STRING_free). The destination must be
+ * zeroed. Each pointer or list entry is linked into the destination before
+ * it is filled, so a partial copy can always be freed.
+ */
+static size_t asn_struct_size(const asn_TYPE_descriptor_t *td)
+{
+    asn_struct_free_f *free_struct = td->op->free_struct;
+
+    if (free_struct == SEQUENCE_free)
+        return ((const asn_SEQUENCE_specifics_t *)td->specifics)->struct_size;
+    if (free_struct == CHOICE_free)
+        return ((const asn_CHOICE_specifics_t *)td->specifics)->struct_size;
+    if (free_struct == SET_OF_free)
+        return ((const asn_SET_OF_specifics_t *)td->specifics)->struct_size;
+    if (free_struct == OCTET_STRING_free)
+        return td->specifics ?
+            ((const asn_OCTET_STRING_specifics_t *)
+                td->specifics)->struct_size :
+            asn_SPC_OCTET_STRING_specs.struct_size;
+    if (free_struct == INTEGER_free || free_struct == ASN__PRIMITIVE_TYPE_free)
+        return sizeof(ASN__PRIMITIVE_TYPE_t);
+    if (free_struct == NativeInteger_free)
+        return sizeof(long);
+    if (free_struct == NULL_free)
+        return sizeof(NULL_t);
+
+    return 0;
+}
+
+static int asn_copy(const asn_TYPE_descriptor_t *td,
+        const void *src, void *dst);
+
+static int asn_copy_member(const asn_TYPE_member_t *elm,
+        const void *src, void *dst)
+{
+    const void *smemb = NULL;
+    void **dmemb = NULL;
+    size_t size;
+
+    if (!(elm->flags & ATF_POINTER))
+        return asn_copy(elm->type,
+                (const char *)src + elm->memb_offset,
+                (char *)dst + elm->memb_offset);
+
+    smemb = *(void * const *)((const char *)src + elm->memb_offset);
+    if (!smemb)
+        return OGS_OK;
+
+    size = asn_struct_size(elm->type);
+    if (!size)
+        return OGS_ERROR;
+
+    dmemb = (void **)((char *)dst + elm->memb_offset);
+    *dmemb = CALLOC(1, size);
+    ogs_assert(*dmemb);
+
+    return asn_copy(elm->type, smemb, *dmemb);
+}
+
+static int asn_copy(const asn_TYPE_descriptor_t *td,
+        const void *src, void *dst)
+{
+    asn_struct_free_f *free_struct = td->op->free_struct;
+    size_t i;
+
+    if (free_struct == SEQUENCE_free) {
+        for (i = 0; i < td->elements_count; i++) {
+            if (asn_copy_member(&td->elements[i], src, dst) != OGS_OK)
+                return OGS_ERROR;
+        }
+
+    } else if (free_struct == CHOICE_free) {
+        const asn_CHOICE_specifics_t *specs = td->specifics;
+        unsigned present;
+
+        present = _fetch_present_idx(src, specs->pres_offset, specs->pres_size);
+        _set_present_idx(dst, specs->pres_offset, specs->pres_size, present);
+
+        if (present > 0 && present <= td->elements_count)
+            return asn_copy_member(&td->elements[present-1], src, dst);
+
+    } else if (free_struct == SET_OF_free) {
+        const asn_anonymous_set_ *slist = _A_CSET_FROM_VOID(src);
+        asn_anonymous_set_ *dlist = _A_SET_FROM_VOID(dst);
+        const asn_TYPE_descriptor_t *type = td->elements[0].type;
+        size_t size;
+        void *item = NULL;
+        int n;
+
+        size = asn_struct_size(type);
+        if (!size)
+            return OGS_ERROR;
+
+        for (n = 0; n < slist->count; n++) {
+            if (!slist->array[n])
+                continue;
+
+            item = CALLOC(1, size);
+            ogs_assert(item);
+            ogs_assert(asn_set_add(dlist, item) == 0);
+
+            if (asn_copy(type, slist->array[n], item) != OGS_OK)
+                return OGS_ERROR;
+        }
+
+    } else if (free_struct == OCTET_STRING_free) {
+        const asn_OCTET_STRING_specifics_t *specs = td->specifics ?
+            td->specifics : &asn_SPC_OCTET_STRING_specs;
+        const OCTET_STRING_t *sstr = src;
+        OCTET_STRING_t *dstr = dst;
+
+        /* BIT STRING keeps 'bits_unused' after the common part */
+        memcpy(dst, src, specs->struct_size);
+        memset((char *)dst + specs->ctx_offset, 0, sizeof(asn_struct_ctx_t));
+
+        dstr->buf = NULL;
+        if (sstr->buf) {
+            dstr->buf = MALLOC(sstr->size + 1);
+            ogs_assert(dstr->buf);
+            memcpy(dstr->buf, sstr->buf, sstr->size);
+            dstr->buf[sstr->size] = 0;
+        }
+
+    } else if (free_struct == INTEGER_free ||
+                free_struct == ASN__PRIMITIVE_TYPE_free) {
+        const ASN__PRIMITIVE_TYPE_t *sprim = src;
+        ASN__PRIMITIVE_TYPE_t *dprim = dst;
+
+        dprim->size = sprim->size;
+        if (sprim->buf) {
+            dprim->buf = MALLOC(sprim->size + 1);
+            ogs_assert(dprim->buf);
+            memcpy(dprim->buf, sprim->buf, sprim->size);
+            dprim->buf[sprim->size] = 0;
+        }
+
+    } else if (free_struct == NativeInteger_free || free_struct == NULL_free) {
+        memcpy(dst, src, asn_struct_size(td));
+
+    } else {
+        ogs_warn("Cannot copy %s by structure", td->name);
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+int ogs_asn_copy_ie(const asn_TYPE_descriptor_t *td, void *src, void *dst)
+{
+    size_t size;
+
+    ogs_assert(td);
+    ogs_assert(src);
+    ogs_assert(dst);
+
+    size = asn_struct_size(td);
+    if (size) {
+        if (asn_copy(td, src, dst) == OGS_OK)
+            return OGS_OK;
+
+        ASN_STRUCT_FREE_CONTENTS_ONLY(*td, dst);
+        memset(dst, 0, size);
+    }
+
+    /* Types that are not known to asn_copy() */
+    return copy_ie_by_aper(td, src, dst);
+}
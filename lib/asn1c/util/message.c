@@ -19,6 +19,8 @@
 
 #include "message.h"
 
+#define OGS_ASN_ARENA_HINT_RATIO 8
+
 ogs_pkbuf_t *ogs_asn_encode(const asn_TYPE_descriptor_t *td, void *sptr)
 {
     asn_enc_rval_t enc_ret = {0};
@@ -36,6 +38,9 @@ ogs_pkbuf_t *ogs_asn_encode(const asn_TYPE_descriptor_t *td, void *sptr)
 
     enc_ret = aper_encode_to_buffer(td, NULL,
                     sptr, pkbuf->data, OGS_MAX_SDU_LEN);
+
+    /* A built structure : any arena left at its address is not its own */
+    ogs_asn_detach(sptr);
     ogs_asn_free(td, sptr);
 
     if (enc_ret.encoded < 0) {
@@ -46,13 +51,16 @@ ogs_pkbuf_t *ogs_asn_encode(const asn_TYPE_descriptor_t *td, void *sptr)
 
     ogs_pkbuf_trim(pkbuf, ((enc_ret.encoded + 7) >> 3));
 
-    return pkbuf;
+    /* NGAP/S1AP PDUs are mostly a few hundred bytes.
+     * Do not keep the OGS_MAX_SDU_LEN scratch buffer around. */
+    return ogs_pkbuf_fit(pkbuf, 0, 0);
 }
 
 int ogs_asn_decode(const asn_TYPE_descriptor_t *td,
         void *struct_ptr, size_t struct_size, ogs_pkbuf_t *pkbuf)
 {
     asn_dec_rval_t dec_ret = {0};
+    ogs_asn_arena_t *arena = NULL;
 
     ogs_assert(td);
     ogs_assert(struct_ptr);
@@ -61,13 +69,27 @@ int ogs_asn_decode(const asn_TYPE_descriptor_t *td,
     ogs_assert(pkbuf->data);
     ogs_assert(pkbuf->len);
 
+    /*
+     * The whole PDU is decoded into one arena owned by 'struct_ptr',
+     * which ogs_asn_free() releases without walking the structure.
+     * The decoded structure takes several times the size of the PDU.
+     */
+    arena = ogs_asn_arena_create(struct_ptr,
+            pkbuf->len * OGS_ASN_ARENA_HINT_RATIO);
+    ogs_assert(arena);
+
     memset(struct_ptr, 0, struct_size);
+
+    ogs_asn_arena_enter(arena);
     dec_ret = aper_decode(NULL, td, (void **)&struct_ptr,
             pkbuf->data, pkbuf->len, 0, 0);
+    ogs_asn_arena_leave(arena);
 
     if (dec_ret.code != RC_OK) {
         ogs_warn("Failed to decode ASN-PDU [code:%d,consumed:%d]",
                 dec_ret.code, (int)dec_ret.consumed);
+        ogs_asn_arena_destroy(arena);
+        memset(struct_ptr, 0, struct_size);
         return OGS_ERROR;
     }
 
@@ -76,8 +98,36 @@ int ogs_asn_decode(const asn_TYPE_descriptor_t *td,
 
 void ogs_asn_free(const asn_TYPE_descriptor_t *td, void *sptr)
 {
+    ogs_asn_arena_t *arena = NULL;
+
     ogs_assert(td);
     ogs_assert(sptr);
 
+    arena = ogs_asn_arena_find(sptr);
+    if (arena && ogs_asn_arena_attached(arena)) {
+        ogs_asn_arena_destroy(arena);
+        return;
+    }
+
+    /* Any block still pointing into a detached arena is left to it */
     ASN_STRUCT_FREE_CONTENTS_ONLY(*td, sptr);
+
+    if (arena)
+        ogs_asn_arena_destroy(arena);
+}
+
+/*
+ * The structure at 'sptr' no longer holds only what ogs_asn_decode()
+ * put there, e.g. a heap block was stored in it or another structure
+ * was built at its address. ogs_asn_free() then frees it field by field.
+ */
+void ogs_asn_detach(void *sptr)
+{
+    ogs_asn_arena_t *arena = NULL;
+
+    ogs_assert(sptr);
+
+    arena = ogs_asn_arena_find(sptr);
+    if (arena)
+        ogs_asn_arena_detach(arena);
 }
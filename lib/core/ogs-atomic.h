@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_CORE_INSIDE) && !defined(OGS_CORE_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_ATOMIC_H
+#define OGS_ATOMIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Thin wrappers around the GCC/Clang __atomic builtins.
+ *
+ * Loads use acquire and stores use release ordering, which is enough
+ * for publishing a flag or a pointer between threads. Read-modify-write
+ * operations are sequentially consistent.
+ */
+#define ogs_atomic_load(_p) __atomic_load_n((_p), __ATOMIC_ACQUIRE)
+#define ogs_atomic_store(_p, _v) __atomic_store_n((_p), (_v), __ATOMIC_RELEASE)
+
+#define ogs_atomic_exchange(_p, _v) \
+    __atomic_exchange_n((_p), (_v), __ATOMIC_SEQ_CST)
+#define ogs_atomic_cas(_p, _expected, _desired) \
+    __atomic_compare_exchange_n((_p), (_expected), (_desired), false, \
+            __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+#define ogs_atomic_add(_p, _v) __atomic_add_fetch((_p), (_v), __ATOMIC_SEQ_CST)
+#define ogs_atomic_sub(_p, _v) __atomic_sub_fetch((_p), (_v), __ATOMIC_SEQ_CST)
+#define ogs_atomic_inc(_p) ogs_atomic_add((_p), 1)
+#define ogs_atomic_dec(_p) ogs_atomic_sub((_p), 1)
+
+#define ogs_atomic_fence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_ATOMIC_H */
@@ -43,6 +43,7 @@
 #include "core/ogs-rbtree.h"
 #include "core/ogs-timer.h"
 #include "core/ogs-thread.h"
+#include "core/ogs-atomic.h"
 #include "core/ogs-process.h"
 #include "core/ogs-signal.h"
 #include "core/ogs-sockaddr.h"
@@ -60,6 +61,7 @@
 #include "core/ogs-env.h"
 #include "core/ogs-fsm.h"
 #include "core/ogs-hash.h"
+#include "core/ogs-ipmap.h"
 #include "core/ogs-misc.h"
 #include "core/ogs-getopt.h"
 #include "core/ogs-file.h"
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+
+#define MIN_CAPACITY 16
+
+typedef struct ogs_ipmap_slot_s {
+    uint64_t key;
+    void *val;                      /* NULL : empty slot */
+} ogs_ipmap_slot_t;
+
+struct ogs_ipmap_s {
+    ogs_ipmap_slot_t *slot;
+    unsigned int mask;              /* capacity - 1 */
+    unsigned int shift;             /* 64 - log2(capacity) */
+    unsigned int count;
+};
+
+/*
+ * Fibonacci hashing : consecutive addresses handed out by a UE pool
+ * are spread over the whole table by the high bits of the product.
+ */
+static ogs_inline unsigned int map_home(
+        const ogs_ipmap_t *map, uint64_t key)
+{
+    return (unsigned int)((key * 0x9e3779b97f4a7c15ULL) >> map->shift);
+}
+
+static ogs_inline void *map_get(const ogs_ipmap_t *map, uint64_t key)
+{
+    const ogs_ipmap_slot_t *slot = NULL;
+    unsigned int i = map_home(map, key);
+
+    for ( ;; ) {
+        slot = &map->slot[i];
+        if (!slot->val)
+            return NULL;
+        if (slot->key == key)
+            return slot->val;
+        i = (i + 1) & map->mask;
+    }
+}
+
+/* Slot holding 'key', or the empty slot where it would be inserted */
+static ogs_ipmap_slot_t *map_probe(ogs_ipmap_t *map, uint64_t key)
+{
+    ogs_ipmap_slot_t *slot = NULL;
+    unsigned int i = map_home(map, key);
+
+    for ( ;; ) {
+        slot = &map->slot[i];
+        if (!slot->val || slot->key == key)
+            return slot;
+        i = (i + 1) & map->mask;
+    }
+}
+
+static int map_alloc(ogs_ipmap_t *map, unsigned int capacity)
+{
+    unsigned int bits = 0;
+
+    while ((1U << bits) < capacity)
+        bits++;
+
+    map->slot = ogs_calloc(1U << bits, sizeof(*map->slot));
+    if (!map->slot) {
+        ogs_error("ogs_calloc() failed [capacity=%u]", 1U << bits);
+        return OGS_ERROR;
+    }
+
+    map->mask = (1U << bits) - 1;
+    map->shift = 64 - bits;
+    map->count = 0;
+
+    return OGS_OK;
+}
+
+/* At most 3/4 of the slots are used, so that a probe always ends */
+static unsigned int map_capacity(unsigned int size)
+{
+    return ogs_max(MIN_CAPACITY, size + size / 3 + 1);
+}
+
+ogs_ipmap_t *ogs_ipmap_create(unsigned int size)
+{
+    ogs_ipmap_t *map = NULL;
+
+    map = ogs_calloc(1, sizeof(*map));
+    if (!map) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+
+    if (map_alloc(map, map_capacity(size)) != OGS_OK) {
+        ogs_free(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+void ogs_ipmap_destroy(ogs_ipmap_t *map)
+{
+    ogs_assert(map);
+
+    ogs_free(map->slot);
+    ogs_free(map);
+}
+
+static void map_grow(ogs_ipmap_t *map)
+{
+    ogs_ipmap_slot_t *old = map->slot;
+    unsigned int i, capacity = map->mask + 1;
+
+    ogs_assert(map_alloc(map, capacity * 2) == OGS_OK);
+
+    for (i = 0; i < capacity; i++) {
+        if (old[i].val) {
+            *map_probe(map, old[i].key) = old[i];
+            map->count++;
+        }
+    }
+
+    ogs_free(old);
+}
+
+/*
+ * Backward shift deletion : the entries following the removed one
+ * are moved back over it, unless their home slot lies in between.
+ * No tombstone is left, so lookups never slow down over time.
+ */
+static void map_remove(ogs_ipmap_t *map, uint64_t key)
+{
+    ogs_ipmap_slot_t *slot = NULL;
+    unsigned int i, j, home;
+
+    slot = map_probe(map, key);
+    if (!slot->val)
+        return;
+
+    i = j = slot - map->slot;
+    for ( ;; ) {
+        j = (j + 1) & map->mask;
+        if (!map->slot[j].val)
+            break;
+
+        home = map_home(map, map->slot[j].key);
+        if (((j - home) & map->mask) >= ((j - i) & map->mask)) {
+            map->slot[i] = map->slot[j];
+            i = j;
+        }
+    }
+
+    map->slot[i].key = 0;
+    map->slot[i].val = NULL;
+    map->count--;
+}
+
+void ogs_ipmap_set(ogs_ipmap_t *map, uint64_t key, void *val)
+{
+    ogs_ipmap_slot_t *slot = NULL;
+
+    ogs_assert(map);
+
+    if (!val) {
+        map_remove(map, key);
+        return;
+    }
+
+    slot = map_probe(map, key);
+    if (slot->val) {
+        slot->val = val;
+        return;
+    }
+
+    if (map_capacity(map->count + 1) > map->mask + 1) {
+        map_grow(map);
+        slot = map_probe(map, key);
+    }
+
+    slot->key = key;
+    slot->val = val;
+    map->count++;
+}
+
+void *ogs_ipmap_get(ogs_ipmap_t *map, uint64_t key)
+{
+    ogs_assert(map);
+    return map_get(map, key);
+}
+
+void ogs_ipmap_prefetch(ogs_ipmap_t *map, uint64_t key)
+{
+    ogs_assert(map);
+    ogs_prefetch(&map->slot[map_home(map, key)]);
+}
+
+void ogs_ipmap_get_burst(ogs_ipmap_t *map,
+        const uint64_t *key, void **val, int num)
+{
+    int i;
+
+    ogs_assert(map);
+    ogs_assert(key);
+    ogs_assert(val);
+
+    for (i = 0; i < num; i++)
+        ogs_prefetch(&map->slot[map_home(map, key[i])]);
+
+    for (i = 0; i < num; i++)
+        val[i] = map_get(map, key[i]);
+}
+
+unsigned int ogs_ipmap_count(ogs_ipmap_t *map)
+{
+    ogs_assert(map);
+    return map->count;
+}
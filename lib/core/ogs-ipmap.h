@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_CORE_INSIDE) && !defined(OGS_CORE_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_IPMAP_H
+#define OGS_IPMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * IP Address Map
+ *
+ * Open-addressing table from a 64-bit key to a pointer, made for the
+ * per-packet lookup of a UE IP address. The key is an IPv4 address
+ * or the /64 prefix of an IPv6 address, so that a lookup is a single
+ * integer compare on a linearly probed array.
+ *
+ * A burst of keys is looked up in two passes : the slots of every key
+ * are prefetched first, then probed. A NULL value removes the key.
+ *
+ * The map is not thread-safe. It must not be read while it is modified.
+ */
+typedef struct ogs_ipmap_s ogs_ipmap_t;
+
+ogs_ipmap_t *ogs_ipmap_create(unsigned int size);
+void ogs_ipmap_destroy(ogs_ipmap_t *map);
+
+void ogs_ipmap_set(ogs_ipmap_t *map, uint64_t key, void *val);
+void *ogs_ipmap_get(ogs_ipmap_t *map, uint64_t key);
+void ogs_ipmap_prefetch(ogs_ipmap_t *map, uint64_t key);
+void ogs_ipmap_get_burst(ogs_ipmap_t *map,
+        const uint64_t *key, void **val, int num);
+unsigned int ogs_ipmap_count(ogs_ipmap_t *map);
+
+/* IPv4 address in network byte order */
+#define ogs_ipmap_key_ipv4(addr) ((uint64_t)(uint32_t)(addr))
+
+/* First 64 bits of an IPv6 address */
+static ogs_inline uint64_t ogs_ipmap_key_ipv6(const void *addr6)
+{
+    uint64_t key;
+    memcpy(&key, addr6, sizeof(key));
+    return key;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_IPMAP_H */
@@ -95,6 +95,9 @@ static OGS_LIST(log_list);
 static OGS_POOL(domain_pool, ogs_log_domain_t);
 static OGS_LIST(domain_list);
 
+/* Level of each domain, indexed by the domain id for ogs_log_enabled() */
+ogs_log_level_e *__ogs_log_level;
+
 static ogs_log_t *add_log(ogs_log_type_e type);
 static int file_cycle(ogs_log_t *log);
 
@@ -111,11 +114,78 @@ static char *log_linefeed(char *buf, char *last);
 static void file_writer(
         ogs_log_t *log, ogs_log_level_e level, const char *string);
 
+/*
+ * Asynchronous Logging
+ *
+ * Each thread keeps formatting its own lines and copies them into a
+ * private single-producer ring. A writer thread drains all the rings,
+ * writes the lines through buffered stdio and flushes every log once
+ * per batch, so the event loops never wait for the disk.
+ *
+ * A line that does not fit in the ring is dropped and counted, and the
+ * writer reports how many lines were lost. FATAL lines are still
+ * written synchronously since an abort usually follows.
+ *
+ * The ring of a thread that has exited is freed by the writer once it
+ * has been drained.
+ */
+#define OGS_LOG_ASYNC_DEFAULT_SIZE  (1024*1024)
+#define OGS_LOG_ASYNC_MIN_SIZE      (64*1024)
+#define OGS_LOG_ASYNC_INTERVAL      ogs_time_from_msec(10)
+
+typedef struct ogs_log_ring_s {
+    struct ogs_log_ring_s *next;
+
+    uint64_t head;      /* Written by the owner thread */
+    uint64_t tail;      /* Written by the writer thread */
+    uint64_t dropped;
+    bool exited;        /* The owner thread has gone */
+
+    size_t size;
+    unsigned char *buf;
+} ogs_log_ring_t;
+
+typedef struct ogs_log_record_s {
+    ogs_log_t *log;
+    size_t len;
+} ogs_log_record_t;
+
+#define OGS_LOG_RECORD_SIZE(len) \
+    ((sizeof(ogs_log_record_t) + (len) + 7) & ~(size_t)7)
+
+static struct {
+    bool enabled;
+    bool running;
+    unsigned int generation;
+
+    size_t size;
+    ogs_thread_t *thread;
+    ogs_thread_mutex_t mutex;
+    ogs_thread_cond_t cond;
+
+    ogs_log_ring_t *ring_list;
+    uint64_t dropped;
+    uint64_t reported;
+
+#if !defined(_WIN32)
+    pthread_key_t key; /* Releases the ring of any exiting thread */
+#endif
+} async;
+
+static ogs_thread_local ogs_log_ring_t *self_ring;
+static ogs_thread_local unsigned int self_generation;
+
+static void async_drain(void);
+
 void ogs_log_init(void)
 {
     ogs_pool_init(&log_pool, ogs_core()->log.pool);
     ogs_pool_init(&domain_pool, ogs_core()->log.domain_pool);
 
+    __ogs_log_level = calloc(
+            ogs_core()->log.domain_pool + 1, sizeof(ogs_log_level_e));
+    ogs_assert(__ogs_log_level);
+
     ogs_log_add_domain("core", ogs_core()->log.level);
     ogs_log_add_stderr();
 }
@@ -125,6 +195,8 @@ void ogs_log_final(void)
     ogs_log_t *log, *saved_log;
     ogs_log_domain_t *domain, *saved_domain;
 
+    ogs_log_async_stop();
+
     ogs_list_for_each_safe(&log_list, saved_log, log)
         ogs_log_remove(log);
     ogs_pool_final(&log_pool);
@@ -132,6 +204,9 @@ void ogs_log_final(void)
     ogs_list_for_each_safe(&domain_list, saved_domain, domain)
         ogs_log_remove_domain(domain);
     ogs_pool_final(&domain_pool);
+
+    free(__ogs_log_level);
+    __ogs_log_level = NULL;
 }
 
 void ogs_log_cycle(void)
@@ -188,15 +263,29 @@ ogs_log_t *ogs_log_add_file(const char *name)
 void ogs_log_remove(ogs_log_t *log)
 {
     ogs_assert(log);
+    if (log->type == OGS_LOG_FILE_TYPE)
+        ogs_assert(log->file.out);
+
+    /*
+     * Write out the pending lines of this log first.
+     * Nothing may assert while async.mutex is held,
+     * since a FATAL line takes it again.
+     */
+    if (async.thread) {
+        ogs_thread_mutex_lock(&async.mutex);
+        async_drain();
+    }
 
     ogs_list_remove(&log_list, log);
 
     if (log->type == OGS_LOG_FILE_TYPE) {
-        ogs_assert(log->file.out);
         fclose(log->file.out);
         log->file.out = NULL;
     }
 
+    if (async.thread)
+        ogs_thread_mutex_unlock(&async.mutex);
+
     ogs_pool_free(&log_pool, log);
 }
 
@@ -212,6 +301,7 @@ ogs_log_domain_t *ogs_log_add_domain(const char *name, ogs_log_level_e level)
     domain->name = name;
     domain->id = ogs_pool_index(&domain_pool, domain);
     domain->level = level;
+    __ogs_log_level[domain->id] = level;
 
     ogs_list_add(&domain_list, domain);
 
@@ -235,6 +325,8 @@ void ogs_log_remove_domain(ogs_log_domain_t *domain)
 {
     ogs_assert(domain);
 
+    __ogs_log_level[domain->id] = OGS_LOG_NONE;
+
     ogs_list_remove(&domain_list, domain);
     ogs_pool_free(&domain_pool, domain);
 }
@@ -249,6 +341,7 @@ void ogs_log_set_domain_level(int id, ogs_log_level_e level)
     ogs_assert(domain);
 
     domain->level = level;
+    __ogs_log_level[domain->id] = level;
 }
 
 ogs_log_level_e ogs_log_get_domain_level(int id)
@@ -330,13 +423,13 @@ void ogs_log_set_mask_level(const char *_mask, ogs_log_level_e level)
 
             domain = ogs_log_find_domain(name);
             if (domain)
-                domain->level = level;
+                ogs_log_set_domain_level(domain->id, level);
         }
 
         ogs_free(mask);
     } else {
         ogs_list_for_each(&domain_list, domain)
-            domain->level = level;
+            ogs_log_set_domain_level(domain->id, level);
     }
 }
 
@@ -526,13 +619,27 @@ static ogs_log_t *add_log(ogs_log_type_e type)
 
 static int file_cycle(ogs_log_t *log)
 {
+    FILE *out = NULL;
+
     ogs_assert(log);
     ogs_assert(log->file.out);
     ogs_assert(log->file.name);
 
+    /* Open the new file before taking async.mutex, a FATAL line needs it */
+    out = fopen(log->file.name, "a");
+    ogs_assert(out);
+
+    /* The pending lines still go to the old file */
+    if (async.thread) {
+        ogs_thread_mutex_lock(&async.mutex);
+        async_drain();
+    }
+
     fclose(log->file.out);
-    log->file.out = fopen(log->file.name, "a");
-    ogs_assert(log->file.out);
+    log->file.out = out;
+
+    if (async.thread)
+        ogs_thread_mutex_unlock(&async.mutex);
 
     return 0;
 }
@@ -616,9 +723,319 @@ static char *log_linefeed(char *buf, char *last)
     return buf;
 }
 
+static void ring_write(ogs_log_ring_t *ring,
+        uint64_t pos, const void *data, size_t len)
+{
+    size_t offset = pos & (ring->size - 1);
+    size_t part = ogs_min(len, ring->size - offset);
+
+    memcpy(ring->buf + offset, data, part);
+    memcpy(ring->buf, (const unsigned char *)data + part, len - part);
+}
+
+static void ring_read(ogs_log_ring_t *ring,
+        uint64_t pos, void *data, size_t len)
+{
+    size_t offset = pos & (ring->size - 1);
+    size_t part = ogs_min(len, ring->size - offset);
+
+    memcpy(data, ring->buf + offset, part);
+    memcpy((unsigned char *)data + part, ring->buf, len - part);
+}
+
+static ogs_log_ring_t *ring_self(void)
+{
+    ogs_log_ring_t *ring = NULL;
+
+    if (self_ring && self_generation == async.generation)
+        return self_ring;
+
+    /* Not ogs_malloc() : it may log on failure */
+    ring = calloc(1, sizeof *ring);
+    if (!ring)
+        return NULL;
+
+    ring->size = async.size;
+    ring->buf = malloc(ring->size);
+    if (!ring->buf) {
+        free(ring);
+        return NULL;
+    }
+
+    ogs_thread_mutex_lock(&async.mutex);
+    ring->next = async.ring_list;
+    async.ring_list = ring;
+    ogs_thread_mutex_unlock(&async.mutex);
+
+    self_ring = ring;
+    self_generation = async.generation;
+
+#if !defined(_WIN32)
+    /* Threads not created by ogs_thread_create() release it on exit too */
+    pthread_setspecific(async.key, ring);
+#endif
+
+    return ring;
+}
+
+/* Runs on the exiting thread : a later line gets a new ring */
+static void ring_release(void *data)
+{
+    ogs_log_ring_t *ring = data;
+
+    self_ring = NULL;
+    ogs_atomic_store(&ring->exited, true);
+}
+
+void ogs_log_thread_exit(void)
+{
+    if (!self_ring || self_generation != async.generation)
+        return;
+
+#if !defined(_WIN32)
+    pthread_setspecific(async.key, NULL);
+#endif
+    ring_release(self_ring);
+}
+
+static void async_writer(ogs_log_t *log, const char *string)
+{
+    ogs_log_ring_t *ring = NULL;
+    ogs_log_record_t record;
+    uint64_t head, used;
+    size_t need;
+
+    ring = ring_self();
+    if (!ring) {
+        ogs_atomic_inc(&async.dropped);
+        return;
+    }
+
+    record.log = log;
+    record.len = strlen(string);
+
+    need = OGS_LOG_RECORD_SIZE(record.len);
+
+    head = ring->head;
+    used = head - ogs_atomic_load(&ring->tail);
+    if (need > ring->size - used) {
+        ogs_atomic_store(&ring->dropped, ring->dropped + 1);
+        return;
+    }
+
+    ring_write(ring, head, &record, sizeof(record));
+    ring_write(ring, head + sizeof(record), string, record.len);
+
+    ogs_atomic_store(&ring->head, head + need);
+
+    /* Don't wait for the next interval once half of the ring is used */
+    if (used < ring->size / 2 && used + need >= ring->size / 2)
+        ogs_thread_cond_signal(&async.cond);
+}
+
+static void async_write(ogs_log_ring_t *ring, uint64_t pos, size_t len,
+        FILE *out)
+{
+    size_t offset = pos & (ring->size - 1);
+    size_t part = ogs_min(len, ring->size - offset);
+
+    fwrite(ring->buf + offset, 1, part, out);
+    if (len > part)
+        fwrite(ring->buf, 1, len - part, out);
+}
+
+/* Called with async.mutex held */
+static void async_drain(void)
+{
+    ogs_log_ring_t *ring = NULL, **prev = NULL;
+    ogs_log_record_t record;
+    ogs_log_t *log = NULL;
+    uint64_t head, tail, dropped = 0;
+    bool exited;
+
+    prev = &async.ring_list;
+    while ((ring = *prev) != NULL) {
+        /* Its owner writes nothing more once it has exited */
+        exited = ogs_atomic_load(&ring->exited);
+
+        head = ogs_atomic_load(&ring->head);
+        tail = ring->tail;
+
+        while (tail < head) {
+            ring_read(ring, tail, &record, sizeof(record));
+            if (record.log->file.out)
+                async_write(ring, tail + sizeof(record), record.len,
+                        record.log->file.out);
+
+            tail += OGS_LOG_RECORD_SIZE(record.len);
+        }
+
+        ogs_atomic_store(&ring->tail, tail);
+
+        if (exited) {
+            /* Keep counting the lines it has dropped */
+            ogs_atomic_add(&async.dropped, ring->dropped);
+
+            *prev = ring->next;
+            free(ring->buf);
+            free(ring);
+            continue;
+        }
+
+        dropped += ogs_atomic_load(&ring->dropped);
+        prev = &ring->next;
+    }
+
+    /* Lines dropped because the ring could not be allocated */
+    dropped += ogs_atomic_load(&async.dropped);
+
+    ogs_list_for_each(&log_list, log) {
+        if (!log->file.out)
+            continue;
+
+        if (dropped != async.reported)
+            fprintf(log->file.out, "[log] %llu lines dropped\n",
+                    (unsigned long long)(dropped - async.reported));
+
+        fflush(log->file.out);
+    }
+
+    async.reported = dropped;
+}
+
+static void async_main(void *data)
+{
+    ogs_thread_mutex_lock(&async.mutex);
+
+    while (async.running) {
+        ogs_thread_cond_timedwait(
+                &async.cond, &async.mutex, OGS_LOG_ASYNC_INTERVAL);
+        async_drain();
+    }
+
+    async_drain();
+
+    ogs_thread_mutex_unlock(&async.mutex);
+}
+
+int ogs_log_async_start(size_t size)
+{
+    ogs_assert(!async.thread);
+
+    if (!size)
+        size = OGS_LOG_ASYNC_DEFAULT_SIZE;
+    else if (size < OGS_LOG_ASYNC_MIN_SIZE)
+        size = OGS_LOG_ASYNC_MIN_SIZE;
+
+    /* Round up to a power of 2 */
+    async.size = 1;
+    while (async.size < size)
+        async.size <<= 1;
+
+    async.generation++;
+    async.ring_list = NULL;
+    async.dropped = 0;
+    async.reported = 0;
+
+    ogs_thread_mutex_init(&async.mutex);
+    ogs_thread_cond_init(&async.cond);
+
+#if !defined(_WIN32)
+    if (pthread_key_create(&async.key, ring_release) != 0) {
+        ogs_error("pthread_key_create() failed");
+        ogs_thread_cond_destroy(&async.cond);
+        ogs_thread_mutex_destroy(&async.mutex);
+        return OGS_ERROR;
+    }
+#endif
+
+    async.running = true;
+    async.thread = ogs_thread_create(async_main, NULL);
+    if (!async.thread) {
+        ogs_error("ogs_thread_create() failed");
+        async.running = false;
+#if !defined(_WIN32)
+        pthread_key_delete(async.key);
+#endif
+        ogs_thread_cond_destroy(&async.cond);
+        ogs_thread_mutex_destroy(&async.mutex);
+        return OGS_ERROR;
+    }
+
+    ogs_atomic_store(&async.enabled, true);
+
+    return OGS_OK;
+}
+
+/* Must be called once the other threads have stopped logging */
+void ogs_log_async_stop(void)
+{
+    ogs_log_ring_t *ring = NULL, *next = NULL;
+
+    if (!async.thread)
+        return;
+
+    ogs_atomic_store(&async.enabled, false);
+
+    ogs_thread_mutex_lock(&async.mutex);
+    async.running = false;
+    ogs_thread_cond_signal(&async.cond);
+    ogs_thread_mutex_unlock(&async.mutex);
+
+    ogs_thread_destroy(async.thread);
+    async.thread = NULL;
+
+    /* The rings of the threads still alive are freed below */
+#if !defined(_WIN32)
+    pthread_key_delete(async.key);
+#endif
+    async.generation++;
+
+    for (ring = async.ring_list; ring; ring = next) {
+        next = ring->next;
+        free(ring->buf);
+        free(ring);
+    }
+    async.ring_list = NULL;
+
+    ogs_thread_cond_destroy(&async.cond);
+    ogs_thread_mutex_destroy(&async.mutex);
+}
+
+uint64_t ogs_log_async_dropped(void)
+{
+    ogs_log_ring_t *ring = NULL;
+    uint64_t dropped = 0;
+
+    if (!async.thread)
+        return 0;
+
+    ogs_thread_mutex_lock(&async.mutex);
+    for (ring = async.ring_list; ring; ring = ring->next)
+        dropped += ogs_atomic_load(&ring->dropped);
+    dropped += ogs_atomic_load(&async.dropped);
+    ogs_thread_mutex_unlock(&async.mutex);
+
+    return dropped;
+}
+
 static void file_writer(
         ogs_log_t *log, ogs_log_level_e level, const char *string)
 {
+    if (ogs_atomic_load(&async.enabled)) {
+        if (level != OGS_LOG_FATAL) {
+            async_writer(log, string);
+            return;
+        }
+
+        ogs_thread_mutex_lock(&async.mutex);
+        async_drain();
+        fprintf(log->file.out, "%s", string);
+        fflush(log->file.out);
+        ogs_thread_mutex_unlock(&async.mutex);
+        return;
+    }
+
     fprintf(log->file.out, "%s", string);
     fflush(log->file.out);
 }
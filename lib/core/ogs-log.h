@@ -32,12 +32,29 @@ extern "C" {
 #define OGS_LOG_DOMAIN      1
 #endif
 
+/*
+ * The most verbose level compiled in. Building with
+ * '-Dlog_max_level=info' removes every ogs_debug() and ogs_trace().
+ */
+#ifndef OGS_LOG_MAX_LEVEL
+#define OGS_LOG_MAX_LEVEL   OGS_LOG_TRACE
+#endif
+
 #define ogs_fatal(...) ogs_log_message(OGS_LOG_FATAL, 0, __VA_ARGS__)
 #define ogs_error(...) ogs_log_message(OGS_LOG_ERROR, 0, __VA_ARGS__)
 #define ogs_warn(...) ogs_log_message(OGS_LOG_WARN, 0, __VA_ARGS__)
 #define ogs_info(...) ogs_log_message(OGS_LOG_INFO, 0, __VA_ARGS__)
-#define ogs_debug(...) ogs_log_message(OGS_LOG_DEBUG, 0, __VA_ARGS__)
-#define ogs_trace(...) ogs_log_message(OGS_LOG_TRACE, 0, __VA_ARGS__)
+
+/*
+ * The arguments of ogs_debug() and ogs_trace() are only evaluated
+ * when the level is enabled for the domain.
+ */
+#define ogs_debug(...) \
+    (ogs_log_enabled(OGS_LOG_DEBUG, OGS_LOG_DOMAIN) ? \
+     ogs_log_message(OGS_LOG_DEBUG, 0, __VA_ARGS__) : (void)0)
+#define ogs_trace(...) \
+    (ogs_log_enabled(OGS_LOG_TRACE, OGS_LOG_DOMAIN) ? \
+     ogs_log_message(OGS_LOG_TRACE, 0, __VA_ARGS__) : (void)0)
 
 #define ogs_log_message(level, err, ...) \
     ogs_log_printf(level, OGS_LOG_DOMAIN, \
@@ -50,7 +67,8 @@ extern "C" {
     1, __VA_ARGS__) 
 
 #define ogs_log_hexdump(level, _d, _l) \
-    ogs_log_hexdump_func(level, OGS_LOG_DOMAIN, _d, _l)
+    (ogs_log_enabled(level, OGS_LOG_DOMAIN) ? \
+     ogs_log_hexdump_func(level, OGS_LOG_DOMAIN, _d, _l) : (void)0)
 
 typedef enum {
     OGS_LOG_NONE,
@@ -75,6 +93,11 @@ ogs_log_t *ogs_log_add_stderr(void);
 ogs_log_t *ogs_log_add_file(const char *name);
 void ogs_log_remove(ogs_log_t *log);
 
+int ogs_log_async_start(size_t size);
+void ogs_log_async_stop(void);
+uint64_t ogs_log_async_dropped(void);
+void ogs_log_thread_exit(void);
+
 ogs_log_domain_t *ogs_log_add_domain(const char *name, ogs_log_level_e level);
 ogs_log_domain_t *ogs_log_find_domain(const char *name);
 void ogs_log_remove_domain(ogs_log_domain_t *domain);
@@ -102,6 +125,20 @@ void ogs_log_printf(ogs_log_level_e level, int domain_id,
 void ogs_log_hexdump_func(ogs_log_level_e level, int domain_id,
     const unsigned char *data, size_t len);
 
+extern ogs_log_level_e *__ogs_log_level;
+
+static ogs_inline bool ogs_log_enabled(ogs_log_level_e level, int domain_id)
+{
+    if (level > OGS_LOG_MAX_LEVEL)
+        return false;
+
+    /* Let ogs_log_printf() handle logging before ogs_log_init() */
+    if (ogs_unlikely(!__ogs_log_level))
+        return true;
+
+    return level <= __ogs_log_level[domain_id];
+}
+
 #define ogs_assert(expr) \
     do { \
         if (ogs_likely(expr)) ; \
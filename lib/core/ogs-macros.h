@@ -58,6 +58,12 @@ extern "C" {
 #define ogs_unlikely(v) v
 #endif
 
+#if defined(__GNUC__)
+#define ogs_prefetch(addr) __builtin_prefetch(addr)
+#else
+#define ogs_prefetch(addr) ((void)(addr))
+#endif
+
 #if __GNUC__ > 2 || (__GNUC__ == 2 && __GNUC_MINOR__ > 4)
 #if !defined (__clang__) && OGS_GNUC_CHECK_VERSION (4, 4)
 #define OGS_GNUC_PRINTF(f, v) __attribute__ ((format (gnu_printf, f, v)))
@@ -30,26 +30,133 @@ void *__ogs_talloc_core;
 
 static ogs_thread_mutex_t mutex;
 
+/*
+ * Per-thread Contexts
+ *
+ * ogs_malloc() allocates under a talloc context of the calling thread,
+ * so threads neither share a talloc tree nor take a lock for their own
+ * memory. Every block starts with a header naming its context. A block
+ * freed by another thread is pushed on the lock-free 'remote' list of
+ * its context, and the owner releases it on its next allocation or free.
+ *
+ * The contexts are children of __ogs_talloc_core and stay registered
+ * until ogs_mem_final(), so the leak report still covers every thread.
+ * The context of an exited thread, whoever created it, is adopted by
+ * the next new thread. Until then, blocks freed into it are released
+ * at once under the mutex.
+ */
+typedef struct mem_arena_s mem_arena_t;
+
+typedef struct mem_block_s {
+    mem_arena_t *arena;
+    struct mem_block_s *next;   /* remote list */
+} mem_block_t;
+
+#define MEM_BLOCK_HEADER    16
+OGS_STATIC_ASSERT(sizeof(mem_block_t) <= MEM_BLOCK_HEADER);
+
+#define mem_block_of(ptr) \
+    ((mem_block_t *)((unsigned char *)(ptr) - MEM_BLOCK_HEADER))
+#define mem_block_data(block) \
+    ((void *)((unsigned char *)(block) + MEM_BLOCK_HEADER))
+
+struct mem_arena_s {
+    mem_arena_t *next;
+
+    void *ctx;
+    mem_block_t *remote;
+
+    bool orphan;
+};
+
+static mem_arena_t *arena_list;
+static ogs_thread_local mem_arena_t *self_arena;
+
+#if !defined(_WIN32)
+static pthread_key_t arena_key; /* Orphans the context of any exiting thread */
+#endif
+
+static void arena_release(void *data);
+
 void ogs_mem_init(void)
 {
     ogs_thread_mutex_init(&mutex);
 
+#if !defined(_WIN32)
+    ogs_assert(pthread_key_create(&arena_key, arena_release) == 0);
+#endif
+
     talloc_enable_null_tracking();
 
 #define TALLOC_MEMSIZE 1
     __ogs_talloc_core = talloc_named_const(NULL, TALLOC_MEMSIZE, "core");
 }
 
+static void arena_drain(mem_arena_t *arena)
+{
+    mem_block_t *block = NULL, *next = NULL;
+
+    if (ogs_likely(!ogs_atomic_load(&arena->remote)))
+        return;
+
+    block = ogs_atomic_exchange(&arena->remote, NULL);
+    for (; block; block = next) {
+        next = block->next;
+        talloc_free(block);
+    }
+}
+
 void ogs_mem_final(void)
 {
+    mem_arena_t *arena = NULL, *next = NULL;
+
+    /* The other threads are gone : release what they freed remotely */
+    for (arena = arena_list; arena; arena = arena->next)
+        arena_drain(arena);
+
     if (talloc_total_size(__ogs_talloc_core) != TALLOC_MEMSIZE)
         talloc_report_full(__ogs_talloc_core, stderr);
 
     talloc_free(__ogs_talloc_core);
 
+    for (arena = arena_list; arena; arena = next) {
+        next = arena->next;
+        free(arena);
+    }
+    arena_list = NULL;
+    self_arena = NULL;
+
+#if !defined(_WIN32)
+    pthread_key_delete(arena_key);
+#endif
+
     ogs_thread_mutex_destroy(&mutex);
 }
 
+/* Runs on the exiting thread : a later allocation adopts a context again */
+static void arena_release(void *data)
+{
+    mem_arena_t *arena = data;
+
+    self_arena = NULL;
+
+    ogs_thread_mutex_lock(&mutex);
+    arena_drain(arena);
+    ogs_atomic_store(&arena->orphan, true);
+    ogs_thread_mutex_unlock(&mutex);
+}
+
+void ogs_mem_thread_exit(void)
+{
+    if (!self_arena)
+        return;
+
+#if !defined(_WIN32)
+    pthread_setspecific(arena_key, NULL);
+#endif
+    arena_release(self_arena);
+}
+
 void *ogs_mem_get_mutex(void)
 {
     return &mutex;
@@ -111,6 +218,184 @@ int ogs_talloc_free(void *ptr, const char *location)
     return ret;
 }
 
+#if OGS_USE_TALLOC == 1
+
+static mem_arena_t *arena_self(void)
+{
+    mem_arena_t *arena = NULL;
+
+    if (ogs_likely(self_arena))
+        return self_arena;
+
+    ogs_thread_mutex_lock(&mutex);
+
+    for (arena = arena_list; arena; arena = arena->next)
+        if (arena->orphan)
+            break;
+
+    if (arena) {
+        ogs_atomic_store(&arena->orphan, false);
+    } else {
+        arena = calloc(1, sizeof *arena);
+        if (arena) {
+            arena->ctx = talloc_named_const(__ogs_talloc_core, 0, "thread");
+            if (arena->ctx) {
+                arena->next = arena_list;
+                arena_list = arena;
+            } else {
+                free(arena);
+                arena = NULL;
+            }
+        }
+    }
+
+    ogs_thread_mutex_unlock(&mutex);
+
+    self_arena = arena;
+
+#if !defined(_WIN32)
+    /* Threads not created by ogs_thread_create() release it on exit too */
+    if (arena)
+        pthread_setspecific(arena_key, arena);
+#endif
+
+    return arena;
+}
+
+void *ogs_malloc_debug(size_t size, const char *file_line)
+{
+    mem_arena_t *arena = NULL;
+    mem_block_t *block = NULL;
+
+    arena = arena_self();
+    if (!arena) {
+        ogs_error("No memory context");
+        return NULL;
+    }
+
+    arena_drain(arena);
+
+    block = talloc_named_const(arena->ctx, MEM_BLOCK_HEADER + size, file_line);
+    if (!block) {
+        ogs_error("talloc failed [size=%d]", (int)size);
+        return NULL;
+    }
+
+    block->arena = arena;
+
+    return mem_block_data(block);
+}
+
+void *ogs_calloc_debug(size_t nmemb, size_t size, const char *file_line)
+{
+    mem_arena_t *arena = NULL;
+    mem_block_t *block = NULL;
+
+    arena = arena_self();
+    if (!arena) {
+        ogs_error("No memory context");
+        return NULL;
+    }
+
+    arena_drain(arena);
+
+    block = _talloc_zero(arena->ctx,
+            MEM_BLOCK_HEADER + nmemb * size, file_line);
+    if (!block) {
+        ogs_error("talloc failed [size=%d]", (int)size);
+        return NULL;
+    }
+
+    block->arena = arena;
+
+    return mem_block_data(block);
+}
+
+void *ogs_realloc_debug(void *ptr, size_t size, const char *file_line)
+{
+    mem_arena_t *arena = NULL;
+    mem_block_t *block = NULL;
+    size_t oldsize;
+    void *new = NULL;
+
+    if (!ptr)
+        return ogs_malloc_debug(size, file_line);
+
+    if (!size) {
+        ogs_free_debug(ptr);
+        return NULL;
+    }
+
+    block = mem_block_of(ptr);
+
+    arena = arena_self();
+    if (arena && block->arena == arena) {
+        arena_drain(arena);
+
+        block = _talloc_realloc(
+                arena->ctx, block, MEM_BLOCK_HEADER + size, file_line);
+        if (!block) {
+            ogs_error("talloc failed [size=%d]", (int)size);
+            return NULL;
+        }
+
+        return mem_block_data(block);
+    }
+
+    /* Allocated by another thread : move it to this one */
+    oldsize = talloc_get_size(block) - MEM_BLOCK_HEADER;
+
+    new = ogs_malloc_debug(size, file_line);
+    if (!new) {
+        ogs_error("ogs_malloc_debug[%d] failed", (int)size);
+        return NULL;
+    }
+
+    memcpy(new, ptr, ogs_min(oldsize, size));
+    ogs_free_debug(ptr);
+
+    return new;
+}
+
+int ogs_free_debug(void *ptr)
+{
+    mem_arena_t *arena = NULL;
+    mem_block_t *block = NULL, *head = NULL;
+
+    if (!ptr)
+        return OGS_ERROR;
+
+    block = mem_block_of(ptr);
+    arena = block->arena;
+    ogs_assert(arena);
+
+    if (arena == self_arena) {
+        arena_drain(arena);
+        talloc_free(block);
+        return OGS_OK;
+    }
+
+    if (ogs_atomic_load(&arena->orphan)) {
+        /* No thread would drain it : the mutex keeps it from being adopted */
+        ogs_thread_mutex_lock(&mutex);
+        if (arena->orphan) {
+            talloc_free(block);
+            ogs_thread_mutex_unlock(&mutex);
+            return OGS_OK;
+        }
+        ogs_thread_mutex_unlock(&mutex);
+    }
+
+    head = ogs_atomic_load(&arena->remote);
+    do {
+        block->next = head;
+    } while (!ogs_atomic_cas(&arena->remote, &head, block));
+
+    return OGS_OK;
+}
+
+#else
+
 /*****************************************
  * Memory Pool - Use pkbuf library
  *****************************************/
@@ -218,3 +503,5 @@ void *ogs_realloc_debug(void *ptr, size_t size, const char *file_line)
         return ptr;
     }
 }
+
+#endif
@@ -30,6 +30,7 @@ extern "C" {
 
 void ogs_mem_init(void);
 void ogs_mem_final(void);
+void ogs_mem_thread_exit(void);
 
 void *ogs_mem_get_mutex(void);
 
@@ -64,13 +65,10 @@ int ogs_free_debug(void *ptr);
  * Memory Pool - Use talloc library
  *****************************************/
 
-#define ogs_malloc(size) \
-    ogs_talloc_size(__ogs_talloc_core, size, __location__)
-#define ogs_calloc(nmemb, size) \
-    ogs_talloc_zero_size(__ogs_talloc_core, (nmemb) * (size), __location__)
-#define ogs_realloc(oldptr, size) \
-    ogs_talloc_realloc_size(__ogs_talloc_core, oldptr, size, __location__)
-#define ogs_free(ptr) ogs_talloc_free(ptr, __location__)
+#define ogs_malloc(size) ogs_malloc_debug(size, __location__)
+#define ogs_calloc(nmemb, size) ogs_calloc_debug(nmemb, size, __location__)
+#define ogs_realloc(ptr, size) ogs_realloc_debug(ptr, size, __location__)
+#define ogs_free(ptr) ogs_free_debug(ptr)
 
 #else
 
@@ -48,7 +48,7 @@ void ogs_notify_init(ogs_pollset_t *pollset)
 #endif
 
     pollset->notify.poll = ogs_pollset_add(pollset, OGS_POLLIN,
-            pollset->notify.fd[0], ogs_drain_pollset, NULL);
+            pollset->notify.fd[0], ogs_drain_pollset, pollset);
     ogs_assert(pollset->notify.poll);
 }
 
@@ -76,6 +76,14 @@ int ogs_notify_pollset(ogs_pollset_t *pollset)
 
     ogs_assert(pollset);
 
+    /*
+     * Only the first notification since the last drain wakes up the
+     * poller. Later ones find it already woken up, and what they
+     * announce (e.g. an event queued) is handled after the drain.
+     */
+    if (ogs_atomic_exchange(&pollset->notify.pending, 1))
+        return OGS_OK;
+
 #if defined(HAVE_EVENTFD)
     r = write(pollset->notify.fd[0], (void*)&msg, sizeof(msg));
 #else
@@ -84,6 +92,7 @@ int ogs_notify_pollset(ogs_pollset_t *pollset)
 
     if (r < 0) {
         ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno, "notify failed");
+        ogs_atomic_store(&pollset->notify.pending, 0);
         return OGS_ERROR;
     }
 
@@ -92,6 +101,7 @@ int ogs_notify_pollset(ogs_pollset_t *pollset)
 
 static void ogs_drain_pollset(short when, ogs_socket_t fd, void *data)
 {
+    ogs_pollset_t *pollset = data;
     ssize_t r;
 #if defined(HAVE_EVENTFD)
     uint64_t msg;
@@ -100,6 +110,7 @@ static void ogs_drain_pollset(short when, ogs_socket_t fd, void *data)
 #endif
 
     ogs_assert(when == OGS_POLLIN);
+    ogs_assert(pollset);
 
 #if defined(HAVE_EVENTFD)
     r = read(fd, (char *)&msg, sizeof(msg));
@@ -109,4 +120,12 @@ static void ogs_drain_pollset(short when, ogs_socket_t fd, void *data)
     if (r < 0) {
         ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno, "drain failed");
     }
+
+    /*
+     * Cleared only after reading. Clearing it before would let the read
+     * consume the wakeup of a notifier that found it cleared, leaving it
+     * set with nothing to read, so that no later notification is written.
+     * A notifier skipped in between is handled after the poll returns.
+     */
+    ogs_atomic_store(&pollset->notify.pending, 0);
 }
@@ -86,6 +86,135 @@ static ogs_cluster_t *cluster_alloc(
 static void cluster_free(ogs_pkbuf_pool_t *pool, ogs_cluster_t *cluster);
 #endif
 
+#if OGS_USE_TALLOC == 1
+/*
+ * Per-thread Magazines
+ *
+ * Freed pkbufs up to 32 KB are kept in a small LIFO magazine of the
+ * freeing thread, one per size class, and handed out again without
+ * taking the memory mutex. A full magazine returns half of its
+ * buffers to a shared depot, and an empty one refills half from it,
+ * so the mutex is only taken once per batch. The depot is bounded;
+ * anything beyond it goes back to talloc.
+ *
+ * A recycled pkbuf has its header reset but its data is not cleared,
+ * like the clusters of the OGS_POOL allocator.
+ *
+ * Only buffers without a talloc parent (pool == NULL) are cached, so
+ * the data path of the UPF and SGW-U allocates with a NULL pool to
+ * stay away from the libc malloc.
+ */
+#define OGS_PKBUF_MAGAZINE_SIZE     32
+#define OGS_PKBUF_MAGAZINE_BATCH    (OGS_PKBUF_MAGAZINE_SIZE / 2)
+#define OGS_PKBUF_DEPOT_BYTES       (4*1024*1024)
+
+static const unsigned int cache_size[] = {
+    128, 256, 512, 1024, 2048, 8192, 32768,
+};
+#define OGS_PKBUF_CACHE_CLASS   OGS_ARRAY_SIZE(cache_size)
+
+typedef struct pkbuf_magazine_s {
+    struct pkbuf_magazine_s *next;
+
+    struct {
+        int count;
+        ogs_pkbuf_t *pkbuf[OGS_PKBUF_MAGAZINE_SIZE];
+    } slot[OGS_PKBUF_CACHE_CLASS];
+
+    uint64_t hit;           /* Written by the owner, read by ogs_pkbuf_stat() */
+    uint64_t miss;
+} pkbuf_magazine_t;
+
+static struct {
+    bool enabled;
+    ogs_thread_mutex_t mutex;
+
+    pkbuf_magazine_t *magazine_list;
+
+    struct {
+        ogs_pkbuf_t *head;
+        int count;
+        int max;
+    } depot[OGS_PKBUF_CACHE_CLASS];
+} cache;
+
+static ogs_thread_local pkbuf_magazine_t *self_magazine;
+
+static int cache_class(unsigned int size)
+{
+    int i;
+
+    for (i = 0; i < OGS_PKBUF_CACHE_CLASS; i++)
+        if (size <= cache_size[i])
+            return i;
+
+    return -1;
+}
+
+static pkbuf_magazine_t *magazine_self(void)
+{
+    pkbuf_magazine_t *magazine = NULL;
+
+    if (ogs_likely(self_magazine))
+        return self_magazine;
+
+    if (!cache.enabled)
+        return NULL;
+
+    /* Stays registered until ogs_pkbuf_final() */
+    magazine = calloc(1, sizeof *magazine);
+    if (!magazine)
+        return NULL;
+
+    ogs_thread_mutex_lock(&cache.mutex);
+    magazine->next = cache.magazine_list;
+    cache.magazine_list = magazine;
+    ogs_thread_mutex_unlock(&cache.mutex);
+
+    self_magazine = magazine;
+
+    return magazine;
+}
+
+static void magazine_refill(pkbuf_magazine_t *magazine, int i)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_thread_mutex_lock(&cache.mutex);
+    while (magazine->slot[i].count < OGS_PKBUF_MAGAZINE_BATCH &&
+            (pkbuf = cache.depot[i].head)) {
+        cache.depot[i].head = (ogs_pkbuf_t *)pkbuf->lnode.next;
+        cache.depot[i].count--;
+        magazine->slot[i].pkbuf[magazine->slot[i].count++] = pkbuf;
+    }
+    ogs_thread_mutex_unlock(&cache.mutex);
+}
+
+static void magazine_flush(pkbuf_magazine_t *magazine, int i, int n)
+{
+    ogs_pkbuf_t *pkbuf = NULL, *overflow = NULL;
+
+    ogs_thread_mutex_lock(&cache.mutex);
+    while (n-- > 0 && magazine->slot[i].count) {
+        pkbuf = magazine->slot[i].pkbuf[--magazine->slot[i].count];
+        if (cache.depot[i].count < cache.depot[i].max) {
+            pkbuf->lnode.next = (ogs_lnode_t *)cache.depot[i].head;
+            cache.depot[i].head = pkbuf;
+            cache.depot[i].count++;
+        } else {
+            pkbuf->lnode.next = (ogs_lnode_t *)overflow;
+            overflow = pkbuf;
+        }
+    }
+    ogs_thread_mutex_unlock(&cache.mutex);
+
+    while ((pkbuf = overflow)) {
+        overflow = (ogs_pkbuf_t *)pkbuf->lnode.next;
+        ogs_talloc_free(pkbuf, OGS_FILE_LINE);
+    }
+}
+#endif
+
 void *ogs_pkbuf_put_data(
         ogs_pkbuf_t *pkbuf, const void *data, unsigned int len)
 {
@@ -100,6 +229,17 @@ void ogs_pkbuf_init(void)
 #if OGS_USE_TALLOC == 0
     ogs_pool_init(&pkbuf_pool, ogs_core()->pkbuf.pool);
 
+#else
+    int i;
+
+    memset(&cache, 0, sizeof(cache));
+    ogs_thread_mutex_init(&cache.mutex);
+
+    for (i = 0; i < OGS_PKBUF_CACHE_CLASS; i++)
+        cache.depot[i].max = ogs_max(OGS_PKBUF_MAGAZINE_SIZE,
+                OGS_PKBUF_DEPOT_BYTES / cache_size[i]);
+
+    cache.enabled = true;
 #endif
 }
 
@@ -107,6 +247,57 @@ void ogs_pkbuf_final(void)
 {
 #if OGS_USE_TALLOC == 0
     ogs_pool_final(&pkbuf_pool);
+#else
+    int i;
+    pkbuf_magazine_t *magazine = NULL, *next = NULL;
+    ogs_pkbuf_cache_stat_t stat;
+
+    ogs_pkbuf_cache_stat(&stat);
+    ogs_debug("pkbuf cache : %llu hit, %llu miss",
+            (unsigned long long)stat.hit, (unsigned long long)stat.miss);
+
+    cache.enabled = false;
+
+    /* The other threads are gone : release every cached buffer */
+    for (magazine = cache.magazine_list; magazine; magazine = next) {
+        next = magazine->next;
+        for (i = 0; i < OGS_PKBUF_CACHE_CLASS; i++)
+            magazine_flush(magazine, i, OGS_PKBUF_MAGAZINE_SIZE);
+        free(magazine);
+    }
+    cache.magazine_list = NULL;
+    self_magazine = NULL;
+
+    for (i = 0; i < OGS_PKBUF_CACHE_CLASS; i++) {
+        ogs_pkbuf_t *pkbuf = NULL;
+
+        while ((pkbuf = cache.depot[i].head)) {
+            cache.depot[i].head = (ogs_pkbuf_t *)pkbuf->lnode.next;
+            ogs_talloc_free(pkbuf, OGS_FILE_LINE);
+        }
+        cache.depot[i].count = 0;
+    }
+
+    ogs_thread_mutex_destroy(&cache.mutex);
+#endif
+}
+
+void ogs_pkbuf_cache_stat(ogs_pkbuf_cache_stat_t *stat)
+{
+#if OGS_USE_TALLOC == 1
+    pkbuf_magazine_t *magazine = NULL;
+#endif
+
+    ogs_assert(stat);
+    memset(stat, 0, sizeof(*stat));
+
+#if OGS_USE_TALLOC == 1
+    ogs_thread_mutex_lock(&cache.mutex);
+    for (magazine = cache.magazine_list; magazine; magazine = magazine->next) {
+        stat->hit += ogs_atomic_load(&magazine->hit);
+        stat->miss += ogs_atomic_load(&magazine->miss);
+    }
+    ogs_thread_mutex_unlock(&cache.mutex);
 #endif
 }
 
@@ -222,13 +413,46 @@ ogs_pkbuf_t *ogs_pkbuf_alloc_debug(
 {
 #if OGS_USE_TALLOC == 1
     ogs_pkbuf_t *pkbuf = NULL;
+    pkbuf_magazine_t *magazine = NULL;
+    int i = -1;
+
+    /* Buffers with a talloc parent are never cached */
+    if (!pool)
+        i = cache_class(size);
+
+    if (i >= 0 && (magazine = magazine_self())) {
+        if (!magazine->slot[i].count)
+            magazine_refill(magazine, i);
+
+        if (magazine->slot[i].count) {
+            pkbuf = magazine->slot[i].pkbuf[--magazine->slot[i].count];
+            ogs_atomic_inc(&magazine->hit);
+
+            memset(pkbuf, 0, sizeof(*pkbuf));
+        } else {
+            ogs_atomic_inc(&magazine->miss);
+        }
+    }
 
-    pkbuf = ogs_talloc_zero_size(pool, sizeof(*pkbuf) + size, file_line);
     if (!pkbuf) {
-        ogs_error("ogs_pkbuf_alloc() failed [size=%d]", size);
-        return NULL;
+        if (i >= 0) {
+            pkbuf = ogs_talloc_size(
+                    NULL, sizeof(*pkbuf) + cache_size[i], file_line);
+            if (pkbuf)
+                memset(pkbuf, 0, sizeof(*pkbuf));
+        } else {
+            pkbuf = ogs_talloc_zero_size(
+                    pool, sizeof(*pkbuf) + size, file_line);
+        }
+        if (!pkbuf) {
+            ogs_error("ogs_pkbuf_alloc() failed [size=%d]", size);
+            return NULL;
+        }
     }
 
+    if (i >= 0)
+        pkbuf->cache = i + 1;
+
     pkbuf->head = pkbuf->_data;
     pkbuf->end = pkbuf->_data + size;
 
@@ -286,10 +510,93 @@ ogs_pkbuf_t *ogs_pkbuf_alloc_debug(
 #endif
 }
 
+#if OGS_USE_TALLOC == 1
+typedef struct pkbuf_external_s {
+    ogs_pkbuf_free_cb free_cb;
+    void *data;
+} pkbuf_external_t;
+
+static int pkbuf_external_destructor(ogs_pkbuf_t *pkbuf)
+{
+    pkbuf_external_t *external = (pkbuf_external_t *)pkbuf->_data;
+
+    external->free_cb(pkbuf->head, external->data);
+
+    return 0;
+}
+#endif
+
+ogs_pkbuf_t *ogs_pkbuf_attach_debug(ogs_pkbuf_pool_t *pool,
+        unsigned char *buf, unsigned int size,
+        ogs_pkbuf_free_cb free_cb, void *data, const char *file_line)
+{
+#if OGS_USE_TALLOC == 1
+    ogs_pkbuf_t *pkbuf = NULL;
+    pkbuf_external_t *external = NULL;
+
+    ogs_assert(buf);
+    ogs_assert(size);
+    ogs_assert(free_cb);
+
+    pkbuf = ogs_talloc_zero_size(pool,
+            sizeof(*pkbuf) + sizeof(*external), file_line);
+    if (!pkbuf) {
+        ogs_error("ogs_pkbuf_attach() failed [size=%d]", size);
+        return NULL;
+    }
+
+    external = (pkbuf_external_t *)pkbuf->_data;
+    external->free_cb = free_cb;
+    external->data = data;
+
+    pkbuf->head = buf;
+    pkbuf->end = buf + size;
+
+    pkbuf->len = 0;
+
+    pkbuf->data = buf;
+    pkbuf->tail = buf;
+
+    pkbuf->file_line = file_line; /* For debug */
+
+    talloc_set_destructor(pkbuf, pkbuf_external_destructor);
+
+    return pkbuf;
+#else
+    return NULL;
+#endif
+}
+
 void ogs_pkbuf_free(ogs_pkbuf_t *pkbuf)
 {
 #if OGS_USE_TALLOC == 1
+    pkbuf_magazine_t *magazine = NULL;
+    ogs_pkbuf_t *origin = NULL;
+    int i;
+
+    ogs_assert(pkbuf);
+
+    /* The data is still used by a clone */
+    if (ogs_atomic_load(&pkbuf->reference_count) &&
+        ogs_atomic_dec(&pkbuf->reference_count) != (unsigned int)-1)
+        return;
+
+    i = (int)pkbuf->cache - 1;
+    if (i >= 0 && (magazine = magazine_self())) {
+        if (magazine->slot[i].count == OGS_PKBUF_MAGAZINE_SIZE)
+            magazine_flush(magazine, i, OGS_PKBUF_MAGAZINE_BATCH);
+
+        magazine->slot[i].pkbuf[magazine->slot[i].count++] = pkbuf;
+        return;
+    }
+
+    origin = pkbuf->origin;
+
     ogs_talloc_free(pkbuf, OGS_FILE_LINE);
+
+    /* A clone gives back its reference to the original */
+    if (origin)
+        ogs_pkbuf_free(origin);
 #else
     ogs_pkbuf_pool_t *pool = NULL;
     ogs_cluster_t *cluster = NULL;
@@ -340,13 +647,13 @@ ogs_pkbuf_t *ogs_pkbuf_copy_debug(ogs_pkbuf_t *pkbuf, const char *file_line)
     }
 
     /* copy data */
-    memcpy(newbuf->_data, pkbuf->_data, size);
+    memcpy(newbuf->head, pkbuf->head, size);
 
     /* copy header */
     newbuf->len = pkbuf->len;
 
-    newbuf->tail += pkbuf->tail - pkbuf->_data;
-    newbuf->data += pkbuf->data - pkbuf->_data;
+    newbuf->tail += pkbuf->tail - pkbuf->head;
+    newbuf->data += pkbuf->data - pkbuf->head;
 
     return newbuf;
 #else
@@ -372,6 +679,63 @@ ogs_pkbuf_t *ogs_pkbuf_copy_debug(ogs_pkbuf_t *pkbuf, const char *file_line)
     return newbuf;
 }
 
+ogs_pkbuf_t *ogs_pkbuf_clone_debug(ogs_pkbuf_t *pkbuf, const char *file_line)
+{
+#if OGS_USE_TALLOC == 1
+    ogs_pkbuf_t *newbuf = NULL;
+
+    ogs_assert(pkbuf);
+
+    newbuf = ogs_talloc_zero_size(NULL, sizeof(*newbuf), file_line);
+    if (!newbuf) {
+        ogs_error("ogs_pkbuf_clone() failed [len=%d]", pkbuf->len);
+        return NULL;
+    }
+
+    /* Released by ogs_pkbuf_free() of the clone */
+    ogs_atomic_inc(&pkbuf->reference_count);
+    newbuf->origin = pkbuf;
+
+    newbuf->head = pkbuf->head;
+    newbuf->end = pkbuf->end;
+
+    newbuf->len = pkbuf->len;
+
+    newbuf->data = pkbuf->data;
+    newbuf->tail = pkbuf->tail;
+
+    newbuf->file_line = file_line; /* For debug */
+
+    return newbuf;
+#else
+    /* The cluster is already shared by reference */
+    return ogs_pkbuf_copy_debug(pkbuf, file_line);
+#endif
+}
+
+ogs_pkbuf_t *ogs_pkbuf_fit_debug(ogs_pkbuf_t *pkbuf,
+        unsigned int headroom, unsigned int tailroom, const char *file_line)
+{
+    ogs_pkbuf_t *newbuf = NULL;
+
+    ogs_assert(pkbuf);
+
+    newbuf = ogs_pkbuf_alloc_debug(
+            NULL, headroom + pkbuf->len + tailroom, file_line);
+    if (!newbuf) {
+        ogs_error("ogs_pkbuf_alloc() failed [len=%d]", pkbuf->len);
+        ogs_pkbuf_free(pkbuf);
+        return NULL;
+    }
+
+    ogs_pkbuf_reserve(newbuf, headroom);
+    ogs_pkbuf_put_data(newbuf, pkbuf->data, pkbuf->len);
+
+    ogs_pkbuf_free(pkbuf);
+
+    return newbuf;
+}
+
 #if OGS_USE_TALLOC == 0
 static ogs_cluster_t *cluster_alloc(
         ogs_pkbuf_pool_t *pool, unsigned int size)
@@ -59,6 +59,14 @@ typedef struct ogs_pkbuf_s {
     
     ogs_pkbuf_pool_t *pool;
 
+    /* Size class + 1 when the buffer can be cached, otherwise 0 */
+    unsigned int cache;
+
+    /* Clones still sharing the data, see ogs_pkbuf_clone() */
+    unsigned int reference_count;
+    /* The buffer owning the data if this is a clone */
+    struct ogs_pkbuf_s *origin;
+
     unsigned char _data[0]; /*!< optional immediate data array */
 } ogs_pkbuf_t;
 
@@ -76,6 +84,13 @@ typedef struct ogs_pkbuf_config_s {
 void ogs_pkbuf_init(void);
 void ogs_pkbuf_final(void);
 
+typedef struct ogs_pkbuf_cache_stat_s {
+    uint64_t hit;   /* Allocations served from a per-thread magazine */
+    uint64_t miss;  /* Allocations that went to the allocator */
+} ogs_pkbuf_cache_stat_t;
+
+void ogs_pkbuf_cache_stat(ogs_pkbuf_cache_stat_t *stat);
+
 void ogs_pkbuf_default_init(ogs_pkbuf_config_t *config);
 void ogs_pkbuf_default_create(ogs_pkbuf_config_t *config);
 void ogs_pkbuf_default_destroy(void);
@@ -89,12 +104,45 @@ ogs_pkbuf_t *ogs_pkbuf_alloc_debug(
         ogs_pkbuf_pool_t *pool, unsigned int size, const char *file_line);
 void ogs_pkbuf_free(ogs_pkbuf_t *pkbuf);
 
+/*
+ * Wrap an external buffer (e.g. an AF_XDP UMEM frame) in a pkbuf
+ * without copying it. The buffer is handed back with 'free_cb'
+ * when the pkbuf is freed. Only available with OGS_USE_TALLOC.
+ */
+typedef void (*ogs_pkbuf_free_cb)(unsigned char *buf, void *data);
+#define ogs_pkbuf_attach(pool, buf, size, free_cb, data) \
+    ogs_pkbuf_attach_debug(pool, buf, size, free_cb, data, OGS_FILE_LINE)
+ogs_pkbuf_t *ogs_pkbuf_attach_debug(ogs_pkbuf_pool_t *pool,
+        unsigned char *buf, unsigned int size,
+        ogs_pkbuf_free_cb free_cb, void *data, const char *file_line);
+
 void *ogs_pkbuf_put_data(
         ogs_pkbuf_t *pkbuf, const void *data, unsigned int len);
 #define ogs_pkbuf_copy(pkbuf) \
     ogs_pkbuf_copy_debug(pkbuf, OGS_FILE_LINE)
 ogs_pkbuf_t *ogs_pkbuf_copy_debug(ogs_pkbuf_t *pkbuf, const char *file_line);
 
+/*
+ * Return a new pkbuf sharing the data of 'pkbuf' instead of copying it.
+ * The data is released when the original and all of its clones are freed.
+ * Neither of them may modify the shared data, so this is only meant for
+ * an encoded message sent to several peers (e.g. Paging).
+ */
+#define ogs_pkbuf_clone(pkbuf) \
+    ogs_pkbuf_clone_debug(pkbuf, OGS_FILE_LINE)
+ogs_pkbuf_t *ogs_pkbuf_clone_debug(ogs_pkbuf_t *pkbuf, const char *file_line);
+
+/*
+ * Move the data of a scratch buffer into a new buffer that just fits it,
+ * with 'headroom' and 'tailroom' bytes around the data. The scratch buffer
+ * is freed in any case. Encoders use this to avoid holding OGS_MAX_SDU_LEN
+ * clusters for small control-plane messages.
+ */
+#define ogs_pkbuf_fit(pkbuf, headroom, tailroom) \
+    ogs_pkbuf_fit_debug(pkbuf, headroom, tailroom, OGS_FILE_LINE)
+ogs_pkbuf_t *ogs_pkbuf_fit_debug(ogs_pkbuf_t *pkbuf,
+        unsigned int headroom, unsigned int tailroom, const char *file_line);
+
 static ogs_inline int ogs_pkbuf_tailroom(const ogs_pkbuf_t *pkbuf)
 {
     return pkbuf->end - pkbuf->tail;
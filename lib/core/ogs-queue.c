@@ -37,12 +37,34 @@
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __ogs_event_domain
 
+/*
+ * Bounded ring of cells, each stamped with a sequence number
+ * (D. Vyukov's bounded MPMC queue). A producer claims the cell at 'in'
+ * when its sequence equals 'in', and publishes it by setting the
+ * sequence to 'in + 1'. The consumer takes the cell at 'out' when its
+ * sequence equals 'out + 1', and hands it back with 'out + bounds'.
+ *
+ * Push and pop never take a lock. The mutex and condition variables
+ * are only used by a thread that has to sleep on a full or empty queue,
+ * and they are signalled only when such a waiter exists.
+ */
+typedef struct ogs_queue_cell_s {
+    uint64_t            sequence;
+    void                *data;
+} ogs_queue_cell_t;
+
+#define OGS_QUEUE_CACHE_LINE 64
+
 typedef struct ogs_queue_s {
-    void              **data;
-    unsigned int        nelts; /**< # elements */
-    unsigned int        in;    /**< next empty location */
-    unsigned int        out;   /**< next filled location */
+    ogs_queue_cell_t    *cell;
     unsigned int        bounds;/**< max size of queue */
+
+    char pad0[OGS_QUEUE_CACHE_LINE];
+    uint64_t            in;    /**< next empty location */
+    char pad1[OGS_QUEUE_CACHE_LINE];
+    uint64_t            out;   /**< next filled location */
+    char pad2[OGS_QUEUE_CACHE_LINE];
+
     unsigned int        full_waiters;
     unsigned int        empty_waiters;
     ogs_thread_mutex_t  one_big_mutex;
@@ -51,43 +73,32 @@ typedef struct ogs_queue_s {
     int                 terminated;
 } ogs_queue_t;
 
-/**
- * Detects when the ogs_queue_t is full. This utility function is expected
- * to be called from within critical sections, and is not threadsafe.
- */
-#define ogs_queue_full(queue) ((queue)->nelts == (queue)->bounds)
-
-/**
- * Detects when the ogs_queue_t is empty. This utility function is expected
- * to be called from within critical sections, and is not threadsafe.
- */
-#define ogs_queue_empty(queue) ((queue)->nelts == 0)
-
-/**
- * Callback routine that is called to destroy this
- * ogs_queue_t when its pool is destroyed.
- */
 ogs_queue_t *ogs_queue_create(unsigned int capacity)
 {
+    unsigned int i;
+
     ogs_queue_t *queue = ogs_calloc(1, sizeof *queue);
     if (!queue) {
         ogs_error("ogs_calloc() failed");
         return NULL;
     }
     ogs_assert(queue);
+    ogs_assert(capacity);
 
     ogs_thread_mutex_init(&queue->one_big_mutex);
     ogs_thread_cond_init(&queue->not_empty);
     ogs_thread_cond_init(&queue->not_full);
 
-    queue->data = ogs_calloc(1, capacity * sizeof(void*));
-    if (!queue->data) {
-        ogs_error("ogs_calloc[capacity:%d, sizeof(void*):%d] failed",
-                (int)capacity, (int)sizeof(void*));
+    queue->cell = ogs_calloc(capacity, sizeof(ogs_queue_cell_t));
+    if (!queue->cell) {
+        ogs_error("ogs_calloc[capacity:%d, sizeof(cell):%d] failed",
+                (int)capacity, (int)sizeof(ogs_queue_cell_t));
         return NULL;
     }
+    for (i = 0; i < capacity; i++)
+        queue->cell[i].sequence = i;
+
     queue->bounds = capacity;
-    queue->nelts = 0;
     queue->in = 0;
     queue->out = 0;
     queue->terminated = 0;
@@ -101,7 +112,7 @@ void ogs_queue_destroy(ogs_queue_t *queue)
 {
     ogs_assert(queue);
 
-    ogs_free(queue->data);
+    ogs_free(queue->cell);
 
     ogs_thread_cond_destroy(&queue->not_empty);
     ogs_thread_cond_destroy(&queue->not_full);
@@ -110,63 +121,147 @@ void ogs_queue_destroy(ogs_queue_t *queue)
     ogs_free(queue);
 }
 
+/**
+ * Lock-free push. Returns OGS_RETRY when the queue is full.
+ */
+static int ring_push(ogs_queue_t *queue, void *data)
+{
+    ogs_queue_cell_t *cell = NULL;
+    uint64_t pos, sequence;
+    int64_t diff;
+
+    pos = __atomic_load_n(&queue->in, __ATOMIC_RELAXED);
+    for ( ;; ) {
+        cell = &queue->cell[pos % queue->bounds];
+        sequence = ogs_atomic_load(&cell->sequence);
+        diff = (int64_t)(sequence - pos);
+
+        if (diff == 0) {
+            if (ogs_atomic_cas(&queue->in, &pos, pos + 1))
+                break;
+        } else if (diff < 0) {
+            return OGS_RETRY;
+        } else {
+            pos = __atomic_load_n(&queue->in, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->data = data;
+    ogs_atomic_store(&cell->sequence, pos + 1);
+
+    return OGS_OK;
+}
+
+/**
+ * Lock-free pop. Returns OGS_RETRY when the queue is empty.
+ */
+static int ring_pop(ogs_queue_t *queue, void **data)
+{
+    ogs_queue_cell_t *cell = NULL;
+    uint64_t pos, sequence;
+    int64_t diff;
+
+    pos = __atomic_load_n(&queue->out, __ATOMIC_RELAXED);
+    for ( ;; ) {
+        cell = &queue->cell[pos % queue->bounds];
+        sequence = ogs_atomic_load(&cell->sequence);
+        diff = (int64_t)(sequence - (pos + 1));
+
+        if (diff == 0) {
+            if (ogs_atomic_cas(&queue->out, &pos, pos + 1))
+                break;
+        } else if (diff < 0) {
+            return OGS_RETRY;
+        } else {
+            pos = __atomic_load_n(&queue->out, __ATOMIC_RELAXED);
+        }
+    }
+
+    *data = cell->data;
+    ogs_atomic_store(&cell->sequence, pos + queue->bounds);
+
+    return OGS_OK;
+}
+
+/**
+ * Wakes up one thread sleeping on 'cond'. The fence pairs with the one
+ * taken by a waiter after registering itself, so that either the waiter
+ * sees the new state of the ring or we see the waiter.
+ */
+static void queue_wakeup(ogs_queue_t *queue,
+        unsigned int *waiters, ogs_thread_cond_t *cond)
+{
+    ogs_atomic_fence();
+
+    if (!ogs_atomic_load(waiters))
+        return;
+
+    ogs_thread_mutex_lock(&queue->one_big_mutex);
+    ogs_thread_cond_signal(cond);
+    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+}
+
 static int queue_push(ogs_queue_t *queue, void *data, ogs_time_t timeout)
 {
     int rv;
 
-    if (queue->terminated) {
+    if (ogs_atomic_load(&queue->terminated)) {
         return OGS_DONE; /* no more elements ever again */
     }
 
-    ogs_thread_mutex_lock(&queue->one_big_mutex);
-
-    if (ogs_queue_full(queue)) {
+    rv = ring_push(queue, data);
+    if (rv != OGS_OK) {
         if (!timeout) {
-            ogs_thread_mutex_unlock(&queue->one_big_mutex);
             return OGS_RETRY;
         }
+
+        ogs_thread_mutex_lock(&queue->one_big_mutex);
+
         if (!queue->terminated) {
-            queue->full_waiters++;
-            if (timeout > 0) {
-                rv = ogs_thread_cond_timedwait(&queue->not_full,
-                                               &queue->one_big_mutex,
-                                               timeout);
-            }
-            else {
-                rv = ogs_thread_cond_wait(&queue->not_full,
-                                          &queue->one_big_mutex);
-            }
-            queue->full_waiters--;
-            if (rv != OGS_OK) {
-                ogs_thread_mutex_unlock(&queue->one_big_mutex);
-                return rv;
+            ogs_atomic_inc(&queue->full_waiters);
+            ogs_atomic_fence();
+
+            /* A consumer may have made room before it could see us */
+            rv = ring_push(queue, data);
+            while (rv != OGS_OK) {
+                if (timeout > 0) {
+                    rv = ogs_thread_cond_timedwait(&queue->not_full,
+                                                   &queue->one_big_mutex,
+                                                   timeout);
+                }
+                else {
+                    rv = ogs_thread_cond_wait(&queue->not_full,
+                                              &queue->one_big_mutex);
+                }
+                if (rv != OGS_OK) {
+                    ogs_atomic_dec(&queue->full_waiters);
+                    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+                    return rv;
+                }
+                rv = ring_push(queue, data);
+
+                /* Another producer may have been faster : wait again */
+                if (timeout > 0 || queue->terminated)
+                    break;
             }
+            ogs_atomic_dec(&queue->full_waiters);
         }
-        /* If we wake up and it's still empty, then we were interrupted */
-        if (ogs_queue_full(queue)) {
+        /* If we wake up and it's still full, then we were interrupted */
+        if (rv != OGS_OK) {
             ogs_warn("queue full (intr)");
             ogs_thread_mutex_unlock(&queue->one_big_mutex);
             if (queue->terminated) {
                 return OGS_DONE; /* no more elements ever again */
-            }
-            else {
+            } else {
                 return OGS_ERROR;
             }
         }
-    }
-
-    queue->data[queue->in] = data;
-    queue->in++;
-    if (queue->in >= queue->bounds)
-        queue->in -= queue->bounds;
-    queue->nelts++;
 
-    if (queue->empty_waiters) {
-        ogs_trace("signal !empty");
-        ogs_thread_cond_signal(&queue->not_empty);
+        ogs_thread_mutex_unlock(&queue->one_big_mutex);
     }
 
-    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+    queue_wakeup(queue, &queue->empty_waiters, &queue->not_empty);
+
     return OGS_OK;
 }
 
@@ -194,7 +289,8 @@ int ogs_queue_timedpush(ogs_queue_t *queue, void *data, ogs_time_t timeout)
  * not thread safe
  */
 unsigned int ogs_queue_size(ogs_queue_t *queue) {
-    return queue->nelts;
+    return (unsigned int)(ogs_atomic_load(&queue->in) -
+                            ogs_atomic_load(&queue->out));
 }
 
 /**
@@ -208,37 +304,49 @@ static int queue_pop(ogs_queue_t *queue, void **data, ogs_time_t timeout)
 {
     int rv;
 
-    if (queue->terminated) {
+    if (ogs_atomic_load(&queue->terminated)) {
         return OGS_DONE; /* no more elements ever again */
     }
 
-    ogs_thread_mutex_lock(&queue->one_big_mutex);
-
-    /* Keep waiting until we wake up and find that the queue is not empty. */
-    if (ogs_queue_empty(queue)) {
+    rv = ring_pop(queue, data);
+    if (rv != OGS_OK) {
         if (!timeout) {
-            ogs_thread_mutex_unlock(&queue->one_big_mutex);
             return OGS_RETRY;
         }
+
+        ogs_thread_mutex_lock(&queue->one_big_mutex);
+
         if (!queue->terminated) {
-            queue->empty_waiters++;
-            if (timeout > 0) {
-                rv = ogs_thread_cond_timedwait(&queue->not_empty,
-                                               &queue->one_big_mutex,
-                                               timeout);
-            }
-            else {
-                rv = ogs_thread_cond_wait(&queue->not_empty,
-                                          &queue->one_big_mutex);
-            }
-            queue->empty_waiters--;
-            if (rv != OGS_OK) {
-                ogs_thread_mutex_unlock(&queue->one_big_mutex);
-                return rv;
+            ogs_atomic_inc(&queue->empty_waiters);
+            ogs_atomic_fence();
+
+            /* A producer may have pushed before it could see us */
+            rv = ring_pop(queue, data);
+            while (rv != OGS_OK) {
+                if (timeout > 0) {
+                    rv = ogs_thread_cond_timedwait(&queue->not_empty,
+                                                   &queue->one_big_mutex,
+                                                   timeout);
+                }
+                else {
+                    rv = ogs_thread_cond_wait(&queue->not_empty,
+                                              &queue->one_big_mutex);
+                }
+                if (rv != OGS_OK) {
+                    ogs_atomic_dec(&queue->empty_waiters);
+                    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+                    return rv;
+                }
+                rv = ring_pop(queue, data);
+
+                /* Another consumer may have been faster : wait again */
+                if (timeout > 0 || queue->terminated)
+                    break;
             }
+            ogs_atomic_dec(&queue->empty_waiters);
         }
         /* If we wake up and it's still empty, then we were interrupted */
-        if (ogs_queue_empty(queue)) {
+        if (rv != OGS_OK) {
             ogs_warn("queue empty (intr)");
             ogs_thread_mutex_unlock(&queue->one_big_mutex);
             if (queue->terminated) {
@@ -247,20 +355,12 @@ static int queue_pop(ogs_queue_t *queue, void **data, ogs_time_t timeout)
                 return OGS_ERROR;
             }
         }
-    } 
 
-    *data = queue->data[queue->out];
-    queue->nelts--;
-
-    queue->out++;
-    if (queue->out >= queue->bounds)
-        queue->out -= queue->bounds;
-    if (queue->full_waiters) {
-        ogs_trace("signal !full");
-        ogs_thread_cond_signal(&queue->not_full);
+        ogs_thread_mutex_unlock(&queue->one_big_mutex);
     }
 
-    ogs_thread_mutex_unlock(&queue->one_big_mutex);
+    queue_wakeup(queue, &queue->full_waiters, &queue->not_full);
+
     return OGS_OK;
 }
 
@@ -300,9 +400,8 @@ int ogs_queue_term(ogs_queue_t *queue)
      * we could end up setting it and waking everybody up just after a 
      * would-be popper checks it but right before they block
      */
-    queue->terminated = 1;
+    ogs_atomic_store(&queue->terminated, 1);
     ogs_thread_mutex_unlock(&queue->one_big_mutex);
 
     return ogs_queue_interrupt_all(queue);
 }
-
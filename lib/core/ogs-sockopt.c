@@ -129,6 +129,28 @@ int ogs_listen_reusable(ogs_socket_t fd, int on)
     return OGS_OK;
 }
 
+int ogs_port_reusable(ogs_socket_t fd, int on)
+{
+#if defined(SO_REUSEPORT) && !defined(_WIN32)
+    int rc;
+
+    ogs_assert(fd != INVALID_SOCKET);
+
+    ogs_debug("Turn on SO_REUSEPORT");
+    rc = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (void *)&on, sizeof(int));
+    if (rc != OGS_OK) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "setsockopt(SOL_SOCKET, SO_REUSEPORT) failed");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+#else
+    ogs_error("SO_REUSEPORT is not supported on this platform");
+    return OGS_ERROR;
+#endif
+}
+
 int ogs_tcp_nodelay(ogs_socket_t fd, int on)
 {
 #if defined(TCP_NODELAY) && !defined(_WIN32)
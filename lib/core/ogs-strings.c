@@ -224,7 +224,7 @@ char *ogs_talloc_asprintf_append(char *s, const char *fmt, ...)
 
 
 /*****************************************
- * Memory Pool - Use pkbuf library
+ * Memory Pool - Use ogs_malloc_debug()
  *****************************************/
 
 char *ogs_strdup_debug(const char *s, const char *file_line)
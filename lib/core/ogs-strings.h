@@ -116,16 +116,12 @@ char *ogs_mstrcatf_debug(
  * Memory Pool - Use talloc library
  *****************************************/
 
-#define ogs_strdup(p) \
-    ogs_talloc_strdup(__ogs_talloc_core, p)
-#define ogs_strndup(p, n) \
-    ogs_talloc_strndup(__ogs_talloc_core, p, n)
-#define ogs_memdup(p, size) \
-    ogs_talloc_memdup(__ogs_talloc_core, p, size)
-#define ogs_msprintf(...) \
-    ogs_talloc_asprintf(__ogs_talloc_core, __VA_ARGS__)
-#define ogs_mstrcatf(s, ...) \
-    ogs_talloc_asprintf_append(s, __VA_ARGS__)
+#define ogs_strdup(s) ogs_strdup_debug(s, __location__)
+#define ogs_strndup(s, n) ogs_strndup_debug(s, n, __location__)
+#define ogs_memdup(m, n) ogs_memdup_debug(m, n, __location__)
+#define ogs_msprintf(...) ogs_msprintf_debug(__location__, __VA_ARGS__)
+#define ogs_mstrcatf(source, ...) \
+    ogs_mstrcatf_debug(source, __location__, __VA_ARGS__)
 
 #else
 
@@ -66,6 +66,10 @@ static void *thread_worker(void *arg)
     ogs_debug("[%p] worker signal", thread);
     thread->func(thread->data);
 
+    /* Hand the memory context over to the next new thread */
+    ogs_mem_thread_exit();
+    ogs_log_thread_exit();
+
     ogs_thread_mutex_lock(&thread->mutex);
     thread->running = false;
     ogs_thread_mutex_unlock(&thread->mutex);
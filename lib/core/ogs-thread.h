@@ -105,6 +105,12 @@ static ogs_inline int ogs_thread_cond_destroy(ogs_thread_cond_t *_ignored)
 }
 #endif
 
+#if defined(_MSC_VER)
+#define ogs_thread_local __declspec(thread)
+#else
+#define ogs_thread_local __thread
+#endif
+
 typedef struct ogs_thread_s ogs_thread_t;
 
 ogs_thread_t *ogs_thread_create(void (*func)(void *), void *data);
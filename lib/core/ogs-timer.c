@@ -22,11 +22,211 @@
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __ogs_event_domain
 
+/*
+ * Hierarchical Timing Wheel
+ *
+ * Four levels of 256 slots with a tick of 1 millisecond cover about
+ * 49 days; longer timers are parked in the last slot of the top level
+ * and cascaded again. Start and stop are a list insertion or removal.
+ * When the wheel turns, the timers of an upper slot are cascaded down
+ * and every timer of the current slot expires as one batch.
+ *
+ * A bitmap of the non-empty slots of each level lets the manager skip
+ * idle ticks and find the next deadline without walking the slots.
+ */
+#define OGS_TIMER_WHEEL_TICK        ogs_time_from_msec(1)
+#define OGS_TIMER_WHEEL_LEVEL       4
+#define OGS_TIMER_WHEEL_BITS        8
+#define OGS_TIMER_WHEEL_SIZE        (1 << OGS_TIMER_WHEEL_BITS)
+#define OGS_TIMER_WHEEL_MASK        (OGS_TIMER_WHEEL_SIZE - 1)
+#define OGS_TIMER_WHEEL_WORD        (OGS_TIMER_WHEEL_SIZE / 64)
+
+#define OGS_TIMER_WHEEL_EXPIRED     (-1)
+
+typedef struct ogs_timer_wheel_s {
+    ogs_time_t base;
+    uint64_t next_tick;
+
+    ogs_list_t slot[OGS_TIMER_WHEEL_LEVEL][OGS_TIMER_WHEEL_SIZE];
+    uint64_t bitmap[OGS_TIMER_WHEEL_LEVEL][OGS_TIMER_WHEEL_WORD];
+    int count[OGS_TIMER_WHEEL_LEVEL];
+
+    ogs_list_t expired;
+} ogs_timer_wheel_t;
+
 typedef struct ogs_timer_mgr_s {
     OGS_POOL(pool, ogs_timer_t);
     ogs_rbtree_t tree;
+
+    ogs_timer_wheel_t *wheel;
 } ogs_timer_mgr_t;
 
+static void wheel_link(ogs_timer_wheel_t *wheel, ogs_timer_t *timer)
+{
+    uint64_t tick, delta;
+    int level, index;
+
+    ogs_assert(wheel);
+    ogs_assert(timer);
+
+    tick = timer->tick;
+    if (tick < wheel->next_tick)
+        tick = wheel->next_tick;
+
+    delta = tick - wheel->next_tick;
+    for (level = 0; level < OGS_TIMER_WHEEL_LEVEL - 1; level++) {
+        if (delta < ((uint64_t)1 << (OGS_TIMER_WHEEL_BITS * (level + 1))))
+            break;
+    }
+    if (delta >= ((uint64_t)1 <<
+                (OGS_TIMER_WHEEL_BITS * OGS_TIMER_WHEEL_LEVEL)))
+        tick = wheel->next_tick + ((uint64_t)1 <<
+                (OGS_TIMER_WHEEL_BITS * OGS_TIMER_WHEEL_LEVEL)) - 1;
+
+    index = (tick >> (OGS_TIMER_WHEEL_BITS * level)) & OGS_TIMER_WHEEL_MASK;
+
+    ogs_list_add(&wheel->slot[level][index], &timer->lnode);
+    wheel->bitmap[level][index / 64] |= (uint64_t)1 << (index % 64);
+    wheel->count[level]++;
+
+    timer->slot = level * OGS_TIMER_WHEEL_SIZE + index;
+}
+
+static void wheel_unlink(ogs_timer_wheel_t *wheel, ogs_timer_t *timer)
+{
+    int level, index;
+
+    ogs_assert(wheel);
+    ogs_assert(timer);
+
+    if (timer->slot == OGS_TIMER_WHEEL_EXPIRED) {
+        ogs_list_remove(&wheel->expired, &timer->lnode);
+        return;
+    }
+
+    level = timer->slot / OGS_TIMER_WHEEL_SIZE;
+    index = timer->slot % OGS_TIMER_WHEEL_SIZE;
+
+    ogs_list_remove(&wheel->slot[level][index], &timer->lnode);
+    if (!ogs_list_first(&wheel->slot[level][index]))
+        wheel->bitmap[level][index / 64] &= ~((uint64_t)1 << (index % 64));
+    wheel->count[level]--;
+}
+
+/* Distance from 'start' to the first non-empty slot, or -1 if none */
+static int wheel_find(uint64_t *bitmap, int start)
+{
+    int i, word;
+    uint64_t bits;
+
+    for (i = 0; i <= OGS_TIMER_WHEEL_WORD; i++) {
+        word = (start / 64 + i) % OGS_TIMER_WHEEL_WORD;
+        bits = bitmap[word];
+
+        if (i == 0)
+            bits &= ~(uint64_t)0 << (start % 64);
+        else if (i == OGS_TIMER_WHEEL_WORD)
+            bits &= ((uint64_t)1 << (start % 64)) - 1;
+
+        if (bits)
+            return (word * 64 + __builtin_ctzll(bits) - start) &
+                OGS_TIMER_WHEEL_MASK;
+    }
+
+    return -1;
+}
+
+/*
+ * The first tick at which the wheel has something to do : a slot
+ * of the lowest level expires or a slot of an upper level is cascaded.
+ */
+static uint64_t wheel_next_tick(ogs_timer_wheel_t *wheel)
+{
+    uint64_t next = UINT64_MAX, tick;
+    int level, shift, distance;
+
+    ogs_assert(wheel);
+
+    for (level = 0; level < OGS_TIMER_WHEEL_LEVEL; level++) {
+        if (!wheel->count[level])
+            continue;
+
+        shift = OGS_TIMER_WHEEL_BITS * level;
+        tick = ((wheel->next_tick + ((uint64_t)1 << shift) - 1)
+                >> shift) << shift;
+
+        distance = wheel_find(wheel->bitmap[level],
+                (tick >> shift) & OGS_TIMER_WHEEL_MASK);
+        ogs_assert(distance >= 0);
+
+        tick += (uint64_t)distance << shift;
+        if (tick < next)
+            next = tick;
+    }
+
+    return next;
+}
+
+static void wheel_cascade(ogs_timer_wheel_t *wheel, int level, int index)
+{
+    OGS_LIST(list);
+    ogs_lnode_t *lnode = NULL;
+    ogs_timer_t *timer = NULL;
+
+    ogs_assert(wheel);
+
+    ogs_list_copy(&list, &wheel->slot[level][index]);
+    ogs_list_init(&wheel->slot[level][index]);
+    wheel->bitmap[level][index / 64] &= ~((uint64_t)1 << (index % 64));
+
+    while ((lnode = ogs_list_first(&list))) {
+        timer = ogs_container_of(lnode, ogs_timer_t, lnode);
+        ogs_list_remove(&list, lnode);
+        wheel->count[level]--;
+
+        if (level == 0) {
+            ogs_list_add(&wheel->expired, &timer->lnode);
+            timer->slot = OGS_TIMER_WHEEL_EXPIRED;
+        } else {
+            wheel_link(wheel, timer);
+        }
+    }
+}
+
+static void wheel_advance(ogs_timer_wheel_t *wheel, ogs_time_t current)
+{
+    uint64_t now, tick;
+    int level, index;
+
+    ogs_assert(wheel);
+
+    now = (current - wheel->base) / OGS_TIMER_WHEEL_TICK;
+
+    while (wheel->next_tick <= now) {
+        tick = wheel_next_tick(wheel);
+        if (tick > now) {
+            wheel->next_tick = now + 1;
+            break;
+        }
+
+        wheel->next_tick = tick;
+
+        if ((tick & OGS_TIMER_WHEEL_MASK) == 0) {
+            for (level = 1; level < OGS_TIMER_WHEEL_LEVEL; level++) {
+                index = (tick >> (OGS_TIMER_WHEEL_BITS * level)) &
+                    OGS_TIMER_WHEEL_MASK;
+                wheel_cascade(wheel, level, index);
+                if (index)
+                    break;
+            }
+        }
+
+        wheel_cascade(wheel, 0, tick & OGS_TIMER_WHEEL_MASK);
+
+        wheel->next_tick = tick + 1;
+    }
+}
+
 static void add_timer_node(
         ogs_rbtree_t *tree, ogs_timer_t *timer, ogs_time_t duration)
 {
@@ -65,10 +265,33 @@ ogs_timer_mgr_t *ogs_timer_mgr_create(unsigned int capacity)
     return manager;
 }
 
+ogs_timer_mgr_t *ogs_timer_mgr_create_wheel(unsigned int capacity)
+{
+    ogs_timer_mgr_t *manager = ogs_timer_mgr_create(capacity);
+    if (!manager) {
+        ogs_error("ogs_timer_mgr_create() failed");
+        return NULL;
+    }
+
+    manager->wheel = ogs_calloc(1, sizeof *manager->wheel);
+    if (!manager->wheel) {
+        ogs_error("ogs_calloc() failed");
+        ogs_timer_mgr_destroy(manager);
+        return NULL;
+    }
+
+    manager->wheel->base = ogs_get_monotonic_time();
+
+    return manager;
+}
+
 void ogs_timer_mgr_destroy(ogs_timer_mgr_t *manager)
 {
     ogs_assert(manager);
 
+    if (manager->wheel)
+        ogs_free(manager->wheel);
+
     ogs_pool_final(&manager->pool);
     ogs_free(manager);
 }
@@ -132,6 +355,20 @@ void ogs_timer_start_debug(
         ogs_assert_if_reached();
     }
 
+    if (manager->wheel) {
+        ogs_timer_wheel_t *wheel = manager->wheel;
+
+        if (timer->running == true)
+            wheel_unlink(wheel, timer);
+
+        timer->running = true;
+        timer->timeout = ogs_get_monotonic_time() + duration;
+        timer->tick = (timer->timeout - wheel->base +
+                OGS_TIMER_WHEEL_TICK - 1) / OGS_TIMER_WHEEL_TICK;
+        wheel_link(wheel, timer);
+        return;
+    }
+
     if (timer->running == true)
         ogs_rbtree_delete(&manager->tree, timer);
 
@@ -156,7 +393,11 @@ void ogs_timer_stop_debug(ogs_timer_t *timer, const char *file_line)
         return;
 
     timer->running = false;
-    ogs_rbtree_delete(&manager->tree, timer);
+
+    if (manager->wheel)
+        wheel_unlink(manager->wheel, timer);
+    else
+        ogs_rbtree_delete(&manager->tree, timer);
 }
 
 ogs_time_t ogs_timer_mgr_next(ogs_timer_mgr_t *manager)
@@ -166,6 +407,26 @@ ogs_time_t ogs_timer_mgr_next(ogs_timer_mgr_t *manager)
     ogs_assert(manager);
 
     current = ogs_get_monotonic_time();
+
+    if (manager->wheel) {
+        ogs_timer_wheel_t *wheel = manager->wheel;
+        uint64_t tick;
+        ogs_time_t timeout;
+
+        if (ogs_list_first(&wheel->expired))
+            return OGS_NO_WAIT_TIME;
+
+        tick = wheel_next_tick(wheel);
+        if (tick == UINT64_MAX)
+            return OGS_INFINITE_TIME;
+
+        timeout = wheel->base + (ogs_time_t)tick * OGS_TIMER_WHEEL_TICK;
+        if (timeout > current)
+            return (timeout - current);
+        else
+            return OGS_NO_WAIT_TIME;
+    }
+
     rbnode = ogs_rbtree_first(&manager->tree);
     if (rbnode) {
         ogs_timer_t *this = ogs_rb_entry(rbnode, ogs_timer_t, rbnode);
@@ -191,6 +452,25 @@ void ogs_timer_mgr_expire(ogs_timer_mgr_t *manager)
 
     current = ogs_get_monotonic_time();
 
+    if (manager->wheel) {
+        ogs_timer_wheel_t *wheel = manager->wheel;
+
+        wheel_advance(wheel, current);
+
+        /*
+         * A callback may stop or delete another timer of the same batch,
+         * which then simply leaves the expired list.
+         */
+        while ((lnode = ogs_list_first(&wheel->expired))) {
+            this = ogs_container_of(lnode, ogs_timer_t, lnode);
+            ogs_list_remove(&wheel->expired, lnode);
+            this->running = false;
+            if (this->cb)
+                this->cb(this->data);
+        }
+        return;
+    }
+
     ogs_rbtree_for_each(&manager->tree, rbnode) {
         this = ogs_rb_entry(rbnode, ogs_timer_t, rbnode);
 
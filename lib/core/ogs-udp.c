@@ -17,6 +17,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "core-config-private.h"
+
 #include "ogs-core.h"
 
 #undef OGS_LOG_DOMAIN
@@ -44,6 +46,13 @@ ogs_sock_t *ogs_udp_server(
             addr = addr->next;
             continue;
         }
+        if (option.so_reuseport) {
+            if (ogs_port_reusable(new->fd, true) != OGS_OK) {
+                ogs_sock_destroy(new);
+                addr = addr->next;
+                continue;
+            }
+        }
         if (ogs_sock_bind(new, addr) != OGS_OK) {
             ogs_sock_destroy(new);
             addr = addr->next;
@@ -143,3 +152,98 @@ int ogs_udp_connect(ogs_sock_t *sock, ogs_sockaddr_t *sa_list)
 
     return OGS_OK;
 }
+
+/*
+ * Receive up to 'num' datagrams with a single system call.
+ *
+ * Returns the number of datagrams received, or -1 on error.
+ * If recvmmsg() is not available, only one datagram is received.
+ */
+int ogs_recvmmsg(ogs_socket_t fd, ogs_sockmsg_t *msg, int num, int flags)
+{
+#if HAVE_RECVMMSG
+    struct mmsghdr hdr[OGS_MAX_NUM_OF_SOCKMSG];
+    struct iovec iov[OGS_MAX_NUM_OF_SOCKMSG];
+    int i, n;
+#else
+    ssize_t size;
+#endif
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(msg);
+    ogs_assert(num > 0 && num <= OGS_MAX_NUM_OF_SOCKMSG);
+
+#if HAVE_RECVMMSG
+    memset(hdr, 0, sizeof(hdr[0]) * num);
+    for (i = 0; i < num; i++) {
+        memset(&msg[i].addr, 0, sizeof(msg[i].addr));
+
+        iov[i].iov_base = msg[i].buf;
+        iov[i].iov_len = msg[i].len;
+
+        hdr[i].msg_hdr.msg_iov = &iov[i];
+        hdr[i].msg_hdr.msg_iovlen = 1;
+        hdr[i].msg_hdr.msg_name = &msg[i].addr.sa;
+        hdr[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+
+    n = recvmmsg(fd, hdr, num, flags, NULL);
+    for (i = 0; i < n; i++)
+        msg[i].len = hdr[i].msg_len;
+
+    return n;
+#else
+    size = ogs_recvfrom(fd, msg[0].buf, msg[0].len, flags, &msg[0].addr);
+    if (size < 0)
+        return -1;
+
+    msg[0].len = size;
+
+    return 1;
+#endif
+}
+
+/*
+ * Send up to 'num' datagrams with a single system call.
+ *
+ * Returns the number of datagrams sent, or -1 on error.
+ * A short count means that the socket would block on the remaining ones.
+ */
+int ogs_sendmmsg(ogs_socket_t fd, ogs_sockmsg_t *msg, int num, int flags)
+{
+#if HAVE_SENDMMSG
+    struct mmsghdr hdr[OGS_MAX_NUM_OF_SOCKMSG];
+    struct iovec iov[OGS_MAX_NUM_OF_SOCKMSG];
+#else
+    ssize_t sent;
+#endif
+    int i;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(msg);
+    ogs_assert(num > 0 && num <= OGS_MAX_NUM_OF_SOCKMSG);
+
+#if HAVE_SENDMMSG
+    memset(hdr, 0, sizeof(hdr[0]) * num);
+    for (i = 0; i < num; i++) {
+        iov[i].iov_base = msg[i].buf;
+        iov[i].iov_len = msg[i].len;
+
+        hdr[i].msg_hdr.msg_iov = &iov[i];
+        hdr[i].msg_hdr.msg_iovlen = 1;
+        hdr[i].msg_hdr.msg_name = &msg[i].addr.sa;
+        hdr[i].msg_hdr.msg_namelen = ogs_sockaddr_len(&msg[i].addr);
+        ogs_assert(hdr[i].msg_hdr.msg_namelen);
+    }
+
+    return sendmmsg(fd, hdr, num, flags);
+#else
+    for (i = 0; i < num; i++) {
+        sent = ogs_sendto(fd, msg[i].buf, msg[i].len, flags, &msg[i].addr);
+        if (sent < 0)
+            return i ? i : -1;
+    }
+
+    return num;
+#endif
+}
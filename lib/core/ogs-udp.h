@@ -28,12 +28,31 @@
 extern "C" {
 #endif
 
+/*
+ * Datagram vector used by ogs_recvmmsg()/ogs_sendmmsg()
+ *
+ * - buf/len : Buffer and its size.
+ *             On return of ogs_recvmmsg(), len is the received size.
+ * - addr    : Source address(recv) or destination address(send)
+ */
+#define OGS_MAX_NUM_OF_SOCKMSG 64
+
+typedef struct ogs_sockmsg_s {
+    void *buf;
+    size_t len;
+
+    ogs_sockaddr_t addr;
+} ogs_sockmsg_t;
+
 ogs_sock_t *ogs_udp_server(
         ogs_sockaddr_t *sa_list, ogs_sockopt_t *socket_option);
 ogs_sock_t *ogs_udp_client(
         ogs_sockaddr_t *sa_list, ogs_sockopt_t *socket_option);
 int ogs_udp_connect(ogs_sock_t *sock, ogs_sockaddr_t *sa_list);
 
+int ogs_recvmmsg(ogs_socket_t fd, ogs_sockmsg_t *msg, int num, int flags);
+int ogs_sendmmsg(ogs_socket_t fd, ogs_sockmsg_t *msg, int num, int flags);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,32 @@
 
 #include "ogs-gtp.h"
 
+/*
+ * GTP-U Transmit Burst
+ *
+ * Between ogs_gtp_burst_begin() and ogs_gtp_burst_end(),
+ * the outgoing G-PDU is queued instead of being sent immediately.
+ * The queue is flushed with one sendmmsg() per socket
+ * when it is full or when the burst ends.
+ *
+ * The queue is per thread, so that several data-plane threads
+ * can run their own bursts at the same time.
+ */
+static ogs_thread_local struct {
+    bool active;
+
+    int num;
+    struct {
+        ogs_socket_t fd;
+        ogs_pkbuf_t *pkbuf;
+        ogs_sockmsg_t msg;
+    } queue[OGS_MAX_NUM_OF_SOCKMSG];
+
+    ogs_gtp_burst_stat_t stat;
+} burst;
+
+static void burst_flush(void);
+
 ogs_sock_t *ogs_gtp_server(ogs_socknode_t *node)
 {
     char buf[OGS_ADDRSTRLEN];
@@ -129,6 +155,108 @@ int ogs_gtp_sendto(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf)
     return OGS_OK;
 }
 
+void ogs_gtp_burst_begin(void)
+{
+    ogs_assert(burst.active == false);
+    ogs_assert(burst.num == 0);
+
+    burst.active = true;
+    memset(&burst.stat, 0, sizeof(burst.stat));
+}
+
+void ogs_gtp_burst_end(ogs_gtp_burst_stat_t *stat)
+{
+    ogs_assert(burst.active == true);
+
+    burst_flush();
+    burst.active = false;
+
+    if (stat)
+        memcpy(stat, &burst.stat, sizeof(*stat));
+}
+
+bool ogs_gtp_burst_is_active(void)
+{
+    return burst.active;
+}
+
+int ogs_gtp_burst_sendto(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf)
+{
+    ogs_sock_t *sock = NULL;
+
+    ogs_assert(burst.active == true);
+    ogs_assert(gnode);
+    ogs_assert(pkbuf);
+    sock = gnode->sock;
+    ogs_assert(sock);
+
+    if (burst.num == OGS_MAX_NUM_OF_SOCKMSG)
+        burst_flush();
+
+    burst.queue[burst.num].fd = sock->fd;
+    burst.queue[burst.num].pkbuf = pkbuf;
+    burst.queue[burst.num].msg.buf = pkbuf->data;
+    burst.queue[burst.num].msg.len = pkbuf->len;
+    memcpy(&burst.queue[burst.num].msg.addr, &gnode->addr,
+            sizeof(burst.queue[burst.num].msg.addr));
+    burst.num++;
+
+    return OGS_OK;
+}
+
+static void burst_flush(void)
+{
+    ogs_sockmsg_t msg[OGS_MAX_NUM_OF_SOCKMSG];
+    bool flushed[OGS_MAX_NUM_OF_SOCKMSG];
+    ogs_socket_t fd;
+    int i, j, n, sent, rv;
+
+    memset(flushed, 0, sizeof(flushed));
+
+    for (i = 0; i < burst.num; i++) {
+        if (flushed[i] == true)
+            continue;
+
+        /* Gather all packets going out through the same socket */
+        fd = burst.queue[i].fd;
+        n = 0;
+        for (j = i; j < burst.num; j++) {
+            if (flushed[j] == true || burst.queue[j].fd != fd)
+                continue;
+
+            memcpy(&msg[n++], &burst.queue[j].msg, sizeof(msg[0]));
+            flushed[j] = true;
+        }
+
+        sent = 0;
+        while (sent < n) {
+            rv = ogs_sendmmsg(fd, &msg[sent], n - sent, 0);
+            burst.stat.syscalls++;
+            if (rv <= 0) {
+                int err = ogs_socket_errno;
+
+                /* The socket is full : the rest is dropped */
+                if (err == OGS_EAGAIN)
+                    break;
+
+                /* Only this message failed : go on with the next one */
+                ogs_log_message(OGS_LOG_ERROR, err,
+                        "ogs_sendmmsg(%d, %d) failed", fd, n - sent);
+                burst.stat.errors++;
+                sent++;
+                continue;
+            }
+            burst.stat.pkts += rv;
+            sent += rv;
+        }
+    }
+
+    for (i = 0; i < burst.num; i++)
+        ogs_pkbuf_free(burst.queue[i].pkbuf);
+
+    burst.num = 0;
+}
+
 void ogs_gtp_send_error_message(
         ogs_gtp_xact_t *xact, uint32_t teid, uint8_t type, uint8_t cause_value)
 {
@@ -72,6 +72,17 @@ int ogs_gtp_connect(ogs_sock_t *ipv4, ogs_sock_t *ipv6, ogs_gtp_node_t *gnode);
 int ogs_gtp_send(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf);
 int ogs_gtp_sendto(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf);
 
+typedef struct ogs_gtp_burst_stat_s {
+    int pkts;       /* Number of packets flushed */
+    int syscalls;   /* Number of sendmmsg() calls */
+    int errors;     /* Number of packets failed and skipped */
+} ogs_gtp_burst_stat_t;
+
+void ogs_gtp_burst_begin(void);
+void ogs_gtp_burst_end(ogs_gtp_burst_stat_t *stat);
+bool ogs_gtp_burst_is_active(void);
+int ogs_gtp_burst_sendto(ogs_gtp_node_t *gnode, ogs_pkbuf_t *pkbuf);
+
 void ogs_gtp_send_error_message(
         ogs_gtp_xact_t *xact, uint32_t teid, uint8_t type, uint8_t cause_value);
 
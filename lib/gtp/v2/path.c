@@ -32,6 +32,10 @@ int ogs_gtp2_send_user_plane(
     ogs_trace("SEND GTP-U[%d] to Peer[%s] : TEID[0x%x]",
             gtp_hdesc->type, OGS_ADDR(&gnode->addr, buf), gtp_hdesc->teid);
 
+    /* In burst mode, the packet is freed when the burst is flushed */
+    if (ogs_gtp_burst_is_active() == true)
+        return ogs_gtp_burst_sendto(gnode, pkbuf);
+
     rv = ogs_gtp_sendto(gnode, pkbuf);
     if (rv != OGS_OK) {
         if (ogs_socket_errno != OGS_EAGAIN) {
@@ -26,6 +26,36 @@
 
 #define MAX_LABELS 8
 
+/*
+ * Counters
+ *
+ * Each thread increments counters in its own block, indexed by
+ * the counter ID of the instance, so that the data plane never takes
+ * a lock or hashes label values. The blocks are folded into
+ * the Prometheus registry only when /metrics is scraped.
+ */
+#define MAX_NUM_OF_COUNTER 4096
+#define MAX_NUM_OF_COUNTER_BLOCK 128
+#define COUNTER_BLOCK_PADDING 64 /* Cache line */
+
+typedef struct counter_block_s {
+    uint8_t head[COUNTER_BLOCK_PADDING];
+    uint64_t value[MAX_NUM_OF_COUNTER];
+    uint8_t tail[COUNTER_BLOCK_PADDING];
+} counter_block_t;
+
+static struct {
+    ogs_thread_mutex_t mutex;
+
+    OGS_POOL(id_pool, ogs_pool_id_t);
+
+    counter_block_t *block[MAX_NUM_OF_COUNTER_BLOCK];
+    int num_of_block;
+} counter;
+
+static ogs_thread_local counter_block_t *self_block;
+static ogs_thread_local bool self_block_failed;
+
 typedef struct ogs_metrics_server_s {
     ogs_socknode_t node;
     struct MHD_Daemon *mhd;
@@ -49,6 +79,9 @@ typedef struct ogs_metrics_inst_s {
     ogs_list_t              entry; /* included in ogs_metrics_spec_t spec */
     unsigned int            num_labels;
     char                    *label_values[MAX_LABELS];
+
+    ogs_pool_id_t           *counter_id_node; /* NULL : no counter slot */
+    uint64_t                counter_exported; /* Already in the registry */
 } ogs_metrics_inst_t;
 
 static OGS_POOL(metrics_spec_pool, ogs_metrics_spec_t);
@@ -57,6 +90,8 @@ static OGS_POOL(metrics_server_pool, ogs_metrics_server_t);
 static int ogs_metrics_context_server_start(ogs_metrics_server_t *server);
 static int ogs_metrics_context_server_stop(ogs_metrics_server_t *server);
 
+static void counter_collect_all(void);
+
 void ogs_metrics_server_init(ogs_metrics_context_t *ctx)
 {
     ogs_list_init(&ctx->server_list);
@@ -207,6 +242,7 @@ static _MHD_Result mhd_server_access_handler(void *cls, struct MHD_Connection *c
         return ret;
     }
     if (strcmp(url, "/metrics") == 0) {
+        counter_collect_all();
         buf = prom_collector_registry_bridge(PROM_COLLECTOR_REGISTRY_DEFAULT);
         rsp = MHD_create_response_from_buffer(strlen(buf), (void *)buf, MHD_RESPMEM_MUST_FREE);
         ret = MHD_queue_response(connection, MHD_HTTP_OK, rsp);
@@ -316,23 +352,121 @@ static int ogs_metrics_context_server_stop(ogs_metrics_server_t *server)
     return OGS_OK;
 }
 
+static counter_block_t *counter_block_add(void)
+{
+    counter_block_t *block = NULL;
+
+    ogs_thread_mutex_lock(&counter.mutex);
+
+    if (counter.num_of_block < MAX_NUM_OF_COUNTER_BLOCK) {
+        block = ogs_calloc(1, sizeof(*block));
+        ogs_assert(block);
+        counter.block[counter.num_of_block++] = block;
+    } else {
+        ogs_warn("No counter block for this thread [%d]",
+                MAX_NUM_OF_COUNTER_BLOCK);
+    }
+
+    ogs_thread_mutex_unlock(&counter.mutex);
+
+    return block;
+}
+
+static bool counter_add(ogs_metrics_inst_t *inst, int val)
+{
+    counter_block_t *block = self_block;
+    uint64_t *value = NULL;
+
+    ogs_assert(inst);
+    ogs_assert(inst->counter_id_node);
+
+    if (!block) {
+        if (self_block_failed)
+            return false;
+
+        block = self_block = counter_block_add();
+        if (!block) {
+            self_block_failed = true;
+            return false;
+        }
+    }
+
+    /* Only this thread writes the value */
+    value = &block->value[*inst->counter_id_node - 1];
+    ogs_atomic_store(value, *value + val);
+
+    return true;
+}
+
+/* counter.mutex must be held */
+static void counter_collect(ogs_metrics_inst_t *inst)
+{
+    uint64_t sum = 0;
+    int i, index;
+
+    ogs_assert(inst);
+    ogs_assert(inst->counter_id_node);
+
+    index = *inst->counter_id_node - 1;
+    for (i = 0; i < counter.num_of_block; i++)
+        sum += ogs_atomic_load(&counter.block[i]->value[index]);
+
+    if (sum > inst->counter_exported) {
+        prom_counter_add(inst->spec->prom,
+                (double)(sum - inst->counter_exported),
+                (const char **)inst->label_values);
+        inst->counter_exported = sum;
+    }
+}
+
+static void counter_collect_all(void)
+{
+    ogs_metrics_spec_t *spec = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+
+    ogs_thread_mutex_lock(&counter.mutex);
+
+    ogs_list_for_each_entry(&ogs_metrics_self()->spec_list, spec, entry) {
+        ogs_list_for_each_entry(&spec->inst_list, inst, entry) {
+            if (inst->counter_id_node)
+                counter_collect(inst);
+        }
+    }
+
+    ogs_thread_mutex_unlock(&counter.mutex);
+}
+
 void ogs_metrics_spec_init(ogs_metrics_context_t *ctx)
 {
     ogs_list_init(&ctx->spec_list);
     ogs_pool_init(&metrics_spec_pool, ogs_app()->metrics.max_specs);
 
+    ogs_thread_mutex_init(&counter.mutex);
+    ogs_pool_create(&counter.id_pool, MAX_NUM_OF_COUNTER);
+    ogs_pool_sequence_id_generate(&counter.id_pool);
+
     prom_collector_registry_default_init();
 }
 
 void ogs_metrics_spec_final(ogs_metrics_context_t *ctx)
 {
     ogs_metrics_spec_t *spec = NULL, *next = NULL;
+    int i;
 
     ogs_list_for_each_entry_safe(&ctx->spec_list, next, spec, entry) {
         ogs_metrics_spec_free(spec);
     }
     prom_collector_registry_destroy(PROM_COLLECTOR_REGISTRY_DEFAULT);
 
+    for (i = 0; i < counter.num_of_block; i++)
+        ogs_free(counter.block[i]);
+    counter.num_of_block = 0;
+    self_block = NULL;
+    self_block_failed = false;
+
+    ogs_pool_destroy(&counter.id_pool);
+    ogs_thread_mutex_destroy(&counter.mutex);
+
     ogs_pool_final(&metrics_spec_pool);
 }
 
@@ -462,7 +596,13 @@ ogs_metrics_inst_t *ogs_metrics_inst_new(
         ogs_assert(label_values[i]);
         inst->label_values[i] = ogs_strdup(label_values[i]);
     }
+
+    ogs_thread_mutex_lock(&counter.mutex);
+    if (spec->type == OGS_METRICS_METRIC_TYPE_COUNTER)
+        ogs_pool_alloc(&counter.id_pool, &inst->counter_id_node);
     ogs_list_add(&spec->inst_list, &inst->entry);
+    ogs_thread_mutex_unlock(&counter.mutex);
+
     ogs_metrics_inst_reset(inst);
     return inst;
 }
@@ -471,7 +611,20 @@ void ogs_metrics_inst_free(ogs_metrics_inst_t *inst)
 {
     unsigned int i;
 
+    ogs_thread_mutex_lock(&counter.mutex);
+    if (inst->counter_id_node) {
+        int j;
+
+        /* Flush what has not been scraped yet and clear the slot */
+        counter_collect(inst);
+        for (j = 0; j < counter.num_of_block; j++)
+            ogs_atomic_store(&counter.block[j]->
+                    value[*inst->counter_id_node - 1], 0);
+
+        ogs_pool_free(&counter.id_pool, inst->counter_id_node);
+    }
     ogs_list_remove(&inst->spec->inst_list, &inst->entry);
+    ogs_thread_mutex_unlock(&counter.mutex);
 
     for (i = 0; i < inst->num_labels; i++)
         ogs_free(inst->label_values[i]);
@@ -511,6 +664,8 @@ void ogs_metrics_inst_add(ogs_metrics_inst_t *inst, int val)
     switch (inst->spec->type) {
     case OGS_METRICS_METRIC_TYPE_COUNTER:
         ogs_assert(val >= 0);
+        if (inst->counter_id_node && counter_add(inst, val) == true)
+            break;
         prom_counter_add(inst->spec->prom, (double)val, (const char **)inst->label_values);
         break;
     case OGS_METRICS_METRIC_TYPE_GAUGE:
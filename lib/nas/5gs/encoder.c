@@ -3561,7 +3561,8 @@ ogs_pkbuf_t *ogs_nas_5gmm_encode(ogs_nas_5gs_message_t *message)
     ogs_assert(message);
 
     /* The Packet Buffer(ogs_pkbuf_t) for NAS message MUST make a HEADROOM. 
-     * When calculating AES_CMAC, we need to use the headroom of the packet. */
+     * When calculating AES_CMAC, we need to use the headroom of the packet.
+     * The headroom is kept by ogs_pkbuf_fit() below. */
     pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
     if (!pkbuf) {
         ogs_error("ogs_pkbuf_alloc() failed");
@@ -3719,6 +3720,10 @@ ogs_pkbuf_t *ogs_nas_5gmm_encode(ogs_nas_5gs_message_t *message)
 
     pkbuf->len = encoded;
 
+    /* Encoding is done in a scratch buffer of OGS_MAX_SDU_LEN.
+     * Hand out a buffer of the right size instead. */
+    pkbuf = ogs_pkbuf_fit(pkbuf, OGS_NAS_HEADROOM, OGS_NAS_TAILROOM);
+
     return pkbuf;
 }
 
@@ -3731,7 +3736,8 @@ ogs_pkbuf_t *ogs_nas_5gsm_encode(ogs_nas_5gs_message_t *message)
     ogs_assert(message);
 
     /* The Packet Buffer(ogs_pkbuf_t) for NAS message MUST make a HEADROOM. 
-     * When calculating AES_CMAC, we need to use the headroom of the packet. */
+     * When calculating AES_CMAC, we need to use the headroom of the packet.
+     * The headroom is kept by ogs_pkbuf_fit() below. */
     pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
     if (!pkbuf) {
         ogs_error("ogs_pkbuf_alloc() failed");
@@ -3836,6 +3842,10 @@ ogs_pkbuf_t *ogs_nas_5gsm_encode(ogs_nas_5gs_message_t *message)
     ogs_assert(ogs_pkbuf_push(pkbuf, encoded));
     pkbuf->len = encoded;
 
+    /* Encoding is done in a scratch buffer of OGS_MAX_SDU_LEN.
+     * Hand out a buffer of the right size instead. */
+    pkbuf = ogs_pkbuf_fit(pkbuf, OGS_NAS_HEADROOM, OGS_NAS_TAILROOM);
+
     return pkbuf;
 }
 
@@ -34,6 +34,10 @@ extern "C" {
  * When calculating AES_CMAC, we need to use the headroom of the packet. */
 #define OGS_NAS_HEADROOM 16
 
+/* SNOW 3G (EEA1/NEA1) ciphers in 32-bit words and may touch
+ * up to 3 bytes past the end of the message. */
+#define OGS_NAS_TAILROOM 4
+
 #define OGS_NAS_SECURITY_HEADER_PLAIN_NAS_MESSAGE 0
 #define OGS_NAS_SECURITY_HEADER_INTEGRITY_PROTECTED 1
 #define OGS_NAS_SECURITY_HEADER_INTEGRITY_PROTECTED_AND_CIPHERED 2
@@ -912,7 +912,8 @@ f.write("""ogs_pkbuf_t *ogs_nas_emm_encode(ogs_nas_eps_message_t *message)
     ogs_assert(message);
 
     /* The Packet Buffer(ogs_pkbuf_t) for NAS message MUST make a HEADROOM. 
-     * When calculating AES_CMAC, we need to use the headroom of the packet. */
+     * When calculating AES_CMAC, we need to use the headroom of the packet.
+     * The headroom is kept by ogs_pkbuf_fit() below. */
     pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
     if (!pkbuf) {
         ogs_error("ogs_pkbuf_alloc() failed");
@@ -964,6 +965,10 @@ out:
 
     pkbuf->len = encoded;
 
+    /* Encoding is done in a scratch buffer of OGS_MAX_SDU_LEN.
+     * Hand out a buffer of the right size instead. */
+    pkbuf = ogs_pkbuf_fit(pkbuf, OGS_NAS_HEADROOM, OGS_NAS_TAILROOM);
+
     return pkbuf;
 }
 
@@ -978,7 +983,8 @@ f.write("""ogs_pkbuf_t *ogs_nas_esm_encode(ogs_nas_eps_message_t *message)
     ogs_assert(message);
 
     /* The Packet Buffer(ogs_pkbuf_t) for NAS message MUST make a HEADROOM. 
-     * When calculating AES_CMAC, we need to use the headroom of the packet. */
+     * When calculating AES_CMAC, we need to use the headroom of the packet.
+     * The headroom is kept by ogs_pkbuf_fit() below. */
     pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
     if (!pkbuf) {
         ogs_error("ogs_pkbuf_alloc() failed");
@@ -1016,6 +1022,10 @@ f.write("""   default:
     ogs_assert(ogs_pkbuf_push(pkbuf, encoded));
     pkbuf->len = encoded;
 
+    /* Encoding is done in a scratch buffer of OGS_MAX_SDU_LEN.
+     * Hand out a buffer of the right size instead. */
+    pkbuf = ogs_pkbuf_fit(pkbuf, OGS_NAS_HEADROOM, OGS_NAS_TAILROOM);
+
     return pkbuf;
 }
 
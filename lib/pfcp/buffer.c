@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+
+/*
+ * Downlink Buffering
+ *
+ * A FAR has a ring of packets only while it is buffering. The ring
+ * grows up to the Suggested Buffering Packets Count of the BAR, or to
+ * the configured number of packets without it. A full ring gives up
+ * its oldest packet.
+ *
+ * All rings share a budget of octets. Once it is exceeded, packets are
+ * evicted oldest first from the FAR that has been buffering the longest.
+ * A FAR keeps its Downlink Data Report until it is flushed or cleared,
+ * even if all its packets have been evicted in the meantime.
+ *
+ * Buffering only happens while the UE is idle, so a single mutex is
+ * enough even though the FARs belong to different data-plane workers.
+ */
+#define BUFFER_MIN_SIZE 8
+
+#define PKBUF_OCTETS(__pkbuf) ((size_t)((__pkbuf)->end - (__pkbuf)->head))
+
+struct ogs_pfcp_buffer_s {
+    ogs_lnode_t lnode;
+
+    ogs_pfcp_far_t *far;
+
+    ogs_pkbuf_t **ring;
+    int size;
+    int head;
+    int count;
+};
+
+static struct {
+    ogs_thread_mutex_t mutex;
+
+    ogs_list_t list;            /* Buffering FARs, the oldest first */
+    size_t octets;
+} buffering;
+
+static ogs_thread_local ogs_pfcp_buffer_stat_t local_stat;
+
+static ogs_pkbuf_t *ring_pop(ogs_pfcp_buffer_t *buffer);
+static void buffer_free(ogs_pfcp_buffer_t *buffer);
+
+void ogs_pfcp_buffer_init(void)
+{
+    ogs_thread_mutex_init(&buffering.mutex);
+
+    ogs_list_init(&buffering.list);
+    buffering.octets = 0;
+}
+
+void ogs_pfcp_buffer_final(void)
+{
+    ogs_pfcp_buffer_t *buffer = NULL, *next_buffer = NULL;
+
+    ogs_list_for_each_safe(&buffering.list, next_buffer, buffer) {
+        while (buffer->count)
+            ogs_pkbuf_free(ring_pop(buffer));
+        buffer_free(buffer);
+    }
+
+    ogs_thread_mutex_destroy(&buffering.mutex);
+}
+
+static ogs_pkbuf_t *ring_pop(ogs_pfcp_buffer_t *buffer)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_assert(buffer);
+    ogs_assert(buffer->count);
+
+    pkbuf = buffer->ring[buffer->head];
+    ogs_assert(pkbuf);
+
+    buffer->ring[buffer->head] = NULL;
+    buffer->head = (buffer->head + 1) % buffer->size;
+    buffer->count--;
+
+    buffering.octets -= PKBUF_OCTETS(pkbuf);
+
+    return pkbuf;
+}
+
+static bool ring_grow(ogs_pfcp_buffer_t *buffer, int limit)
+{
+    ogs_pkbuf_t **ring = NULL;
+    int i, size;
+
+    ogs_assert(buffer);
+
+    size = ogs_min(ogs_max(buffer->size * 2, BUFFER_MIN_SIZE), limit);
+    if (size <= buffer->size)
+        return false;
+
+    ring = ogs_calloc(size, sizeof(*ring));
+    if (!ring) {
+        ogs_error("ogs_calloc() failed");
+        return false;
+    }
+
+    for (i = 0; i < buffer->count; i++)
+        ring[i] = buffer->ring[(buffer->head + i) % buffer->size];
+
+    if (buffer->ring)
+        ogs_free(buffer->ring);
+
+    buffer->ring = ring;
+    buffer->size = size;
+    buffer->head = 0;
+
+    return true;
+}
+
+static void buffer_free(ogs_pfcp_buffer_t *buffer)
+{
+    ogs_assert(buffer);
+    ogs_assert(buffer->count == 0);
+
+    ogs_list_remove(&buffering.list, buffer);
+
+    ogs_assert(buffer->far);
+    buffer->far->buffer = NULL;
+
+    if (buffer->ring)
+        ogs_free(buffer->ring);
+    ogs_free(buffer);
+}
+
+static int buffer_limit(ogs_pfcp_far_t *far)
+{
+    ogs_pfcp_bar_t *bar = NULL;
+
+    ogs_assert(far);
+
+    if (far->sess)
+        bar = far->sess->bar;
+
+    if (bar && bar->suggested_buffering_packets_count)
+        return bar->suggested_buffering_packets_count;
+
+    return ogs_pfcp_self()->buffer.packets;
+}
+
+bool ogs_pfcp_buffer_push(ogs_pfcp_far_t *far, ogs_pkbuf_t *pkbuf)
+{
+    ogs_pfcp_buffer_t *buffer = NULL, *oldest = NULL;
+    size_t octets, budget;
+    int limit;
+    bool first;
+
+    ogs_assert(far);
+    ogs_assert(pkbuf);
+
+    octets = PKBUF_OCTETS(pkbuf);
+    budget = (size_t)ogs_pfcp_self()->buffer.budget;
+    limit = buffer_limit(far);
+
+    ogs_thread_mutex_lock(&buffering.mutex);
+
+    buffer = far->buffer;
+
+    first = !far->buffer_reported;
+    far->buffer_reported = true;
+
+    if (octets > budget || limit <= 0)
+        goto drop;
+
+    if (!buffer) {
+        buffer = ogs_calloc(1, sizeof(*buffer));
+        if (!buffer) {
+            ogs_error("ogs_calloc() failed");
+            goto drop;
+        }
+        buffer->far = far;
+        far->buffer = buffer;
+
+        ogs_list_add(&buffering.list, buffer);
+    }
+
+    /* The ring of this FAR is full : give up its oldest packet */
+    while (buffer->count >= limit) {
+        ogs_pkbuf_free(ring_pop(buffer));
+        local_stat.dropped++;
+    }
+
+    if (buffer->count == buffer->size && !ring_grow(buffer, limit)) {
+        if (!buffer->count)
+            buffer_free(buffer);
+        goto drop;
+    }
+
+    /* Make room within the budget, the longest buffering FAR first */
+    while (buffering.octets + octets > budget) {
+        oldest = ogs_list_first(&buffering.list);
+        ogs_assert(oldest);
+
+        if (!oldest->count) {
+            /* Only this FAR is left and it has nothing to give up */
+            ogs_assert(oldest == buffer);
+            ogs_assert(ogs_list_next(oldest) == NULL);
+            buffer_free(buffer);
+            goto drop;
+        }
+
+        ogs_pkbuf_free(ring_pop(oldest));
+        local_stat.dropped++;
+
+        if (!oldest->count) {
+            if (oldest != buffer) {
+                buffer_free(oldest);
+            } else {
+                /* Starts buffering again as the newest FAR */
+                ogs_list_remove(&buffering.list, buffer);
+                ogs_list_add(&buffering.list, buffer);
+            }
+        }
+    }
+
+    buffer->ring[(buffer->head + buffer->count) % buffer->size] = pkbuf;
+    buffer->count++;
+
+    buffering.octets += octets;
+    local_stat.buffered++;
+
+    ogs_thread_mutex_unlock(&buffering.mutex);
+
+    return first;
+
+drop:
+    ogs_thread_mutex_unlock(&buffering.mutex);
+
+    ogs_pkbuf_free(pkbuf);
+    local_stat.dropped++;
+
+    return first;
+}
+
+ogs_pkbuf_t *ogs_pfcp_buffer_pop(ogs_pfcp_far_t *far)
+{
+    ogs_pfcp_buffer_t *buffer = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    ogs_assert(far);
+
+    ogs_thread_mutex_lock(&buffering.mutex);
+
+    buffer = far->buffer;
+    if (buffer) {
+        pkbuf = ring_pop(buffer);
+        if (!buffer->count)
+            buffer_free(buffer);
+
+        local_stat.flushed++;
+    } else {
+        /* Flushed : the next packet to buffer is reported again */
+        far->buffer_reported = false;
+    }
+
+    ogs_thread_mutex_unlock(&buffering.mutex);
+
+    return pkbuf;
+}
+
+void ogs_pfcp_buffer_clear(ogs_pfcp_far_t *far)
+{
+    ogs_pfcp_buffer_t *buffer = NULL;
+
+    ogs_assert(far);
+
+    ogs_thread_mutex_lock(&buffering.mutex);
+
+    buffer = far->buffer;
+    if (buffer) {
+        while (buffer->count) {
+            ogs_pkbuf_free(ring_pop(buffer));
+            local_stat.dropped++;
+        }
+        buffer_free(buffer);
+    }
+    far->buffer_reported = false;
+
+    ogs_thread_mutex_unlock(&buffering.mutex);
+}
+
+void ogs_pfcp_buffer_stat(ogs_pfcp_buffer_stat_t *stat)
+{
+    ogs_assert(stat);
+
+    memcpy(stat, &local_stat, sizeof(*stat));
+    memset(&local_stat, 0, sizeof(local_stat));
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_PFCP_INSIDE) && !defined(OGS_PFCP_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_PFCP_BUFFER_H
+#define OGS_PFCP_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OGS_PFCP_DEFAULT_BUFFER_BUDGET (64*1024*1024)
+#define OGS_PFCP_MAX_BUFFER_PACKETS 4096
+
+/* Packets counted on the calling thread, see ogs_pfcp_buffer_stat() */
+typedef struct ogs_pfcp_buffer_stat_s {
+    int buffered;
+    int dropped;
+    int flushed;
+} ogs_pfcp_buffer_stat_t;
+
+void ogs_pfcp_buffer_init(void);
+void ogs_pfcp_buffer_final(void);
+
+/* Returns true if the FAR has not reported buffering yet */
+bool ogs_pfcp_buffer_push(ogs_pfcp_far_t *far, ogs_pkbuf_t *pkbuf);
+/* Returns NULL once the FAR is flushed, which re-arms the report */
+ogs_pkbuf_t *ogs_pfcp_buffer_pop(ogs_pfcp_far_t *far);
+void ogs_pfcp_buffer_clear(ogs_pfcp_far_t *far);
+
+/* Takes the counters of the calling thread and resets them */
+void ogs_pfcp_buffer_stat(ogs_pfcp_buffer_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_PFCP_BUFFER_H */
@@ -36,6 +36,32 @@ static OGS_POOL(ogs_pfcp_pdr_pool, ogs_pfcp_pdr_t);
 static OGS_POOL(ogs_pfcp_pdr_teid_pool, ogs_pool_id_t);
 static ogs_pool_id_t *pdr_random_to_index;
 
+/*
+ * TEID Table
+ *
+ * A TEID chosen by this UP function (CH=1) is GENERATION | INDEX,
+ * where INDEX is the id taken from ogs_pfcp_pdr_teid_pool. Looking it up
+ * is then a bounds check and an array load. GENERATION changes each time
+ * the id is taken again, so a stale TEID does not reach the new owner.
+ *
+ * The bits above TEID_GENERATION_LIMIT are kept for the TEID range
+ * (TEIDRI up to 7). TEIDs allocated by the CP function (CH=0) are
+ * still kept in object_teid_hash.
+ */
+#define TEID_GENERATION_LIMIT 25
+
+typedef struct teid_slot_s {
+    uint32_t generation;
+    uint32_t teid;
+    ogs_pfcp_object_t *object;
+} teid_slot_t;
+
+static struct {
+    teid_slot_t *slot;
+    int index_bits;
+    uint32_t generation_mask;
+} teid_table;
+
 static OGS_POOL(ogs_pfcp_rule_pool, ogs_pfcp_rule_t);
 
 static OGS_POOL(ogs_pfcp_dev_pool, ogs_pfcp_dev_t);
@@ -71,12 +97,23 @@ void ogs_pfcp_context_init(void)
     ogs_pool_init(&ogs_pfcp_pdr_teid_pool, ogs_pfcp_pdr_pool.size);
     ogs_pool_random_id_generate(&ogs_pfcp_pdr_teid_pool);
 
+    /* The ids of ogs_pfcp_pdr_teid_pool start from 1 */
     pdr_random_to_index = ogs_calloc(
-            sizeof(ogs_pool_id_t), ogs_pfcp_pdr_pool.size);
+            sizeof(ogs_pool_id_t), ogs_pfcp_pdr_pool.size + 1);
     ogs_assert(pdr_random_to_index);
     for (i = 0; i < ogs_pfcp_pdr_pool.size; i++)
         pdr_random_to_index[ogs_pfcp_pdr_teid_pool.array[i]] = i;
 
+    teid_table.slot = ogs_calloc(
+            sizeof(teid_slot_t), ogs_pfcp_pdr_pool.size + 1);
+    ogs_assert(teid_table.slot);
+    for (teid_table.index_bits = 1;
+            (1 << teid_table.index_bits) <= ogs_pfcp_pdr_pool.size;
+            teid_table.index_bits++);
+    ogs_assert(teid_table.index_bits <= TEID_GENERATION_LIMIT);
+    teid_table.generation_mask =
+        (1 << (TEID_GENERATION_LIMIT - teid_table.index_bits)) - 1;
+
     ogs_pool_init(&ogs_pfcp_rule_pool,
             ogs_app()->pool.sess *
             OGS_MAX_NUM_OF_PDR * OGS_MAX_NUM_OF_FLOW_IN_PDR);
@@ -91,6 +128,8 @@ void ogs_pfcp_context_init(void)
     self.far_teid_hash = ogs_hash_make();
     ogs_assert(self.far_teid_hash);
 
+    ogs_pfcp_buffer_init();
+
     context_initialized = 1;
 }
 
@@ -98,6 +137,8 @@ void ogs_pfcp_context_final(void)
 {
     ogs_assert(context_initialized == 1);
 
+    ogs_pfcp_buffer_final();
+
     ogs_assert(self.object_teid_hash);
     ogs_hash_destroy(self.object_teid_hash);
     ogs_assert(self.far_f_teid_hash);
@@ -115,6 +156,7 @@ void ogs_pfcp_context_final(void)
     ogs_pool_final(&ogs_pfcp_pdr_pool);
     ogs_pool_final(&ogs_pfcp_pdr_teid_pool);
     ogs_free(pdr_random_to_index);
+    ogs_free(teid_table.slot);
 
     ogs_pool_final(&ogs_pfcp_sess_pool);
     ogs_pool_final(&ogs_pfcp_far_pool);
@@ -140,6 +182,9 @@ static int ogs_pfcp_context_prepare(void)
 
     self.tun_ifname = "ogstun";
 
+    self.buffer.budget = OGS_PFCP_DEFAULT_BUFFER_BUDGET;
+    self.buffer.packets = OGS_MAX_NUM_OF_PACKET_BUFFER;
+
     return OGS_OK;
 }
 
@@ -150,6 +195,18 @@ static int ogs_pfcp_context_validation(const char *local)
         ogs_error("No %s.pfcp: in '%s'", local, ogs_app()->file);
         return OGS_ERROR;
     }
+    if (self.buffer.budget < 1) {
+        ogs_error("Invalid %s.buffer.budget [%lld] in '%s'",
+                local, (long long)self.buffer.budget, ogs_app()->file);
+        return OGS_ERROR;
+    }
+    if (self.buffer.packets < 1 ||
+        self.buffer.packets > OGS_PFCP_MAX_BUFFER_PACKETS) {
+        ogs_error("Invalid %s.buffer.packets [%d] in '%s' (1..%d)",
+                local, self.buffer.packets, ogs_app()->file,
+                OGS_PFCP_MAX_BUFFER_PACKETS);
+        return OGS_ERROR;
+    }
     return OGS_OK;
 }
 
@@ -445,6 +502,22 @@ int ogs_pfcp_context_parse_config(const char *local, const char *remote)
 
                     } while (ogs_yaml_iter_type(&subnet_array) ==
                             YAML_SEQUENCE_NODE);
+                } else if (!strcmp(local_key, "buffer")) {
+                    ogs_yaml_iter_t buffer_iter;
+                    ogs_yaml_iter_recurse(&local_iter, &buffer_iter);
+                    while (ogs_yaml_iter_next(&buffer_iter)) {
+                        const char *buffer_key =
+                            ogs_yaml_iter_key(&buffer_iter);
+                        ogs_assert(buffer_key);
+                        if (!strcmp(buffer_key, "budget")) {
+                            const char *v = ogs_yaml_iter_value(&buffer_iter);
+                            if (v) self.buffer.budget = atoll(v);
+                        } else if (!strcmp(buffer_key, "packets")) {
+                            const char *v = ogs_yaml_iter_value(&buffer_iter);
+                            if (v) self.buffer.packets = atoi(v);
+                        } else
+                            ogs_warn("unknown key `%s`", buffer_key);
+                    }
                 }
             }
         } else if (!strcmp(root_key, remote)) {
@@ -906,6 +979,73 @@ static int precedence_compare(ogs_pfcp_pdr_t *pdr1, ogs_pfcp_pdr_t *pdr2)
         return 1;
 }
 
+static void teid_generation_next(teid_slot_t *slot)
+{
+    ogs_assert(slot);
+
+    if (!teid_table.generation_mask)
+        return;
+
+    slot->generation = (slot->generation + 1) & teid_table.generation_mask;
+    if (!slot->generation)
+        slot->generation = 1;
+}
+
+static uint32_t teid_index(uint32_t teid)
+{
+    return teid & ((1 << teid_table.index_bits) - 1);
+}
+
+static teid_slot_t *teid_slot(uint32_t teid)
+{
+    uint32_t index = teid_index(teid);
+
+    if (index == 0 || index > ogs_pfcp_pdr_teid_pool.size)
+        return NULL;
+
+    return &teid_table.slot[index];
+}
+
+/* TEID chosen by this UP function for the PDR */
+static uint32_t teid_choose(ogs_pfcp_pdr_t *pdr)
+{
+    ogs_assert(pdr);
+
+    return (teid_table.slot[pdr->teid].generation <<
+            teid_table.index_bits) | pdr->teid;
+}
+
+static void teid_object_set(uint32_t *key, ogs_pfcp_object_t *object)
+{
+    teid_slot_t *slot = NULL;
+
+    ogs_assert(key);
+
+    slot = teid_slot(*key);
+
+    if (!object) {
+        if (slot && slot->object && slot->teid == *key)
+            slot->object = NULL;
+        else
+            ogs_hash_set(self.object_teid_hash, key, sizeof(*key), NULL);
+        return;
+    }
+
+    /*
+     * Only a TEID of the current generation goes to the table,
+     * unless its slot is still used by a TEID shared through CHOOSE-ID.
+     */
+    if (slot && (slot->teid == *key || !slot->object) &&
+        ((*key & ((1 << TEID_GENERATION_LIMIT) - 1)) ==
+            ((slot->generation << teid_table.index_bits) | teid_index(*key)))) {
+        slot->teid = *key;
+        slot->object = object;
+        return;
+    }
+
+    ogs_hash_set(self.object_teid_hash, key, sizeof(*key), object);
+}
+
 ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess)
 {
     ogs_pfcp_pdr_t *pdr = NULL;
@@ -927,6 +1067,7 @@ ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess)
     ogs_assert(pdr->teid_node);
 
     pdr->teid = *(pdr->teid_node);
+    teid_generation_next(&teid_table.slot[pdr->teid]);
 
     /* Set PDR-ID */
     ogs_pool_alloc(&sess->pdr_id_pool, &pdr->id_node);
@@ -941,6 +1082,7 @@ ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess)
 
     pdr->sess = sess;
     ogs_list_add(&sess->pdr_list, pdr);
+    sess->classifier.stale = true;
 
     return pdr;
 }
@@ -980,11 +1122,10 @@ void ogs_pfcp_pdr_swap_teid(ogs_pfcp_pdr_t *pdr)
     int i = 0;
 
     ogs_assert(pdr);
-    ogs_assert(pdr->f_teid.teid > 0 &&
-            pdr->f_teid.teid <= ogs_pfcp_pdr_teid_pool.size);
+    ogs_assert(teid_slot(pdr->f_teid.teid));
 
     /* Find out the Array Index for the restored TEID. */
-    i = pdr_random_to_index[pdr->f_teid.teid];
+    i = pdr_random_to_index[teid_index(pdr->f_teid.teid)];
     ogs_assert(i < ogs_pfcp_pdr_teid_pool.size);
 
     ogs_assert(pdr->teid_node);
@@ -993,9 +1134,9 @@ void ogs_pfcp_pdr_swap_teid(ogs_pfcp_pdr_t *pdr)
      * This situation can occur when multiple PDRs are restored
      * with the same TEID.
      */
-    if (pdr->f_teid.teid == ogs_pfcp_pdr_teid_pool.array[i]) {
+    if (teid_index(pdr->f_teid.teid) == ogs_pfcp_pdr_teid_pool.array[i]) {
         ogs_pfcp_pdr_teid_pool.array[i] = *(pdr->teid_node);
-        *(pdr->teid_node) = pdr->f_teid.teid;
+        *(pdr->teid_node) = teid_index(pdr->f_teid.teid);
     }
 }
 
@@ -1037,10 +1178,10 @@ void ogs_pfcp_object_teid_hash_set(
                     &resource->info, &pdr->f_teid, &pdr->f_teid_len));
                 if (resource->info.teidri)
                     pdr->f_teid.teid = OGS_PFCP_GTPU_INDEX_TO_TEID(
-                            pdr->teid, resource->info.teidri,
+                            teid_choose(pdr), resource->info.teidri,
                             resource->info.teid_range);
                 else
-                    pdr->f_teid.teid = pdr->teid;
+                    pdr->f_teid.teid = teid_choose(pdr);
             } else {
                 ogs_assert(
                     (ogs_gtp_self()->gtpu_addr && pdr->f_teid.ipv4) ||
@@ -1052,27 +1193,24 @@ void ogs_pfcp_object_teid_hash_set(
                         pdr->f_teid.ipv6 ?
                             ogs_gtp_self()->gtpu_addr6 : NULL,
                         &pdr->f_teid, &pdr->f_teid_len));
-                pdr->f_teid.teid = pdr->teid;
+                pdr->f_teid.teid = teid_choose(pdr);
             }
         }
     }
 
     if (pdr->hash.teid.len)
-        ogs_hash_set(self.object_teid_hash,
-                &pdr->hash.teid.key, pdr->hash.teid.len, NULL);
+        teid_object_set(&pdr->hash.teid.key, NULL);
 
     pdr->hash.teid.key = pdr->f_teid.teid;
     pdr->hash.teid.len = sizeof(pdr->hash.teid.key);
 
     switch(type) {
     case OGS_PFCP_OBJ_PDR_TYPE:
-        ogs_hash_set(self.object_teid_hash,
-                &pdr->hash.teid.key, pdr->hash.teid.len, pdr);
+        teid_object_set(&pdr->hash.teid.key, &pdr->obj);
         break;
     case OGS_PFCP_OBJ_SESS_TYPE:
         ogs_assert(pdr->sess);
-        ogs_hash_set(self.object_teid_hash,
-                &pdr->hash.teid.key, pdr->hash.teid.len, pdr->sess);
+        teid_object_set(&pdr->hash.teid.key, &pdr->sess->obj);
         break;
     default:
         ogs_fatal("Unknown type [%d]", type);
@@ -1082,6 +1220,14 @@ void ogs_pfcp_object_teid_hash_set(
 
 ogs_pfcp_object_t *ogs_pfcp_object_find_by_teid(uint32_t teid)
 {
+    teid_slot_t *slot = teid_slot(teid);
+
+    if (slot && slot->object && slot->teid == teid)
+        return slot->object;
+
+    if (!ogs_hash_count(self.object_teid_hash))
+        return NULL;
+
     return (ogs_pfcp_object_t *)ogs_hash_get(
             self.object_teid_hash, &teid, sizeof(teid));
 }
@@ -1127,6 +1273,7 @@ void ogs_pfcp_pdr_reorder_by_precedence(
 
     pdr->precedence = precedence;
     ogs_list_insert_sorted(&sess->pdr_list, pdr, precedence_compare);
+    sess->classifier.stale = true;
 }
 
 void ogs_pfcp_pdr_associate_far(ogs_pfcp_pdr_t *pdr, ogs_pfcp_far_t *far)
@@ -1167,6 +1314,7 @@ void ogs_pfcp_pdr_remove(ogs_pfcp_pdr_t *pdr)
     ogs_assert(pdr->sess);
 
     ogs_list_remove(&pdr->sess->pdr_list, pdr);
+    pdr->sess->classifier.stale = true;
 
     ogs_pfcp_rule_remove_all(pdr);
 
@@ -1182,8 +1330,7 @@ void ogs_pfcp_pdr_remove(ogs_pfcp_pdr_t *pdr)
          * if the current list has a TEID count of 0, there are no other PDRs.
          */
         if (ogs_pfcp_object_count_by_teid(pdr->sess, pdr->f_teid.teid) == 0)
-            ogs_hash_set(self.object_teid_hash,
-                    &pdr->hash.teid.key, pdr->hash.teid.len, NULL);
+            teid_object_set(&pdr->hash.teid.key, NULL);
     }
 
     if (pdr->dnn)
@@ -1464,7 +1611,6 @@ ogs_pfcp_far_t *ogs_pfcp_far_find_by_teid(uint32_t teid)
 
 void ogs_pfcp_far_remove(ogs_pfcp_far_t *far)
 {
-    int i;
     ogs_pfcp_sess_t *sess = NULL;
 
     ogs_assert(far);
@@ -1484,8 +1630,7 @@ void ogs_pfcp_far_remove(ogs_pfcp_far_t *far)
     if (far->dnn)
         ogs_free(far->dnn);
 
-    for (i = 0; i < far->num_of_buffered_packet; i++)
-        ogs_pkbuf_free(far->buffered_packet[i]);
+    ogs_pfcp_buffer_clear(far);
 
     if (far->id_node)
         ogs_pool_free(&far->sess->far_id_pool, far->id_node);
@@ -1725,6 +1870,8 @@ ogs_pfcp_rule_t *ogs_pfcp_rule_add(ogs_pfcp_pdr_t *pdr)
 
     rule->pdr = pdr;
     ogs_list_add(&pdr->rule_list, rule);
+    if (pdr->sess)
+        pdr->sess->classifier.stale = true;
 
     return rule;
 }
@@ -1756,6 +1903,8 @@ void ogs_pfcp_rule_remove(ogs_pfcp_rule_t *rule)
     ogs_assert(pdr);
 
     ogs_list_remove(&pdr->rule_list, rule);
+    if (pdr->sess)
+        pdr->sess->classifier.stale = true;
     ogs_pool_free(&ogs_pfcp_rule_pool, rule);
 }
 
@@ -2091,6 +2240,7 @@ void ogs_pfcp_pool_init(ogs_pfcp_sess_t *sess)
     ogs_assert(sess);
 
     sess->obj.type = OGS_PFCP_OBJ_SESS_TYPE;
+    sess->classifier.stale = true;
 
     ogs_pool_create(&sess->pdr_id_pool, OGS_MAX_NUM_OF_PDR);
     ogs_pool_create(&sess->far_id_pool, OGS_MAX_NUM_OF_FAR);
@@ -2108,6 +2258,8 @@ void ogs_pfcp_pool_final(ogs_pfcp_sess_t *sess)
 {
     ogs_assert(sess);
 
+    ogs_pfcp_classifier_clear(sess);
+
     ogs_pool_destroy(&sess->pdr_id_pool);
     ogs_pool_destroy(&sess->far_id_pool);
     ogs_pool_destroy(&sess->urr_id_pool);
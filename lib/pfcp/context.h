@@ -72,6 +72,11 @@ typedef struct ogs_pfcp_context_s {
     ogs_hash_t      *object_teid_hash; /* hash table for PFCP OBJ(TEID) */
     ogs_hash_t      *far_f_teid_hash;  /* hash table for FAR(TEID+ADDR) */
     ogs_hash_t      *far_teid_hash; /* hash table for FAR(TEID) */
+
+    struct {
+        int64_t budget;     /* Octets buffered by all FARs */
+        int packets;        /* Packets per FAR without a suggestion */
+    } buffer;
 } ogs_pfcp_context_t;
 
 #define OGS_SETUP_PFCP_NODE(__cTX, __pNODE) \
@@ -134,6 +139,7 @@ typedef struct ogs_pfcp_far_s ogs_pfcp_far_t;
 typedef struct ogs_pfcp_urr_s ogs_pfcp_urr_t;
 typedef struct ogs_pfcp_qer_s ogs_pfcp_qer_t;
 typedef struct ogs_pfcp_bar_s ogs_pfcp_bar_t;
+typedef struct ogs_pfcp_buffer_s ogs_pfcp_buffer_t;
 
 typedef struct ogs_pfcp_pdr_s {
     ogs_pfcp_object_t       obj;
@@ -229,8 +235,8 @@ typedef struct ogs_pfcp_far_s {
 
     ogs_pfcp_smreq_flags_t  smreq_flags;
 
-    uint32_t                num_of_buffered_packet;
-    ogs_pkbuf_t             *buffered_packet[OGS_MAX_NUM_OF_PACKET_BUFFER];
+    ogs_pfcp_buffer_t       *buffer;        /* While buffering */
+    bool                    buffer_reported; /* Until flushed or cleared */
 
     struct {
         bool prepared;
@@ -291,6 +297,9 @@ typedef struct ogs_pfcp_bar_s {
     uint8_t                 *id_node;      /* Pool-Node for ID */
     ogs_pfcp_bar_id_t       id;
 
+    /* 0 if the CP function does not suggest it */
+    uint8_t                 suggested_buffering_packets_count;
+
     ogs_pfcp_sess_t         *sess;
 } ogs_pfcp_bar_t;
 
@@ -308,6 +317,14 @@ typedef struct ogs_pfcp_sess_s {
     OGS_POOL(urr_id_pool, uint8_t);
     OGS_POOL(qer_id_pool, uint8_t);
     OGS_POOL(bar_id_pool, uint8_t);
+
+    /* Compiled PDRs, see rule-match.c */
+    struct {
+        bool stale;
+        int num_of_entry;
+        struct ogs_pfcp_classifier_entry_s *entry;
+        struct ogs_pfcp_classifier_filter_s *filter;
+    } classifier;
 } ogs_pfcp_sess_t;
 
 typedef struct ogs_pfcp_subnet_s ogs_pfcp_subnet_t;
@@ -221,11 +221,32 @@ bool ogs_pfcp_up_handle_pdr(
         ogs_pfcp_pdr_t *pdr, uint8_t type, ogs_pkbuf_t *recvbuf,
         ogs_pfcp_user_plane_report_t *report)
 {
-    ogs_pfcp_far_t *far = NULL;
     ogs_pkbuf_t *sendbuf = NULL;
-    bool buffering;
 
     ogs_assert(recvbuf);
+
+    sendbuf = ogs_pkbuf_copy(recvbuf);
+    if (!sendbuf) {
+        ogs_error("ogs_pkbuf_copy() failed");
+        return false;
+    }
+
+    return ogs_pfcp_up_handle_pdr_nocopy(pdr, type, sendbuf, report);
+}
+
+/*
+ * Ownership of 'sendbuf' is transferred : it is forwarded in place
+ * (the GTP-U header goes into its headroom), buffered or freed,
+ * so the caller must not touch it afterwards.
+ */
+bool ogs_pfcp_up_handle_pdr_nocopy(
+        ogs_pfcp_pdr_t *pdr, uint8_t type, ogs_pkbuf_t *sendbuf,
+        ogs_pfcp_user_plane_report_t *report)
+{
+    ogs_pfcp_far_t *far = NULL;
+    bool buffering;
+
+    ogs_assert(sendbuf);
     ogs_assert(type);
     ogs_assert(pdr);
     ogs_assert(report);
@@ -235,12 +256,6 @@ bool ogs_pfcp_up_handle_pdr(
 
     memset(report, 0, sizeof(*report));
 
-    sendbuf = ogs_pkbuf_copy(recvbuf);
-    if (!sendbuf) {
-        ogs_error("ogs_pkbuf_copy() failed");
-        return false;
-    }
-
     buffering = false;
 
     if (!far->gnode) {
@@ -264,17 +279,11 @@ bool ogs_pfcp_up_handle_pdr(
 
     if (buffering == true) {
 
-        if (far->num_of_buffered_packet == 0) {
+        if (ogs_pfcp_buffer_push(far, sendbuf) == true) {
             /* Only the first time a packet is buffered,
              * it reports downlink notifications. */
             report->type.downlink_data_report = 1;
         }
-
-        if (far->num_of_buffered_packet < OGS_MAX_NUM_OF_PACKET_BUFFER) {
-            far->buffered_packet[far->num_of_buffered_packet++] = sendbuf;
-        } else {
-            ogs_pkbuf_free(sendbuf);
-        }
     }
 
     return true;
@@ -627,6 +636,9 @@ ogs_pfcp_pdr_t *ogs_pfcp_handle_create_pdr(ogs_pfcp_sess_t *sess,
         ogs_pfcp_pdr_associate_qer(pdr, qer);
     }
 
+    /* PDI may have changed */
+    sess->classifier.stale = true;
+
     return pdr;
 }
 
@@ -678,6 +690,9 @@ ogs_pfcp_pdr_t *ogs_pfcp_handle_created_pdr(ogs_pfcp_sess_t *sess,
         pdr->f_teid.teid = be32toh(pdr->f_teid.teid);
     }
 
+    /* PDI may have changed */
+    sess->classifier.stale = true;
+
     return pdr;
 }
 
@@ -858,6 +873,9 @@ ogs_pfcp_pdr_t *ogs_pfcp_handle_update_pdr(ogs_pfcp_sess_t *sess,
         }
     }
 
+    /* PDI may have changed */
+    sess->classifier.stale = true;
+
     return pdr;
 }
 
@@ -1254,6 +1272,42 @@ ogs_pfcp_bar_t *ogs_pfcp_handle_create_bar(ogs_pfcp_sess_t *sess,
 
     sess->bar->id = message->bar_id.u8;
 
+    if (message->suggested_buffering_packets_count.presence &&
+        message->suggested_buffering_packets_count.len)
+        sess->bar->suggested_buffering_packets_count = *(uint8_t *)
+            message->suggested_buffering_packets_count.data;
+
+    return sess->bar;
+}
+
+ogs_pfcp_bar_t *ogs_pfcp_handle_update_bar(ogs_pfcp_sess_t *sess,
+        ogs_pfcp_tlv_update_bar_session_modification_request_t *message,
+        uint8_t *cause_value, uint8_t *offending_ie_value)
+{
+    ogs_assert(message);
+    ogs_assert(sess);
+
+    if (message->presence == 0)
+        return NULL;
+
+    if (message->bar_id.presence == 0) {
+        ogs_error("No BAR-ID");
+        *cause_value = OGS_PFCP_CAUSE_MANDATORY_IE_MISSING;
+        *offending_ie_value = OGS_PFCP_BAR_ID_TYPE;
+        return NULL;
+    }
+
+    if (!sess->bar || sess->bar->id != message->bar_id.u8) {
+        ogs_error("[%p] Unknown BAR-ID[%d]", sess->bar, message->bar_id.u8);
+        *cause_value = OGS_PFCP_CAUSE_SESSION_CONTEXT_NOT_FOUND;
+        return NULL;
+    }
+
+    if (message->suggested_buffering_packets_count.presence &&
+        message->suggested_buffering_packets_count.len)
+        sess->bar->suggested_buffering_packets_count = *(uint8_t *)
+            message->suggested_buffering_packets_count.data;
+
     return sess->bar;
 }
 
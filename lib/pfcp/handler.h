@@ -48,6 +48,9 @@ bool ogs_pfcp_up_handle_association_setup_response(
 bool ogs_pfcp_up_handle_pdr(
         ogs_pfcp_pdr_t *pdr, uint8_t type, ogs_pkbuf_t *recvbuf,
         ogs_pfcp_user_plane_report_t *report);
+bool ogs_pfcp_up_handle_pdr_nocopy(
+        ogs_pfcp_pdr_t *pdr, uint8_t type, ogs_pkbuf_t *sendbuf,
+        ogs_pfcp_user_plane_report_t *report);
 bool ogs_pfcp_up_handle_error_indication(
         ogs_pfcp_far_t *far, ogs_pfcp_user_plane_report_t *report);
 
@@ -91,6 +94,9 @@ bool ogs_pfcp_handle_remove_qer(ogs_pfcp_sess_t *sess,
 ogs_pfcp_bar_t *ogs_pfcp_handle_create_bar(ogs_pfcp_sess_t *sess,
         ogs_pfcp_tlv_create_bar_t *message,
         uint8_t *cause_value, uint8_t *offending_ie_value);
+ogs_pfcp_bar_t *ogs_pfcp_handle_update_bar(ogs_pfcp_sess_t *sess,
+        ogs_pfcp_tlv_update_bar_session_modification_request_t *message,
+        uint8_t *cause_value, uint8_t *offending_ie_value);
 bool ogs_pfcp_handle_remove_bar(ogs_pfcp_sess_t *sess,
         ogs_pfcp_tlv_remove_bar_t *message,
         uint8_t *cause_value, uint8_t *offending_ie_value);
@@ -38,6 +38,7 @@
 #include "pfcp/types.h"
 #include "pfcp/conv.h"
 #include "pfcp/context.h"
+#include "pfcp/buffer.h"
 #include "pfcp/rule-match.h"
 #include "pfcp/build.h"
 #include "pfcp/path.h"
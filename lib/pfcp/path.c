@@ -431,18 +431,15 @@ int ogs_pfcp_send_end_marker(ogs_pfcp_pdr_t *pdr)
 void ogs_pfcp_send_buffered_packet(ogs_pfcp_pdr_t *pdr)
 {
     ogs_pfcp_far_t *far = NULL;
-    int i;
+    ogs_pkbuf_t *pkbuf = NULL;
 
     ogs_assert(pdr);
     far = pdr->far;
 
     if (far && far->gnode) {
         if (far->apply_action & OGS_PFCP_APPLY_ACTION_FORW) {
-            for (i = 0; i < far->num_of_buffered_packet; i++) {
-                ogs_pfcp_send_g_pdu(
-                        pdr, OGS_GTPU_MSGTYPE_GPDU, far->buffered_packet[i]);
-            }
-            far->num_of_buffered_packet = 0;
+            while ((pkbuf = ogs_pfcp_buffer_pop(far)) != NULL)
+                ogs_pfcp_send_g_pdu(pdr, OGS_GTPU_MSGTYPE_GPDU, pkbuf);
         }
     }
 }
@@ -35,46 +35,36 @@
 #include <netinet/tcp.h>
 #endif
 
+/*
+ * Every read is bounded by the received length. A Jumbo Payload has
+ * a zero Payload Length and runs to the end of what was received.
+ */
 static int decode_ipv6_header(
-        struct ip6_hdr *ip6_h, uint8_t *proto, uint16_t *hlen)
+        struct ip6_hdr *ip6_h, uint32_t len, uint8_t *proto, uint16_t *hlen)
 {
-    int done = 0;
-    uint8_t *p, *jp, *endp;
+    uint8_t *p, *endp;
     uint8_t nxt;          /* Next Header */
+    uint16_t plen;
+    size_t ext_len;
 
     ogs_assert(ip6_h);
+    ogs_assert(len >= sizeof(*ip6_h));
     ogs_assert(proto);
     ogs_assert(hlen);
 
     nxt = ip6_h->ip6_nxt;
     p = (uint8_t *)ip6_h + sizeof(*ip6_h);
-    endp = p + be16toh(ip6_h->ip6_plen);
-
-    jp = p + sizeof(struct ip6_hbh);
-    while (p == endp) { /* Jumbo Frame */
-        uint32_t jp_len = 0;
-        struct ip6_opt_jumbo *jumbo = NULL;
+    endp = (uint8_t *)ip6_h + len;
 
-        ogs_assert(nxt == 0);
-
-        jumbo = (struct ip6_opt_jumbo *)jp;
-        memcpy(&jp_len, jumbo->ip6oj_jumbo_len, sizeof(jp_len));
-        jp_len = be32toh(jp_len);
-        switch (jumbo->ip6oj_type) {
-        case IP6OPT_JUMBO:
-            endp = p + jp_len;
-            break;
-        case 0:
-            jp++;
-            break;
-        default:
-            jp += (sizeof(struct ip6_opt) + jp_len);
-            break;
-        }
-    }
+    plen = be16toh(ip6_h->ip6_plen);
+    if (plen && plen < endp - p)
+        endp = p + plen;
+    else if (!plen && nxt != IPPROTO_HOPOPTS)
+        endp = p;
 
-    while (p < endp) {
+    while (1) {
         struct ip6_ext *ext = (struct ip6_ext *)p;
+
         switch (nxt) {
         case IPPROTO_HOPOPTS:
         case IPPROTO_ROUTING:
@@ -84,197 +74,443 @@ static int decode_ipv6_header(
         case 140: /* shim6 */
         case 253: /* testing, experimental */
         case 254: /* testing, experimental */
-            p += ((ext->ip6e_len << 3) + 8);
+            if (endp - p < 8)
+                return OGS_ERROR;
+            ext_len = (ext->ip6e_len << 3) + 8;
             break;
         case IPPROTO_FRAGMENT:
-            p += sizeof(struct ip6_frag);
+            ext_len = sizeof(struct ip6_frag);
             break;
         case IPPROTO_AH:
-            p += ((ext->ip6e_len + 2) << 2);
+            if (endp - p < 8)
+                return OGS_ERROR;
+            ext_len = (ext->ip6e_len + 2) << 2;
             break;
         default: /* Upper Layer */
-            done = 1;
-            break;
-
+            *proto = nxt;
+            *hlen = p - (uint8_t *)ip6_h;
+            return OGS_OK;
         }
-        if (done)
-            break;
+
+        if (ext_len > endp - p)
+            return OGS_ERROR;
 
         nxt = ext->ip6e_nxt;
+        p += ext_len;
+    }
+}
+
+int ogs_pfcp_packet_info_parse(
+        ogs_pfcp_packet_info_t *info, ogs_pkbuf_t *pkbuf)
+{
+    struct ip *ip_h =  NULL;
+    struct ip6_hdr *ip6_h = NULL;
+
+    ogs_assert(info);
+    ogs_assert(pkbuf);
+    ogs_assert(pkbuf->len);
+    ogs_assert(pkbuf->data);
+
+    memset(info, 0, sizeof(*info));
+    info->len = pkbuf->len;
+
+    ip_h = (struct ip *)pkbuf->data;
+    if (ip_h->ip_v == 4 && pkbuf->len >= sizeof(struct ip)) {
+        info->version = 4;
+        info->proto = ip_h->ip_p;
+        info->hlen = (ip_h->ip_hl)*4;
+        if (info->hlen < sizeof(struct ip) || info->hlen > pkbuf->len) {
+            ogs_error("Invalid IPv4 header length [%d:%d]",
+                    info->hlen, pkbuf->len);
+            ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
+            return OGS_ERROR;
+        }
+
+        memcpy(info->src_addr, &ip_h->ip_src.s_addr, OGS_IPV4_LEN);
+        memcpy(info->dst_addr, &ip_h->ip_dst.s_addr, OGS_IPV4_LEN);
+        info->addr_len = OGS_IPV4_LEN;
+    } else if (ip_h->ip_v == 6 && pkbuf->len >= sizeof(struct ip6_hdr)) {
+        ip6_h = (struct ip6_hdr *)pkbuf->data;
+
+        info->version = 6;
+        if (decode_ipv6_header(ip6_h, pkbuf->len,
+                    &info->proto, &info->hlen) != OGS_OK) {
+            ogs_error("Invalid IPv6 extension header [Packet Length:%d]",
+                    pkbuf->len);
+            ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
+            return OGS_ERROR;
+        }
+
+        memcpy(info->src_addr, ip6_h->ip6_src.s6_addr, OGS_IPV6_LEN);
+        memcpy(info->dst_addr, ip6_h->ip6_dst.s6_addr, OGS_IPV6_LEN);
+        info->addr_len = OGS_IPV6_LEN;
+    } else {
+        ogs_error("Invalid packet [IP version:%d, Packet Length:%d]",
+                ip_h->ip_v, pkbuf->len);
+        ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
+        return OGS_ERROR;
     }
 
-    *proto = nxt;
-    *hlen = p - (uint8_t *)ip6_h;
+    /* Source and destination ports are at the same offset in TCP and UDP */
+    if ((info->proto == IPPROTO_TCP || info->proto == IPPROTO_UDP) &&
+        pkbuf->len >= info->hlen + sizeof(struct udphdr)) {
+        struct udphdr *udph =
+            (struct udphdr *)((char *)pkbuf->data + info->hlen);
+
+        info->has_port = true;
+        info->src_port = be16toh(udph->uh_sport);
+        info->dst_port = be16toh(udph->uh_dport);
+    }
+
+    ogs_trace("PROTO:%d SRC:%08x %08x %08x %08x",
+            info->proto,
+            be32toh(info->src_addr[0]), be32toh(info->src_addr[1]),
+            be32toh(info->src_addr[2]), be32toh(info->src_addr[3]));
+    ogs_trace("HLEN:%d  DST:%08x %08x %08x %08x",
+            info->hlen,
+            be32toh(info->dst_addr[0]), be32toh(info->dst_addr[1]),
+            be32toh(info->dst_addr[2]), be32toh(info->dst_addr[3]));
 
     return OGS_OK;
 }
 
+/*
+ * Compiled SDF Filter
+ *
+ * A flat copy of the IPFW rule with the checks that cannot fail
+ * folded into flags, so that the common 'permit out ip from any to
+ * <UE>' filter costs a single masked compare.
+ */
+#define CLASSIFIER_FILTER_ANY_SRC   0x01
+#define CLASSIFIER_FILTER_ANY_DST   0x02
+#define CLASSIFIER_FILTER_PORT      0x04
+
+typedef struct ogs_pfcp_classifier_filter_s {
+    ogs_pfcp_rule_t *rule;
+
+    uint8_t proto;
+    uint8_t flags;
+
+    struct {
+        uint16_t low;
+        uint16_t high;
+    } src_port, dst_port;
+
+    uint32_t src_addr[4];
+    uint32_t src_mask[4];
+    uint32_t dst_addr[4];
+    uint32_t dst_mask[4];
+} ogs_pfcp_classifier_filter_t;
+
+typedef struct ogs_pfcp_classifier_entry_s {
+    ogs_pfcp_pdr_t *pdr;
+
+    ogs_pfcp_interface_t src_if;
+    uint32_t teid;
+    uint8_t qfi;
+
+    int first_filter;
+    int num_of_filter;
+} ogs_pfcp_classifier_entry_t;
+
+static bool is_zero_addr(uint32_t *addr)
+{
+    return (addr[0] | addr[1] | addr[2] | addr[3]) == 0;
+}
+
+static void filter_compile(
+        ogs_pfcp_classifier_filter_t *filter, ogs_pfcp_rule_t *rule)
+{
+    ogs_ipfw_rule_t *ipfw = NULL;
+
+    ogs_assert(filter);
+    ogs_assert(rule);
+
+    ipfw = &rule->ipfw;
+
+    ogs_trace("PROTO:%d SRC:%d-%d DST:%d-%d",
+            ipfw->proto,
+            ipfw->port.src.low,
+            ipfw->port.src.high,
+            ipfw->port.dst.low,
+            ipfw->port.dst.high);
+
+    memset(filter, 0, sizeof(*filter));
+    filter->rule = rule;
+    filter->proto = ipfw->proto;
+
+    memcpy(filter->src_addr, ipfw->ip.src.addr, sizeof(filter->src_addr));
+    memcpy(filter->src_mask, ipfw->ip.src.mask, sizeof(filter->src_mask));
+    memcpy(filter->dst_addr, ipfw->ip.dst.addr, sizeof(filter->dst_addr));
+    memcpy(filter->dst_mask, ipfw->ip.dst.mask, sizeof(filter->dst_mask));
+
+    if (is_zero_addr(filter->src_addr) && is_zero_addr(filter->src_mask))
+        filter->flags |= CLASSIFIER_FILTER_ANY_SRC;
+    if (is_zero_addr(filter->dst_addr) && is_zero_addr(filter->dst_mask))
+        filter->flags |= CLASSIFIER_FILTER_ANY_DST;
+
+    /* A zero bound means the range is open on that side */
+    filter->src_port.low = ipfw->port.src.low;
+    filter->src_port.high = ipfw->port.src.high ? ipfw->port.src.high : 0xffff;
+    filter->dst_port.low = ipfw->port.dst.low;
+    filter->dst_port.high = ipfw->port.dst.high ? ipfw->port.dst.high : 0xffff;
+
+    if ((filter->proto == IPPROTO_TCP || filter->proto == IPPROTO_UDP) &&
+        (filter->src_port.low || filter->src_port.high != 0xffff ||
+         filter->dst_port.low || filter->dst_port.high != 0xffff))
+        filter->flags |= CLASSIFIER_FILTER_PORT;
+}
+
+static bool addr_match(uint32_t *addr,
+        uint32_t *rule_addr, uint32_t *rule_mask, int addr_len)
+{
+    int k;
+    uint32_t masked[4];
+
+    for (k = 0; k < 4; k++)
+        masked[k] = addr[k] & rule_mask[k];
+
+    return memcmp(masked, rule_addr, addr_len) == 0;
+}
+
+static bool filter_match(ogs_pfcp_classifier_filter_t *filter,
+        ogs_pfcp_packet_info_t *info)
+{
+    ogs_assert(filter);
+    ogs_assert(info);
+
+    if (!(filter->flags & CLASSIFIER_FILTER_ANY_SRC) &&
+        !addr_match(info->src_addr,
+            filter->src_addr, filter->src_mask, info->addr_len))
+        return false;
+
+    if (!(filter->flags & CLASSIFIER_FILTER_ANY_DST) &&
+        !addr_match(info->dst_addr,
+            filter->dst_addr, filter->dst_mask, info->addr_len))
+        return false;
+
+    /* Protocol match : No need to match port for IP */
+    if (filter->proto == 0)
+        return true;
+
+    if (filter->proto != info->proto)
+        return false;
+
+    if (!(filter->flags & CLASSIFIER_FILTER_PORT))
+        return true;
+
+    if (!info->has_port)
+        return false;
+
+    return info->src_port >= filter->src_port.low &&
+            info->src_port <= filter->src_port.high &&
+            info->dst_port >= filter->dst_port.low &&
+            info->dst_port <= filter->dst_port.high;
+}
+
 ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_packet(
                     ogs_pfcp_pdr_t *pdr, ogs_pkbuf_t *pkbuf)
 {
-    struct ip *ip_h =  NULL;
-    struct ip6_hdr *ip6_h = NULL;
-    uint32_t *src_addr = NULL;
-    uint32_t *dst_addr = NULL;
-    int addr_len = 0;
-    uint8_t proto = 0;
-    uint16_t ip_hlen = 0;
-
+    ogs_pfcp_packet_info_t info;
+    ogs_pfcp_classifier_filter_t filter;
     ogs_pfcp_rule_t *rule = NULL;
 
+    ogs_assert(pdr);
     ogs_assert(pkbuf);
-    ogs_assert(pkbuf->len);
-    ogs_assert(pkbuf->data);
+
+    if (ogs_list_first(&pdr->rule_list) == NULL)
+        return NULL;
+
+    if (ogs_pfcp_packet_info_parse(&info, pkbuf) != OGS_OK)
+        return NULL;
 
     ogs_list_for_each(&pdr->rule_list, rule) {
-        int k;
-        uint32_t src_mask[4];
-        uint32_t dst_mask[4];
-        ogs_ipfw_rule_t *ipfw = NULL;
-
-        ipfw = &rule->ipfw;
-        ogs_assert(ipfw);
-
-        ip_h = (struct ip *)pkbuf->data;
-        if (ip_h->ip_v == 4) {
-            ip_h = (struct ip *)pkbuf->data;
-            ip6_h = NULL;
-
-            proto = ip_h->ip_p;
-            ip_hlen = (ip_h->ip_hl)*4;
-
-            src_addr = (void *)&ip_h->ip_src.s_addr;
-            dst_addr = (void *)&ip_h->ip_dst.s_addr;
-            addr_len = OGS_IPV4_LEN;
-        } else if (ip_h->ip_v == 6) {
-            ip_h = NULL;
-            ip6_h = (struct ip6_hdr *)pkbuf->data;
-
-            decode_ipv6_header(ip6_h, &proto, &ip_hlen);
-
-            src_addr = (void *)ip6_h->ip6_src.s6_addr;
-            dst_addr = (void *)ip6_h->ip6_dst.s6_addr;
-            addr_len = OGS_IPV6_LEN;
-        } else {
-            ogs_error("Invalid packet [IP version:%d, Packet Length:%d]",
-                    ip_h->ip_v, pkbuf->len);
-            ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
+        filter_compile(&filter, rule);
+        if (filter_match(&filter, &info) == true)
+            return rule;
+    }
+
+    return NULL;
+}
+
+/*
+ * Per-session PDR Classifier
+ *
+ * The PDRs of a session are flattened into an array in precedence
+ * order, and all their SDF filters into a second array, so that a
+ * lookup walks two contiguous tables against the packet metadata.
+ *
+ * Any change to the PDRs or their rules marks the table stale,
+ * and it is compiled again before the next lookup.
+ */
+void ogs_pfcp_classifier_build(ogs_pfcp_sess_t *sess)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_rule_t *rule = NULL;
+    ogs_pfcp_classifier_entry_t *entry = NULL;
+    int num_of_entry = 0, num_of_filter = 0;
+
+    ogs_assert(sess);
+
+    ogs_pfcp_classifier_clear(sess);
+
+    ogs_list_for_each(&sess->pdr_list, pdr) {
+        num_of_entry++;
+        num_of_filter += ogs_list_count(&pdr->rule_list);
+    }
+
+    if (num_of_entry) {
+        sess->classifier.entry =
+            ogs_malloc(num_of_entry * sizeof(ogs_pfcp_classifier_entry_t));
+        ogs_assert(sess->classifier.entry);
+    }
+    if (num_of_filter) {
+        sess->classifier.filter =
+            ogs_malloc(num_of_filter * sizeof(ogs_pfcp_classifier_filter_t));
+        ogs_assert(sess->classifier.filter);
+    }
+
+    num_of_filter = 0;
+    ogs_list_for_each(&sess->pdr_list, pdr) {
+        entry = &sess->classifier.entry[sess->classifier.num_of_entry++];
+
+        entry->pdr = pdr;
+        entry->src_if = pdr->src_if;
+        entry->teid = pdr->f_teid.teid;
+        entry->qfi = pdr->qfi;
+
+        entry->first_filter = num_of_filter;
+        ogs_list_for_each(&pdr->rule_list, rule)
+            filter_compile(&sess->classifier.filter[num_of_filter++], rule);
+        entry->num_of_filter = num_of_filter - entry->first_filter;
+    }
+
+    sess->classifier.stale = false;
+}
+
+void ogs_pfcp_classifier_clear(ogs_pfcp_sess_t *sess)
+{
+    ogs_assert(sess);
+
+    if (sess->classifier.entry)
+        ogs_free(sess->classifier.entry);
+    if (sess->classifier.filter)
+        ogs_free(sess->classifier.filter);
+
+    sess->classifier.entry = NULL;
+    sess->classifier.filter = NULL;
+    sess->classifier.num_of_entry = 0;
+    sess->classifier.stale = true;
+}
+
+static bool entry_match(ogs_pfcp_sess_t *sess,
+        ogs_pfcp_classifier_entry_t *entry, ogs_pfcp_packet_info_t *info)
+{
+    int i;
+
+    ogs_assert(sess);
+    ogs_assert(entry);
+    ogs_assert(info);
+
+    /* No SDF filter in PDR */
+    if (!entry->num_of_filter)
+        return true;
+
+    for (i = 0; i < entry->num_of_filter; i++) {
+        if (filter_match(
+                &sess->classifier.filter[entry->first_filter + i],
+                info) == true)
+            return true;
+    }
+
+    return false;
+}
+
+ogs_pfcp_pdr_t *ogs_pfcp_classifier_find_uplink(ogs_pfcp_sess_t *sess,
+        uint32_t teid, uint8_t qfi, ogs_pfcp_packet_info_t *info)
+{
+    int i;
+    ogs_pfcp_classifier_entry_t *entry = NULL;
+
+    ogs_assert(sess);
+    ogs_assert(info);
+
+    if (sess->classifier.stale)
+        ogs_pfcp_classifier_build(sess);
+
+    for (i = 0; i < sess->classifier.num_of_entry; i++) {
+        entry = &sess->classifier.entry[i];
+
+        /* Check if Source Interface */
+        if (entry->src_if != OGS_PFCP_INTERFACE_ACCESS &&
+            entry->src_if != OGS_PFCP_INTERFACE_CP_FUNCTION)
             continue;
-        }
 
-        ogs_trace("PROTO:%d SRC:%08x %08x %08x %08x",
-                proto, be32toh(src_addr[0]), be32toh(src_addr[1]),
-                be32toh(src_addr[2]), be32toh(src_addr[3]));
-        ogs_trace("HLEN:%d  DST:%08x %08x %08x %08x",
-                ip_hlen, be32toh(dst_addr[0]), be32toh(dst_addr[1]),
-                be32toh(dst_addr[2]), be32toh(dst_addr[3]));
-
-        ogs_trace("PROTO:%d SRC:%d-%d DST:%d-%d",
-                ipfw->proto,
-                ipfw->port.src.low,
-                ipfw->port.src.high,
-                ipfw->port.dst.low,
-                ipfw->port.dst.high);
-        ogs_trace("SRC:%08x %08x %08x %08x/%08x %08x %08x %08x",
-                be32toh(ipfw->ip.src.addr[0]),
-                be32toh(ipfw->ip.src.addr[1]),
-                be32toh(ipfw->ip.src.addr[2]),
-                be32toh(ipfw->ip.src.addr[3]),
-                be32toh(ipfw->ip.src.mask[0]),
-                be32toh(ipfw->ip.src.mask[1]),
-                be32toh(ipfw->ip.src.mask[2]),
-                be32toh(ipfw->ip.src.mask[3]));
-        ogs_trace("DST:%08x %08x %08x %08x/%08x %08x %08x %08x",
-                be32toh(ipfw->ip.dst.addr[0]),
-                be32toh(ipfw->ip.dst.addr[1]),
-                be32toh(ipfw->ip.dst.addr[2]),
-                be32toh(ipfw->ip.dst.addr[3]),
-                be32toh(ipfw->ip.dst.mask[0]),
-                be32toh(ipfw->ip.dst.mask[1]),
-                be32toh(ipfw->ip.dst.mask[2]),
-                be32toh(ipfw->ip.dst.mask[3]));
-
-        for (k = 0; k < 4; k++) {
-            src_mask[k] = src_addr[k] & ipfw->ip.src.mask[k];
-            dst_mask[k] = dst_addr[k] & ipfw->ip.dst.mask[k];
-        }
+        /* Check if TEID */
+        if (teid != entry->teid)
+            continue;
 
-        if (memcmp(src_mask, ipfw->ip.src.addr, addr_len) == 0 &&
-            memcmp(dst_mask, ipfw->ip.dst.addr, addr_len) == 0) {
-            /* Protocol match */
-            if (ipfw->proto == 0) { /* IP */
-                /* No need to match port */
-                return rule;
-            }
-
-            if (ipfw->proto == proto) {
-                if (ipfw->proto == IPPROTO_TCP) {
-                    struct tcphdr *tcph =
-                        (struct tcphdr *)((char *)pkbuf->data + ip_hlen);
-
-                    /* Source port */
-                    if (ipfw->port.src.low &&
-                          be16toh(tcph->th_sport) < ipfw->port.src.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.src.high &&
-                          be16toh(tcph->th_sport) > ipfw->port.src.high) {
-                        continue;
-                    }
-
-                    /* Dst Port*/
-                    if (ipfw->port.dst.low &&
-                          be16toh(tcph->th_dport) < ipfw->port.dst.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.dst.high &&
-                          be16toh(tcph->th_dport) > ipfw->port.dst.high) {
-                        continue;
-                    }
-
-                    /* Matched */
-                    return rule;
-
-                } else if (ipfw->proto == IPPROTO_UDP) {
-                    struct udphdr *udph =
-                        (struct udphdr *)((char *)pkbuf->data + ip_hlen);
-
-                    /* Source port */
-                    if (ipfw->port.src.low &&
-                          be16toh(udph->uh_sport) < ipfw->port.src.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.src.high &&
-                          be16toh(udph->uh_sport) > ipfw->port.src.high) {
-                        continue;
-                    }
-
-                    /* Dst Port*/
-                    if (ipfw->port.dst.low &&
-                          be16toh(udph->uh_dport) < ipfw->port.dst.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.dst.high &&
-                          be16toh(udph->uh_dport) > ipfw->port.dst.high) {
-                        continue;
-                    }
-
-                    /* Matched */
-                    return rule;
-
-                } else {
-
-                    /* No need to match port */
-                    return rule;
-
-                }
-            }
-        }
+        /* Check if QFI */
+        if (qfi && entry->qfi != qfi)
+            continue;
+
+        /* Check if Rule List in PDR */
+        if (entry_match(sess, entry, info) == false)
+            continue;
+
+        return entry->pdr;
     }
 
     return NULL;
 }
+
+ogs_pfcp_pdr_t *ogs_pfcp_classifier_find_downlink(
+        ogs_pfcp_sess_t *sess, ogs_pfcp_packet_info_t *info)
+{
+    int i;
+    ogs_pfcp_classifier_entry_t *entry = NULL;
+    ogs_pfcp_pdr_t *fallback_pdr = NULL;
+    ogs_pfcp_far_t *far = NULL;
+
+    ogs_assert(sess);
+    ogs_assert(info);
+
+    if (sess->classifier.stale)
+        ogs_pfcp_classifier_build(sess);
+
+    for (i = 0; i < sess->classifier.num_of_entry; i++) {
+        entry = &sess->classifier.entry[i];
+
+        /* Check if PDR is Downlink */
+        if (entry->src_if != OGS_PFCP_INTERFACE_CORE)
+            continue;
+
+        /* Save the Fallback PDR : Lowest precedence downlink PDR */
+        fallback_pdr = entry->pdr;
+
+        /* The FAR can be updated without touching the PDR */
+        far = entry->pdr->far;
+        ogs_assert(far);
+
+        /* Check if FAR is Downlink */
+        if (far->dst_if != OGS_PFCP_INTERFACE_ACCESS)
+            continue;
+
+        /* Check if Outer header creation */
+        if (far->outer_header_creation.ip4 == 0 &&
+            far->outer_header_creation.ip6 == 0 &&
+            far->outer_header_creation.udp4 == 0 &&
+            far->outer_header_creation.udp6 == 0 &&
+            far->outer_header_creation.gtpu4 == 0 &&
+            far->outer_header_creation.gtpu6 == 0)
+            continue;
+
+        /* Check if Rule List in PDR */
+        if (entry_match(sess, entry, info) == false)
+            continue;
+
+        return entry->pdr;
+    }
+
+    return fallback_pdr;
+}
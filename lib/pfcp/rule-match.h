@@ -28,9 +28,43 @@
 extern "C" {
 #endif
 
+/*
+ * Packet Metadata
+ *
+ * Filled once per packet by ogs_pfcp_packet_info_parse(),
+ * and shared by the session lookup, the SDF filters and the
+ * source address checks of the user plane.
+ */
+typedef struct ogs_pfcp_packet_info_s {
+    uint8_t version;
+    uint8_t proto;                  /* Upper layer protocol */
+    uint16_t hlen;                  /* Offset of the upper layer header */
+    uint32_t len;                   /* Length of the IP packet */
+
+    int addr_len;
+    uint32_t src_addr[4];
+    uint32_t dst_addr[4];
+
+    /* TCP/UDP only, in host byte order */
+    bool has_port;
+    uint16_t src_port;
+    uint16_t dst_port;
+} ogs_pfcp_packet_info_t;
+
+int ogs_pfcp_packet_info_parse(
+        ogs_pfcp_packet_info_t *info, ogs_pkbuf_t *pkbuf);
+
 ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_packet(
                     ogs_pfcp_pdr_t *pdr, ogs_pkbuf_t *pkbuf);
 
+void ogs_pfcp_classifier_build(ogs_pfcp_sess_t *sess);
+void ogs_pfcp_classifier_clear(ogs_pfcp_sess_t *sess);
+
+ogs_pfcp_pdr_t *ogs_pfcp_classifier_find_uplink(ogs_pfcp_sess_t *sess,
+        uint32_t teid, uint8_t qfi, ogs_pfcp_packet_info_t *info);
+ogs_pfcp_pdr_t *ogs_pfcp_classifier_find_downlink(
+        ogs_pfcp_sess_t *sess, ogs_pfcp_packet_info_t *info);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,13 +23,180 @@ const char *OGS_EVENT_NAME_SBI_SERVER = "OGS_EVENT_NAME_SBI_SERVER";
 const char *OGS_EVENT_NAME_SBI_CLIENT = "OGS_EVENT_NAME_SBI_CLIENT";
 const char *OGS_EVENT_NAME_SBI_TIMER = "OGS_EVENT_NAME_SBI_TIMER";
 
+/*
+ * Event Allocator
+ *
+ * Every event is a block of OGS_EVENT_SIZE bytes. A freed block is kept
+ * in a small LIFO magazine of the freeing thread and handed out again
+ * without any lock. Events are often allocated on one thread (e.g. a
+ * freeDiameter callback or a data-plane worker) and freed by the main
+ * loop, so a full magazine moves half of its blocks to a shared depot
+ * and an empty one refills half from it. The depot mutex is only taken
+ * once per batch.
+ *
+ * Blocks are only allocated when no cached one is left, up to
+ * pool.event of them, and are given back in ogs_event_final().
+ */
+#define OGS_EVENT_MAGAZINE_SIZE     64
+#define OGS_EVENT_MAGAZINE_BATCH    (OGS_EVENT_MAGAZINE_SIZE / 2)
+
+typedef union event_block_u {
+    union event_block_u *next;
+    uint64_t align;
+    char data[OGS_EVENT_SIZE];
+} event_block_t;
+
+typedef struct event_magazine_s {
+    struct event_magazine_s *next;
+
+    int count;
+    event_block_t *block[OGS_EVENT_MAGAZINE_SIZE];
+} event_magazine_t;
+
+static struct {
+    bool initialized;
+    ogs_thread_mutex_t mutex;
+
+    event_magazine_t *magazine_list;
+    event_block_t *depot;
+
+    unsigned int num_of_block;
+    unsigned int max_num_of_block;  /* 0 : no limit */
+} event_pool;
+
+static ogs_thread_local event_magazine_t *self_magazine;
+
+void ogs_event_init(unsigned int max)
+{
+    ogs_assert(event_pool.initialized == false);
+
+    ogs_thread_mutex_init(&event_pool.mutex);
+    event_pool.max_num_of_block = max;
+
+    event_pool.initialized = true;
+}
+
+void ogs_event_final(void)
+{
+    event_magazine_t *magazine = NULL;
+    event_block_t *block = NULL;
+
+    if (event_pool.initialized == false)
+        return;
+
+    /* Every thread using events has stopped by now */
+    while ((magazine = event_pool.magazine_list)) {
+        event_pool.magazine_list = magazine->next;
+        while (magazine->count)
+            ogs_free(magazine->block[--magazine->count]);
+        ogs_free(magazine);
+    }
+    while ((block = event_pool.depot)) {
+        event_pool.depot = block->next;
+        ogs_free(block);
+    }
+    self_magazine = NULL;
+
+    ogs_thread_mutex_destroy(&event_pool.mutex);
+    memset(&event_pool, 0, sizeof(event_pool));
+}
+
+static event_magazine_t *magazine_self(void)
+{
+    event_magazine_t *magazine = NULL;
+
+    if (ogs_likely(self_magazine))
+        return self_magazine;
+
+    ogs_assert(event_pool.initialized == true);
+
+    /* Stays registered, with its blocks, until ogs_event_final() */
+    magazine = ogs_calloc(1, sizeof *magazine);
+    ogs_assert(magazine);
+
+    ogs_thread_mutex_lock(&event_pool.mutex);
+    magazine->next = event_pool.magazine_list;
+    event_pool.magazine_list = magazine;
+    ogs_thread_mutex_unlock(&event_pool.mutex);
+
+    self_magazine = magazine;
+
+    return magazine;
+}
+
+static void magazine_refill(event_magazine_t *magazine)
+{
+    event_block_t *block = NULL;
+
+    ogs_thread_mutex_lock(&event_pool.mutex);
+    while (magazine->count < OGS_EVENT_MAGAZINE_BATCH &&
+            (block = event_pool.depot)) {
+        event_pool.depot = block->next;
+        magazine->block[magazine->count++] = block;
+    }
+    ogs_thread_mutex_unlock(&event_pool.mutex);
+}
+
+static void magazine_flush(event_magazine_t *magazine)
+{
+    event_block_t *block = NULL;
+    int n = OGS_EVENT_MAGAZINE_BATCH;
+
+    ogs_thread_mutex_lock(&event_pool.mutex);
+    while (n-- > 0 && magazine->count) {
+        block = magazine->block[--magazine->count];
+        block->next = event_pool.depot;
+        event_pool.depot = block;
+    }
+    ogs_thread_mutex_unlock(&event_pool.mutex);
+}
+
+static event_block_t *block_alloc(void)
+{
+    event_block_t *block = NULL;
+    unsigned int num = ogs_atomic_inc(&event_pool.num_of_block);
+
+    if (event_pool.max_num_of_block && num > event_pool.max_num_of_block) {
+        ogs_atomic_dec(&event_pool.num_of_block);
+        ogs_error("No event available [pool.event:%u]",
+                event_pool.max_num_of_block);
+        return NULL;
+    }
+
+    block = ogs_malloc(sizeof *block);
+    if (!block) {
+        ogs_atomic_dec(&event_pool.num_of_block);
+        ogs_error("ogs_malloc() failed");
+        return NULL;
+    }
+
+    return block;
+}
+
 void *ogs_event_size(int id, size_t size)
 {
+    event_magazine_t *magazine = NULL;
+    event_block_t *block = NULL;
     ogs_event_t *e = NULL;
 
-    e = ogs_calloc(1, size);
-    ogs_assert(e);
+    ogs_assert(size <= OGS_EVENT_SIZE);
+
+    magazine = magazine_self();
+    if (!magazine->count)
+        magazine_refill(magazine);
+
+    if (magazine->count) {
+        block = magazine->block[--magazine->count];
+    } else {
+        block = block_alloc();
+        if (!block)
+            return NULL;
+    }
 
+    /* Only the part used by this NF's event structure */
+    memset(block, 0, size);
+
+    e = (ogs_event_t *)block;
     e->id = id;
 
     return e;
@@ -37,13 +204,29 @@ void *ogs_event_size(int id, size_t size)
 
 ogs_event_t *ogs_event_new(int id)
 {
+    /* The NF reads it as its own, larger, event structure */
     return ogs_event_size(id, OGS_EVENT_SIZE);
 }
 
 void ogs_event_free(void *e)
 {
+    event_magazine_t *magazine = NULL;
+
     ogs_assert(e);
-    ogs_free(e);
+
+    magazine = magazine_self();
+    if (magazine->count == OGS_EVENT_MAGAZINE_SIZE)
+        magazine_flush(magazine);
+
+    magazine->block[magazine->count++] = e;
+}
+
+void ogs_event_stat(ogs_event_stat_t *stat)
+{
+    ogs_assert(stat);
+    memset(stat, 0, sizeof(*stat));
+
+    stat->high_water = ogs_atomic_load(&event_pool.num_of_block);
 }
 
 const char *ogs_event_get_name(ogs_event_t *e)
@@ -70,10 +70,20 @@ typedef struct ogs_event_s {
 
 #define OGS_EVENT_SIZE 256
 
+void ogs_event_init(unsigned int max);
+void ogs_event_final(void);
+
 void *ogs_event_size(int id, size_t size);
 ogs_event_t *ogs_event_new(int id);
 void ogs_event_free(void *e);
 
+typedef struct ogs_event_stat_s {
+    /* Most events alive at once, plus those cached by idle threads */
+    unsigned int high_water;
+} ogs_event_stat_t;
+
+void ogs_event_stat(ogs_event_stat_t *stat);
+
 const char *ogs_event_get_name(ogs_event_t *e);
 
 #ifdef __cplusplus
@@ -34,14 +34,13 @@
 #define IFNAMSIZ 32
 #endif
 
-ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
+static ogs_socket_t tun_open(char *ifname, int is_tap, int flags)
 {
     ogs_socket_t fd = INVALID_SOCKET;
 
     const char *dev = "/dev/net/tun";
     int rc;
     struct ifreq ifr;
-    int flags = IFF_NO_PI;
 
     ogs_assert(ifname);
 
@@ -71,6 +70,25 @@ cleanup:
     return INVALID_SOCKET;
 }
 
+ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
+{
+    return tun_open(ifname, is_tap, IFF_NO_PI);
+}
+
+/*
+ * Opens one queue of a multi-queue TUN/TAP device.
+ *
+ * Every call attaches a new queue to the same interface, so that each
+ * data-plane thread can read and write its own file descriptor.
+ * A persistent interface must have been created with 'multi_queue'.
+ *
+ * $ sudo ip tuntap add name ogstun mode tun multi_queue
+ */
+ogs_socket_t ogs_tun_open_queue(char *ifname, int len, int is_tap)
+{
+    return tun_open(ifname, is_tap, IFF_NO_PI | IFF_MULTI_QUEUE);
+}
+
 int ogs_tun_set_ip(char *ifname, ogs_ipsubnet_t *gw, ogs_ipsubnet_t *sub)
 {
     return OGS_OK;
@@ -110,6 +110,12 @@ ogs_socket_t ogs_tun_open(char *ifname, int maxlen, int is_tap)
     return fd;
 }
 
+ogs_socket_t ogs_tun_open_queue(char *ifname, int maxlen, int is_tap)
+{
+    ogs_error("Multi-queue TUN/TAP is not supported on this platform");
+    return INVALID_SOCKET;
+}
+
 #define TUN_ALIGN(size, boundary) \
         (((size) + ((boundary) - 1)) & ~((boundary) - 1))
 
@@ -0,0 +1,134 @@
+#!/bin/sh
+#
+# Functional test of the AF_XDP receive path of the UPF on a veth pair.
+#
+#   $ sudo ./misc/xdp-test.sh [path to open5gs-upfd]
+#
+# The UPF runs in the 'xdptest' namespace with N3 on veth1 (10.99.0.2),
+# and the test sends from veth0 (10.99.0.1) in the current namespace :
+#
+#   1. A GTP-U Echo Request must be answered, while the UDP counters of
+#      the UPF namespace show that the kernel did not receive it, so it
+#      was redirected to the AF_XDP socket.
+#   2. A datagram to another UDP port must still reach the kernel.
+#   3. A GTP-U datagram to another address of veth1 (10.99.0.3), which
+#      is not a GTP-U address of the UPF, must still reach the kernel.
+#
+# Requires ip(8), python3, and a kernel with AF_XDP (5.4 or later).
+# Only copy mode is available on veth.
+
+UPFD=${1:-./build/src/upf/open5gs-upfd}
+NS=xdptest
+TMP=`mktemp -d /tmp/open5gs-xdp.XXXXXX`
+UPF_PID=
+
+cleanup() {
+    [ -n "$UPF_PID" ] && kill $UPF_PID 2> /dev/null && wait $UPF_PID
+    ip link del veth0 2> /dev/null
+    ip netns del $NS 2> /dev/null
+    rm -rf $TMP
+}
+
+fail() {
+    echo "FAIL: $*"
+    [ -f $TMP/upf.log ] && tail -20 $TMP/upf.log
+    cleanup
+    exit 1
+}
+
+udp_in() {
+    ip netns exec $NS awk '/^Udp: [0-9]/ { print $2 + $3 }' /proc/net/snmp
+}
+
+if [ "`id -u`" != "0" ]; then
+    echo "$0: must be run as root"
+    exit 1
+fi
+[ -x "$UPFD" ] || { echo "$0: $UPFD not found"; exit 1; }
+
+ip netns add $NS || exit 1
+ip link add veth0 type veth peer name veth1 netns $NS || fail "veth"
+ip addr add 10.99.0.1/24 dev veth0
+ip link set veth0 up
+ip netns exec $NS ip link set lo up
+ip netns exec $NS ip addr add 10.99.0.2/24 dev veth1
+ip netns exec $NS ip addr add 10.99.0.3/24 dev veth1
+ip netns exec $NS ip link set veth1 up
+ip netns exec $NS ip tuntap add name ogstun mode tun
+ip netns exec $NS ip addr add 10.45.0.1/16 dev ogstun
+ip netns exec $NS ip link set ogstun up
+
+cat > $TMP/upf.yaml << EOF
+logger:
+    file: $TMP/upf.log
+upf:
+    pfcp:
+      - addr: 127.0.0.7
+    gtpu:
+      - addr: 10.99.0.2
+    subnet:
+      - addr: 10.45.0.1/16
+    xdp:
+      dev: veth1
+EOF
+
+ip netns exec $NS $UPFD -c $TMP/upf.yaml > /dev/null 2>&1 &
+UPF_PID=$!
+
+for i in 1 2 3 4 5 6 7 8 9 10; do
+    grep -q "AF_XDP on veth1" $TMP/upf.log 2> /dev/null && break
+    sleep 1
+done
+grep -q "AF_XDP on veth1" $TMP/upf.log 2> /dev/null || \
+    fail "AF_XDP was not attached to veth1"
+
+# Let the neighbour entries settle so that only the test datagrams count
+ping -c 1 -W 1 10.99.0.2 > /dev/null || fail "no route to 10.99.0.2"
+
+BEFORE=`udp_in`
+
+python3 - << EOF || fail "no GTP-U Echo Response"
+import socket, struct
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.bind(("10.99.0.1", 2152))
+s.settimeout(2)
+# GTPv1-U Echo Request with a sequence number
+s.sendto(struct.pack("!BBHIHBB", 0x32, 1, 4, 0, 0x1234, 0, 0),
+        ("10.99.0.2", 2152))
+data, peer = s.recvfrom(2048)
+assert data[1] == 2 and data[8:10] == b"\x12\x34", data
+EOF
+
+AFTER=`udp_in`
+[ "$AFTER" = "$BEFORE" ] || \
+    fail "GTP-U reached the kernel ($BEFORE -> $AFTER UDP datagrams)"
+echo "PASS: GTP-U is redirected to AF_XDP"
+
+python3 - << EOF
+import socket
+socket.socket(socket.AF_INET, socket.SOCK_DGRAM).sendto(
+        b"open5gs", ("10.99.0.2", 9999))
+EOF
+sleep 1
+
+AFTER=`udp_in`
+[ "$AFTER" -gt "$BEFORE" ] || fail "other UDP did not reach the kernel"
+echo "PASS: other UDP reaches the kernel"
+
+BEFORE=$AFTER
+
+python3 - << EOF
+import socket, struct
+socket.socket(socket.AF_INET, socket.SOCK_DGRAM).sendto(
+        struct.pack("!BBHIHBB", 0x32, 1, 4, 0, 0x1234, 0, 0),
+        ("10.99.0.3", 2152))
+EOF
+sleep 1
+
+AFTER=`udp_in`
+[ "$AFTER" -gt "$BEFORE" ] || \
+    fail "GTP-U to another address did not reach the kernel"
+echo "PASS: GTP-U to another address reaches the kernel"
+
+cleanup
+exit 0
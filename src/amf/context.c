@@ -31,6 +31,9 @@ static OGS_POOL(amf_sess_pool, amf_sess_t);
 
 static OGS_POOL(m_tmsi_pool, amf_m_tmsi_t);
 
+static OGS_POOL(amf_paging_area_pool, amf_paging_area_t);
+static OGS_POOL(amf_paging_gnb_pool, amf_paging_gnb_t);
+
 static int context_initialized = 0;
 
 static int num_of_ran_ue = 0;
@@ -41,6 +44,8 @@ static void stats_remove_ran_ue(void);
 static void stats_add_amf_session(void);
 static void stats_remove_amf_session(void);
 
+static void paging_area_clear(amf_gnb_t *gnb);
+
 void amf_context_init(void)
 {
     ogs_assert(context_initialized == 0);
@@ -64,6 +69,10 @@ void amf_context_init(void)
     ogs_pool_init(&amf_sess_pool, ogs_app()->pool.sess);
     ogs_pool_init(&m_tmsi_pool, ogs_app()->max.ue*2);
     ogs_pool_random_id_generate(&m_tmsi_pool);
+    ogs_pool_init(&amf_paging_area_pool,
+            ogs_app()->max.peer*2 * MAX_NUM_OF_PAGING_TAI);
+    ogs_pool_init(&amf_paging_gnb_pool,
+            ogs_app()->max.peer*2 * MAX_NUM_OF_PAGING_TAI);
 
     ogs_list_init(&self.gnb_list);
     ogs_list_init(&self.amf_ue_list);
@@ -78,6 +87,8 @@ void amf_context_init(void)
     ogs_assert(self.suci_hash);
     self.supi_hash = ogs_hash_make();
     ogs_assert(self.supi_hash);
+    self.paging_area_hash = ogs_hash_make();
+    ogs_assert(self.paging_area_hash);
 
     context_initialized = 1;
 }
@@ -100,7 +111,11 @@ void amf_context_final(void)
     ogs_hash_destroy(self.suci_hash);
     ogs_assert(self.supi_hash);
     ogs_hash_destroy(self.supi_hash);
+    ogs_assert(self.paging_area_hash);
+    ogs_hash_destroy(self.paging_area_hash);
 
+    ogs_pool_final(&amf_paging_gnb_pool);
+    ogs_pool_final(&amf_paging_area_pool);
     ogs_pool_final(&m_tmsi_pool);
     ogs_pool_final(&amf_sess_pool);
     ogs_pool_final(&amf_ue_pool);
@@ -1039,6 +1054,8 @@ int amf_context_parse_config(void)
                     /* handle config in app library */
                 } else if (!strcmp(time_key, "handover")) {
                     /* handle config in app library */
+                } else if (!strcmp(time_key, "timer")) {
+                    /* handle config in app library */
                 } else
                     ogs_warn("unknown key `%s`", time_key);
             }
@@ -1171,6 +1188,8 @@ amf_gnb_t *amf_gnb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     gnb->ostream_id = 0;
 
     ogs_list_init(&gnb->ran_ue_list);
+    gnb->ran_ue_hash = ogs_hash_make();
+    ogs_assert(gnb->ran_ue_hash);
 
     ogs_hash_set(self.gnb_addr_hash,
             gnb->sctp.addr, sizeof(ogs_sockaddr_t), gnb);
@@ -1205,6 +1224,12 @@ void amf_gnb_remove(amf_gnb_t *gnb)
             gnb->sctp.addr, sizeof(ogs_sockaddr_t), NULL);
     ogs_hash_set(self.gnb_id_hash, &gnb->gnb_id, sizeof(gnb->gnb_id), NULL);
 
+    paging_area_clear(gnb);
+
+    /* A RAN UE waiting for the SMF may outlive its gNB */
+    ogs_hash_destroy(gnb->ran_ue_hash);
+    gnb->ran_ue_hash = NULL;
+
     ogs_sctp_flush_and_destroy(&gnb->sctp);
 
     ogs_pool_free(&amf_gnb_pool, gnb);
@@ -1267,6 +1292,179 @@ amf_gnb_t *amf_gnb_cycle(amf_gnb_t *gnb)
     return ogs_pool_cycle(&amf_gnb_pool, gnb);
 }
 
+static void paging_area_add(amf_gnb_t *gnb, ogs_5gs_tai_t *nr_tai)
+{
+    amf_paging_area_t *area = NULL;
+    amf_paging_gnb_t *node = NULL;
+
+    area = ogs_hash_get(self.paging_area_hash, nr_tai, sizeof(*nr_tai));
+    if (!area) {
+        ogs_pool_alloc(&amf_paging_area_pool, &area);
+        ogs_assert(area);
+        memset(area, 0, sizeof *area);
+
+        memcpy(&area->tai, nr_tai, sizeof(area->tai));
+        ogs_list_init(&area->gnb_list);
+
+        ogs_hash_set(self.paging_area_hash,
+                &area->tai, sizeof(area->tai), area);
+    }
+
+    ogs_pool_alloc(&amf_paging_gnb_pool, &node);
+    ogs_assert(node);
+    memset(node, 0, sizeof *node);
+
+    node->gnb = gnb;
+    ogs_list_add(&area->gnb_list, node);
+}
+
+static void paging_area_remove(amf_gnb_t *gnb, ogs_5gs_tai_t *nr_tai)
+{
+    amf_paging_area_t *area = NULL;
+    amf_paging_gnb_t *node = NULL;
+
+    area = ogs_hash_get(self.paging_area_hash, nr_tai, sizeof(*nr_tai));
+    ogs_assert(area);
+
+    ogs_list_for_each(&area->gnb_list, node) {
+        if (node->gnb == gnb) {
+            ogs_list_remove(&area->gnb_list, node);
+            ogs_pool_free(&amf_paging_gnb_pool, node);
+            break;
+        }
+    }
+
+    if (ogs_list_first(&area->gnb_list) == NULL) {
+        ogs_hash_set(self.paging_area_hash,
+                &area->tai, sizeof(area->tai), NULL);
+        ogs_pool_free(&amf_paging_area_pool, area);
+    }
+}
+
+static void paging_area_clear(amf_gnb_t *gnb)
+{
+    int i;
+
+    for (i = 0; i < gnb->num_of_paging_tai; i++)
+        paging_area_remove(gnb, &gnb->paging_tai[i]);
+
+    gnb->num_of_paging_tai = 0;
+}
+
+void amf_gnb_update_paging_area(amf_gnb_t *gnb)
+{
+    ogs_5gs_tai_t nr_tai;
+    int i, j, k;
+
+    ogs_assert(gnb);
+
+    paging_area_clear(gnb);
+
+    for (i = 0; i < gnb->num_of_supported_ta_list; i++) {
+        for (j = 0; j < gnb->supported_ta_list[i].num_of_bplmn_list; j++) {
+            memset(&nr_tai, 0, sizeof(nr_tai));
+            memcpy(&nr_tai.plmn_id,
+                    &gnb->supported_ta_list[i].bplmn_list[j].plmn_id,
+                    OGS_PLMN_ID_LEN);
+            nr_tai.tac.v = gnb->supported_ta_list[i].tac.v;
+
+            /* Page a gNB only once for a TAI it reports twice */
+            for (k = 0; k < gnb->num_of_paging_tai; k++) {
+                if (memcmp(&gnb->paging_tai[k], &nr_tai, sizeof(nr_tai)) == 0)
+                    break;
+            }
+            if (k < gnb->num_of_paging_tai)
+                continue;
+
+            paging_area_add(gnb, &nr_tai);
+            memcpy(&gnb->paging_tai[gnb->num_of_paging_tai++],
+                    &nr_tai, sizeof(nr_tai));
+        }
+    }
+}
+
+amf_paging_area_t *amf_paging_area_find(ogs_5gs_tai_t *nr_tai)
+{
+    ogs_assert(nr_tai);
+    return (amf_paging_area_t *)ogs_hash_get(
+            self.paging_area_hash, nr_tai, sizeof(*nr_tai));
+}
+
+/*
+ * RAN UEs are indexed by RAN-UE-NGAP-ID in the hash of their gNB.
+ * The key points into the ran_ue itself, so the ID must only be
+ * changed with ran_ue_set_ran_ue_ngap_id(). A target UE waiting for
+ * its ID during handover (INVALID_UE_NGAP_ID) is not indexed.
+ *
+ * A UE that claims an ID already in use is chained behind the first
+ * one, which keeps the entry until it is removed. The lookup returns
+ * the first UE, as the list lookup did.
+ */
+static void ran_ue_hash_add(ran_ue_t *ran_ue)
+{
+    ran_ue_t *iter = NULL;
+
+    ogs_assert(ran_ue);
+    ogs_assert(ran_ue->gnb);
+
+    ran_ue->duplicate = NULL;
+
+    if (ran_ue->ran_ue_ngap_id == INVALID_UE_NGAP_ID)
+        return;
+
+    iter = ogs_hash_get(ran_ue->gnb->ran_ue_hash, &ran_ue->ran_ue_ngap_id,
+            sizeof(ran_ue->ran_ue_ngap_id));
+    if (!iter) {
+        ogs_hash_set(ran_ue->gnb->ran_ue_hash, &ran_ue->ran_ue_ngap_id,
+                sizeof(ran_ue->ran_ue_ngap_id), ran_ue);
+        return;
+    }
+
+    /* The first UE keeps the ID, the others queue up behind it */
+    while (iter->duplicate)
+        iter = iter->duplicate;
+    iter->duplicate = ran_ue;
+}
+
+static void ran_ue_hash_remove(ran_ue_t *ran_ue)
+{
+    ran_ue_t *iter = NULL;
+
+    ogs_assert(ran_ue);
+    ogs_assert(ran_ue->gnb);
+
+    if (ran_ue->ran_ue_ngap_id == INVALID_UE_NGAP_ID)
+        return;
+
+    /* The gNB has been removed while the UE was waiting for the SMF */
+    if (!ran_ue->gnb->ran_ue_hash)
+        return;
+
+    iter = ogs_hash_get(ran_ue->gnb->ran_ue_hash, &ran_ue->ran_ue_ngap_id,
+            sizeof(ran_ue->ran_ue_ngap_id));
+    if (iter == ran_ue) {
+        /*
+         * An entry keeps the key pointer it was created with.
+         * Drop it before the next UE with the same ID takes over.
+         */
+        ogs_hash_set(ran_ue->gnb->ran_ue_hash, &ran_ue->ran_ue_ngap_id,
+                sizeof(ran_ue->ran_ue_ngap_id), NULL);
+        if (ran_ue->duplicate)
+            ogs_hash_set(ran_ue->gnb->ran_ue_hash,
+                    &ran_ue->duplicate->ran_ue_ngap_id,
+                    sizeof(ran_ue->ran_ue_ngap_id), ran_ue->duplicate);
+    } else {
+        for (; iter; iter = iter->duplicate) {
+            if (iter->duplicate == ran_ue) {
+                iter->duplicate = ran_ue->duplicate;
+                break;
+            }
+        }
+    }
+
+    ran_ue->duplicate = NULL;
+}
+
 /** ran_ue_context handling function */
 ran_ue_t *ran_ue_add(amf_gnb_t *gnb, uint32_t ran_ue_ngap_id)
 {
@@ -1309,6 +1507,7 @@ ran_ue_t *ran_ue_add(amf_gnb_t *gnb, uint32_t ran_ue_ngap_id)
     ran_ue->gnb = gnb;
 
     ogs_list_add(&gnb->ran_ue_list, ran_ue);
+    ran_ue_hash_add(ran_ue);
 
     stats_add_ran_ue();
 
@@ -1320,6 +1519,7 @@ void ran_ue_remove(ran_ue_t *ran_ue)
     ogs_assert(ran_ue);
     ogs_assert(ran_ue->gnb);
 
+    ran_ue_hash_remove(ran_ue);
     ogs_list_remove(&ran_ue->gnb->ran_ue_list, ran_ue);
 
     ogs_assert(ran_ue->t_ng_holding);
@@ -1337,6 +1537,7 @@ void ran_ue_switch_to_gnb(ran_ue_t *ran_ue, amf_gnb_t *new_gnb)
     ogs_assert(new_gnb);
 
     /* Remove from the old gnb */
+    ran_ue_hash_remove(ran_ue);
     ogs_list_remove(&ran_ue->gnb->ran_ue_list, ran_ue);
 
     /* Add to the new gnb */
@@ -1344,19 +1545,26 @@ void ran_ue_switch_to_gnb(ran_ue_t *ran_ue, amf_gnb_t *new_gnb)
 
     /* Switch to gnb */
     ran_ue->gnb = new_gnb;
+    ran_ue_hash_add(ran_ue);
+}
+
+void ran_ue_set_ran_ue_ngap_id(ran_ue_t *ran_ue, uint32_t ran_ue_ngap_id)
+{
+    ogs_assert(ran_ue);
+    ogs_assert(ran_ue->gnb);
+
+    ran_ue_hash_remove(ran_ue);
+    ran_ue->ran_ue_ngap_id = ran_ue_ngap_id;
+    ran_ue_hash_add(ran_ue);
 }
 
 ran_ue_t *ran_ue_find_by_ran_ue_ngap_id(
         amf_gnb_t *gnb, uint32_t ran_ue_ngap_id)
 {
-    ran_ue_t *ran_ue = NULL;
-
-    ogs_list_for_each(&gnb->ran_ue_list, ran_ue) {
-        if (ran_ue_ngap_id == ran_ue->ran_ue_ngap_id)
-            break;
-    }
+    ogs_assert(gnb);
 
-    return ran_ue;
+    return (ran_ue_t *)ogs_hash_get(gnb->ran_ue_hash,
+            &ran_ue_ngap_id, sizeof(ran_ue_ngap_id));
 }
 
 ran_ue_t *ran_ue_find(uint32_t index)
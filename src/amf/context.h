@@ -110,6 +110,7 @@ typedef struct amf_context_s {
     ogs_hash_t      *guti_ue_hash;          /* hash table (GUTI : AMF_UE) */
     ogs_hash_t      *suci_hash;     /* hash table (SUCI) */
     ogs_hash_t      *supi_hash;     /* hash table (SUPI) */
+    ogs_hash_t      *paging_area_hash;  /* hash table (TAI : PAGING_AREA) */
 
     uint16_t        ngap_port;      /* Default NGAP Port */
 
@@ -156,9 +157,30 @@ typedef struct amf_gnb_s {
     ogs_pkbuf_t     *ng_reset_ack; /* Reset message */
 
     ogs_list_t      ran_ue_list;
+    ogs_hash_t      *ran_ue_hash;   /* hash table (RAN-UE-NGAP-ID : RAN_UE) */
+
+    /* TAIs under which this gNB is in amf_self()->paging_area_hash */
+#define MAX_NUM_OF_PAGING_TAI (OGS_MAX_NUM_OF_TAI * OGS_MAX_NUM_OF_BPLMN)
+    int             num_of_paging_tai;
+    ogs_5gs_tai_t   paging_tai[MAX_NUM_OF_PAGING_TAI];
 
 } amf_gnb_t;
 
+/*
+ * The gNBs supporting a TAI, so that Paging does not have to scan
+ * the Supported TA List of every gNB. It is rebuilt from the list by
+ * amf_gnb_update_paging_area() on NG Setup and RAN Configuration Update.
+ */
+typedef struct amf_paging_area_s {
+    ogs_5gs_tai_t   tai;        /* hash key */
+    ogs_list_t      gnb_list;   /* list of amf_paging_gnb_t */
+} amf_paging_area_t;
+
+typedef struct amf_paging_gnb_s {
+    ogs_lnode_t     lnode;
+    amf_gnb_t       *gnb;
+} amf_paging_gnb_t;
+
 struct ran_ue_s {
     ogs_lnode_t     lnode;
     uint32_t        index;
@@ -167,6 +189,7 @@ struct ran_ue_s {
 #define INVALID_UE_NGAP_ID      0xffffffff /* Initial value of ran_ue_ngap_id */
     uint32_t        ran_ue_ngap_id; /* eNB-UE-NGAP-ID received from eNB */
     uint64_t        amf_ue_ngap_id; /* AMF-UE-NGAP-ID received from AMF */
+    ran_ue_t        *duplicate;     /* Next UE with the same RAN-UE-NGAP-ID */
 
     uint16_t        gnb_ostream_id; /* SCTP output stream id for eNB */
 
@@ -667,9 +690,13 @@ int amf_gnb_set_gnb_id(amf_gnb_t *gnb, uint32_t gnb_id);
 int amf_gnb_sock_type(ogs_sock_t *sock);
 amf_gnb_t *amf_gnb_cycle(amf_gnb_t *gnb);
 
+void amf_gnb_update_paging_area(amf_gnb_t *gnb);
+amf_paging_area_t *amf_paging_area_find(ogs_5gs_tai_t *nr_tai);
+
 ran_ue_t *ran_ue_add(amf_gnb_t *gnb, uint32_t ran_ue_ngap_id);
 void ran_ue_remove(ran_ue_t *ran_ue);
 void ran_ue_switch_to_gnb(ran_ue_t *ran_ue, amf_gnb_t *new_gnb);
+void ran_ue_set_ran_ue_ngap_id(ran_ue_t *ran_ue, uint32_t ran_ue_ngap_id);
 ran_ue_t *ran_ue_find_by_ran_ue_ngap_id(
         amf_gnb_t *gnb, uint32_t ran_ue_ngap_id);
 ran_ue_t *ran_ue_find(uint32_t index);
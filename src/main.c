@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 
 #include "ogs-app.h"
+#include "ogs-proto.h"
 #include "version.h"
 
 static void show_version(void)
@@ -47,6 +48,9 @@ static void show_help(const char *name)
 
 static int check_signal(int signum)
 {
+    ogs_event_stat_t event_stat;
+    ogs_pkbuf_cache_stat_t pkbuf_stat;
+
     switch (signum) {
     case SIGTERM:
     case SIGINT:
@@ -71,6 +75,20 @@ static int check_signal(int signum)
                 (unsigned long)talloc_total_blocks(__ogs_talloc_core),
                 (int)talloc_reference_count(__ogs_talloc_core),
                 __ogs_talloc_core);
+
+        ogs_event_stat(&event_stat);
+        fprintf(stderr, "%*s%-30s high-water mark %6u (pool.event %llu)\n",
+                0, "", "event", event_stat.high_water,
+                (unsigned long long)ogs_app()->pool.event);
+
+        ogs_pkbuf_cache_stat(&pkbuf_stat);
+        fprintf(stderr, "%*s%-30s %llu hit, %llu miss (%.1f%% hit rate)\n",
+                0, "", "pkbuf cache",
+                (unsigned long long)pkbuf_stat.hit,
+                (unsigned long long)pkbuf_stat.miss,
+                pkbuf_stat.hit + pkbuf_stat.miss ?
+                    100.0 * pkbuf_stat.hit /
+                        (pkbuf_stat.hit + pkbuf_stat.miss) : 0.0);
         break;
 
     case SIGUSR2:
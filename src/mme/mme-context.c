@@ -54,6 +54,9 @@ static OGS_POOL(mme_bearer_pool, mme_bearer_t);
 
 static OGS_POOL(m_tmsi_pool, mme_m_tmsi_t);
 
+static OGS_POOL(mme_paging_area_pool, mme_paging_area_t);
+static OGS_POOL(mme_paging_enb_pool, mme_paging_enb_t);
+
 static int context_initialized = 0;
 
 static int num_of_enb_ue = 0;
@@ -64,6 +67,8 @@ static void stats_remove_enb_ue(void);
 static void stats_add_mme_session(void);
 static void stats_remove_mme_session(void);
 
+static void paging_area_clear(mme_enb_t *enb);
+
 static bool compare_ue_info(mme_sgw_t *node, enb_ue_t *enb_ue);
 static mme_sgw_t *selected_sgw_node(mme_sgw_t *current, enb_ue_t *enb_ue);
 static mme_sgw_t *changed_sgw_node(mme_sgw_t *current, enb_ue_t *enb_ue);
@@ -117,6 +122,10 @@ void mme_context_init(void)
     ogs_pool_init(&mme_bearer_pool, ogs_app()->pool.bearer);
     ogs_pool_init(&m_tmsi_pool, ogs_app()->max.ue*2);
     ogs_pool_random_id_generate(&m_tmsi_pool);
+    ogs_pool_init(&mme_paging_area_pool,
+            ogs_app()->max.peer*2 * MAX_NUM_OF_PAGING_TAI);
+    ogs_pool_init(&mme_paging_enb_pool,
+            ogs_app()->max.peer*2 * MAX_NUM_OF_PAGING_TAI);
 
     self.enb_addr_hash = ogs_hash_make();
     ogs_assert(self.enb_addr_hash);
@@ -126,6 +135,8 @@ void mme_context_init(void)
     ogs_assert(self.imsi_ue_hash);
     self.guti_ue_hash = ogs_hash_make();
     ogs_assert(self.guti_ue_hash);
+    self.paging_area_hash = ogs_hash_make();
+    ogs_assert(self.paging_area_hash);
     self.mme_s11_teid_hash = ogs_hash_make();
     ogs_assert(self.mme_s11_teid_hash);
 
@@ -156,9 +167,13 @@ void mme_context_final(void)
     ogs_hash_destroy(self.imsi_ue_hash);
     ogs_assert(self.guti_ue_hash);
     ogs_hash_destroy(self.guti_ue_hash);
+    ogs_assert(self.paging_area_hash);
+    ogs_hash_destroy(self.paging_area_hash);
     ogs_assert(self.mme_s11_teid_hash);
     ogs_hash_destroy(self.mme_s11_teid_hash);
 
+    ogs_pool_final(&mme_paging_enb_pool);
+    ogs_pool_final(&mme_paging_area_pool);
     ogs_pool_final(&m_tmsi_pool);
     ogs_pool_final(&mme_bearer_pool);
     ogs_pool_final(&mme_sess_pool);
@@ -2139,6 +2154,8 @@ int mme_context_parse_config(void)
                     /* handle config in app library */
                 } else if (!strcmp(time_key, "handover")) {
                     /* handle config in app library */
+                } else if (!strcmp(time_key, "timer")) {
+                    /* handle config in app library */
                 } else
                     ogs_warn("unknown key `%s`", time_key);
             }
@@ -2543,6 +2560,8 @@ mme_enb_t *mme_enb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     enb->ostream_id = 0;
 
     ogs_list_init(&enb->enb_ue_list);
+    enb->enb_ue_hash = ogs_hash_make();
+    ogs_assert(enb->enb_ue_hash);
 
     ogs_hash_set(self.enb_addr_hash,
             enb->sctp.addr, sizeof(ogs_sockaddr_t), enb);
@@ -2577,6 +2596,12 @@ int mme_enb_remove(mme_enb_t *enb)
             enb->sctp.addr, sizeof(ogs_sockaddr_t), NULL);
     ogs_hash_set(self.enb_id_hash, &enb->enb_id, sizeof(enb->enb_id), NULL);
 
+    paging_area_clear(enb);
+
+    /* An eNB UE waiting for the SGW-C may outlive its eNB */
+    ogs_hash_destroy(enb->enb_ue_hash);
+    enb->enb_ue_hash = NULL;
+
     /*
      * CHECK:
      *
@@ -2650,6 +2675,171 @@ mme_enb_t *mme_enb_cycle(mme_enb_t *enb)
     return ogs_pool_cycle(&mme_enb_pool, enb);
 }
 
+static void paging_area_add(mme_enb_t *enb, ogs_eps_tai_t *tai)
+{
+    mme_paging_area_t *area = NULL;
+    mme_paging_enb_t *node = NULL;
+
+    area = ogs_hash_get(self.paging_area_hash, tai, sizeof(*tai));
+    if (!area) {
+        ogs_pool_alloc(&mme_paging_area_pool, &area);
+        ogs_assert(area);
+        memset(area, 0, sizeof *area);
+
+        memcpy(&area->tai, tai, sizeof(area->tai));
+        ogs_list_init(&area->enb_list);
+
+        ogs_hash_set(self.paging_area_hash,
+                &area->tai, sizeof(area->tai), area);
+    }
+
+    ogs_pool_alloc(&mme_paging_enb_pool, &node);
+    ogs_assert(node);
+    memset(node, 0, sizeof *node);
+
+    node->enb = enb;
+    ogs_list_add(&area->enb_list, node);
+}
+
+static void paging_area_remove(mme_enb_t *enb, ogs_eps_tai_t *tai)
+{
+    mme_paging_area_t *area = NULL;
+    mme_paging_enb_t *node = NULL;
+
+    area = ogs_hash_get(self.paging_area_hash, tai, sizeof(*tai));
+    ogs_assert(area);
+
+    ogs_list_for_each(&area->enb_list, node) {
+        if (node->enb == enb) {
+            ogs_list_remove(&area->enb_list, node);
+            ogs_pool_free(&mme_paging_enb_pool, node);
+            break;
+        }
+    }
+
+    if (ogs_list_first(&area->enb_list) == NULL) {
+        ogs_hash_set(self.paging_area_hash,
+                &area->tai, sizeof(area->tai), NULL);
+        ogs_pool_free(&mme_paging_area_pool, area);
+    }
+}
+
+static void paging_area_clear(mme_enb_t *enb)
+{
+    int i;
+
+    for (i = 0; i < enb->num_of_paging_tai; i++)
+        paging_area_remove(enb, &enb->paging_tai[i]);
+
+    enb->num_of_paging_tai = 0;
+}
+
+void mme_enb_update_paging_area(mme_enb_t *enb)
+{
+    int i, k;
+
+    ogs_assert(enb);
+
+    paging_area_clear(enb);
+
+    for (i = 0; i < enb->num_of_supported_ta_list; i++) {
+        /* Page an eNB only once for a TAI it reports twice */
+        for (k = 0; k < enb->num_of_paging_tai; k++) {
+            if (memcmp(&enb->paging_tai[k], &enb->supported_ta_list[i],
+                        sizeof(ogs_eps_tai_t)) == 0)
+                break;
+        }
+        if (k < enb->num_of_paging_tai)
+            continue;
+
+        paging_area_add(enb, &enb->supported_ta_list[i]);
+        memcpy(&enb->paging_tai[enb->num_of_paging_tai++],
+                &enb->supported_ta_list[i], sizeof(ogs_eps_tai_t));
+    }
+}
+
+mme_paging_area_t *mme_paging_area_find(ogs_eps_tai_t *tai)
+{
+    ogs_assert(tai);
+    return (mme_paging_area_t *)ogs_hash_get(
+            self.paging_area_hash, tai, sizeof(*tai));
+}
+
+/*
+ * eNB UEs are indexed by ENB-UE-S1AP-ID in the hash of their eNB.
+ * The key points into the enb_ue itself, so the ID must only be
+ * changed with enb_ue_set_enb_ue_s1ap_id(). A target UE waiting for
+ * its ID during handover (INVALID_UE_S1AP_ID) is not indexed.
+ *
+ * A UE that claims an ID already in use is chained behind the first
+ * one, which keeps the entry until it is removed. The lookup returns
+ * the first UE, as the list lookup did.
+ */
+static void enb_ue_hash_add(enb_ue_t *enb_ue)
+{
+    enb_ue_t *iter = NULL;
+
+    ogs_assert(enb_ue);
+    ogs_assert(enb_ue->enb);
+
+    enb_ue->duplicate = NULL;
+
+    if (enb_ue->enb_ue_s1ap_id == INVALID_UE_S1AP_ID)
+        return;
+
+    iter = ogs_hash_get(enb_ue->enb->enb_ue_hash, &enb_ue->enb_ue_s1ap_id,
+            sizeof(enb_ue->enb_ue_s1ap_id));
+    if (!iter) {
+        ogs_hash_set(enb_ue->enb->enb_ue_hash, &enb_ue->enb_ue_s1ap_id,
+                sizeof(enb_ue->enb_ue_s1ap_id), enb_ue);
+        return;
+    }
+
+    /* The first UE keeps the ID, the others queue up behind it */
+    while (iter->duplicate)
+        iter = iter->duplicate;
+    iter->duplicate = enb_ue;
+}
+
+static void enb_ue_hash_remove(enb_ue_t *enb_ue)
+{
+    enb_ue_t *iter = NULL;
+
+    ogs_assert(enb_ue);
+    ogs_assert(enb_ue->enb);
+
+    if (enb_ue->enb_ue_s1ap_id == INVALID_UE_S1AP_ID)
+        return;
+
+    /* The eNB has been removed while the UE was waiting for the SGW-C */
+    if (!enb_ue->enb->enb_ue_hash)
+        return;
+
+    iter = ogs_hash_get(enb_ue->enb->enb_ue_hash, &enb_ue->enb_ue_s1ap_id,
+            sizeof(enb_ue->enb_ue_s1ap_id));
+    if (iter == enb_ue) {
+        /*
+         * An entry keeps the key pointer it was created with.
+         * Drop it before the next UE with the same ID takes over.
+         */
+        ogs_hash_set(enb_ue->enb->enb_ue_hash, &enb_ue->enb_ue_s1ap_id,
+                sizeof(enb_ue->enb_ue_s1ap_id), NULL);
+        if (enb_ue->duplicate)
+            ogs_hash_set(enb_ue->enb->enb_ue_hash,
+                    &enb_ue->duplicate->enb_ue_s1ap_id,
+                    sizeof(enb_ue->enb_ue_s1ap_id), enb_ue->duplicate);
+    } else {
+        for (; iter; iter = iter->duplicate) {
+            if (iter->duplicate == enb_ue) {
+                iter->duplicate = enb_ue->duplicate;
+                break;
+            }
+        }
+    }
+
+    enb_ue->duplicate = NULL;
+}
+
 /** enb_ue_context handling function */
 enb_ue_t *enb_ue_add(mme_enb_t *enb, uint32_t enb_ue_s1ap_id)
 {
@@ -2692,6 +2882,7 @@ enb_ue_t *enb_ue_add(mme_enb_t *enb, uint32_t enb_ue_s1ap_id)
     enb_ue->enb = enb;
 
     ogs_list_add(&enb->enb_ue_list, enb_ue);
+    enb_ue_hash_add(enb_ue);
 
     stats_add_enb_ue();
 
@@ -2706,6 +2897,7 @@ void enb_ue_remove(enb_ue_t *enb_ue)
     enb = enb_ue->enb;
     ogs_assert(enb);
 
+    enb_ue_hash_remove(enb_ue);
     ogs_list_remove(&enb->enb_ue_list, enb_ue);
 
     ogs_assert(enb_ue->t_s1_holding);
@@ -2723,6 +2915,7 @@ void enb_ue_switch_to_enb(enb_ue_t *enb_ue, mme_enb_t *new_enb)
     ogs_assert(new_enb);
 
     /* Remove from the old enb */
+    enb_ue_hash_remove(enb_ue);
     ogs_list_remove(&enb_ue->enb->enb_ue_list, enb_ue);
 
     /* Add to the new enb */
@@ -2730,19 +2923,26 @@ void enb_ue_switch_to_enb(enb_ue_t *enb_ue, mme_enb_t *new_enb)
 
     /* Switch to enb */
     enb_ue->enb = new_enb;
+    enb_ue_hash_add(enb_ue);
+}
+
+void enb_ue_set_enb_ue_s1ap_id(enb_ue_t *enb_ue, uint32_t enb_ue_s1ap_id)
+{
+    ogs_assert(enb_ue);
+    ogs_assert(enb_ue->enb);
+
+    enb_ue_hash_remove(enb_ue);
+    enb_ue->enb_ue_s1ap_id = enb_ue_s1ap_id;
+    enb_ue_hash_add(enb_ue);
 }
 
 enb_ue_t *enb_ue_find_by_enb_ue_s1ap_id(
         mme_enb_t *enb, uint32_t enb_ue_s1ap_id)
 {
-    enb_ue_t *enb_ue = NULL;
-
-    ogs_list_for_each(&enb->enb_ue_list, enb_ue) {
-        if (enb_ue_s1ap_id == enb_ue->enb_ue_s1ap_id)
-            break;
-    }
+    ogs_assert(enb);
 
-    return enb_ue;
+    return (enb_ue_t *)ogs_hash_get(enb->enb_ue_hash,
+            &enb_ue_s1ap_id, sizeof(enb_ue_s1ap_id));
 }
 
 enb_ue_t *enb_ue_find(uint32_t index)
@@ -192,6 +192,7 @@ typedef struct mme_context_s {
     ogs_hash_t *enb_id_hash;    /* hash table for ENB-ID */
     ogs_hash_t *imsi_ue_hash;   /* hash table (IMSI : MME_UE) */
     ogs_hash_t *guti_ue_hash;   /* hash table (GUTI : MME_UE) */
+    ogs_hash_t *paging_area_hash;   /* hash table (TAI : PAGING_AREA) */
 
     ogs_hash_t *mme_s11_teid_hash;  /* hash table (MME-S11-TEID : MME_UE) */
 
@@ -293,9 +294,30 @@ typedef struct mme_enb_s {
     ogs_pkbuf_t     *s1_reset_ack; /* Reset message */
 
     ogs_list_t      enb_ue_list;
+    ogs_hash_t      *enb_ue_hash;   /* hash table (ENB-UE-S1AP-ID : ENB_UE) */
+
+    /* TAIs under which this eNB is in mme_self()->paging_area_hash */
+#define MAX_NUM_OF_PAGING_TAI (OGS_MAX_NUM_OF_TAI * OGS_MAX_NUM_OF_BPLMN)
+    int             num_of_paging_tai;
+    ogs_eps_tai_t   paging_tai[MAX_NUM_OF_PAGING_TAI];
 
 } mme_enb_t;
 
+/*
+ * The eNBs supporting a TAI, so that Paging does not have to scan
+ * the Supported TAs of every eNB. It is rebuilt from the list by
+ * mme_enb_update_paging_area() on S1 Setup.
+ */
+typedef struct mme_paging_area_s {
+    ogs_eps_tai_t   tai;        /* hash key */
+    ogs_list_t      enb_list;   /* list of mme_paging_enb_t */
+} mme_paging_area_t;
+
+typedef struct mme_paging_enb_s {
+    ogs_lnode_t     lnode;
+    mme_enb_t       *enb;
+} mme_paging_enb_t;
+
 struct enb_ue_s {
     ogs_lnode_t     lnode;
     uint32_t        index;
@@ -304,6 +326,7 @@ struct enb_ue_s {
 #define INVALID_UE_S1AP_ID      0xffffffff /* Initial value of enb_ue_s1ap_id */
     uint32_t        enb_ue_s1ap_id; /* eNB-UE-S1AP-ID received from eNB */
     uint32_t        mme_ue_s1ap_id; /* MME-UE-S1AP-ID received from MME */
+    enb_ue_t        *duplicate;     /* Next UE with the same ENB-UE-S1AP-ID */
 
     uint16_t        enb_ostream_id; /* SCTP output stream id for eNB */
 
@@ -870,9 +893,13 @@ int mme_enb_set_enb_id(mme_enb_t *enb, uint32_t enb_id);
 int mme_enb_sock_type(ogs_sock_t *sock);
 mme_enb_t *mme_enb_cycle(mme_enb_t *enb);
 
+void mme_enb_update_paging_area(mme_enb_t *enb);
+mme_paging_area_t *mme_paging_area_find(ogs_eps_tai_t *tai);
+
 enb_ue_t *enb_ue_add(mme_enb_t *enb, uint32_t enb_ue_s1ap_id);
 void enb_ue_remove(enb_ue_t *enb_ue);
 void enb_ue_switch_to_enb(enb_ue_t *enb_ue, mme_enb_t *new_enb);
+void enb_ue_set_enb_ue_s1ap_id(enb_ue_t *enb_ue, uint32_t enb_ue_s1ap_id);
 enb_ue_t *enb_ue_find_by_enb_ue_s1ap_id(
         mme_enb_t *enb, uint32_t enb_ue_s1ap_id);
 enb_ue_t *enb_ue_find(uint32_t index);
@@ -408,8 +408,8 @@ int s1ap_send_ue_context_release_command(
 int s1ap_send_paging(mme_ue_t *mme_ue, S1AP_CNDomain_t cn_domain)
 {
     ogs_pkbuf_t *s1apbuf = NULL;
-    mme_enb_t *enb = NULL;
-    int i;
+    mme_paging_area_t *area = NULL;
+    mme_paging_enb_t *node = NULL;
     int rv;
 
     ogs_debug("S1-Paging");
@@ -420,34 +420,28 @@ int s1ap_send_paging(mme_ue_t *mme_ue, S1AP_CNDomain_t cn_domain)
     }
 
     /* Find enB with matched TAI */
-    ogs_list_for_each(&mme_self()->enb_list, enb) {
-        for (i = 0; i < enb->num_of_supported_ta_list; i++) {
-
-            if (memcmp(&enb->supported_ta_list[i], &mme_ue->tai,
-                        sizeof(ogs_eps_tai_t)) == 0) {
-
-                if (mme_ue->t3413.pkbuf) {
-                    s1apbuf = mme_ue->t3413.pkbuf;
-                } else {
-                    s1apbuf = s1ap_build_paging(mme_ue, cn_domain);
-                    if (!s1apbuf) {
-                        ogs_error("s1ap_build_paging() failed");
-                        return OGS_ERROR;
-                    }
-                }
-
-                mme_ue->t3413.pkbuf = ogs_pkbuf_copy(s1apbuf);
-                if (!mme_ue->t3413.pkbuf) {
-                    ogs_error("ogs_pkbuf_copy() failed");
-                    ogs_pkbuf_free(s1apbuf);
-                    return OGS_ERROR;
-                }
-
-                rv = s1ap_send_to_enb(enb, s1apbuf, S1AP_NON_UE_SIGNALLING);
-                if (rv != OGS_OK) {
-                    ogs_error("s1ap_send_to_enb() failed");
-                    return rv;
-                }
+    area = mme_paging_area_find(&mme_ue->tai);
+    if (area) {
+        if (!mme_ue->t3413.pkbuf) {
+            mme_ue->t3413.pkbuf = s1ap_build_paging(mme_ue, cn_domain);
+            if (!mme_ue->t3413.pkbuf) {
+                ogs_error("s1ap_build_paging() failed");
+                return OGS_ERROR;
+            }
+        }
+
+        /* Every eNB is sent a clone of the message encoded only once */
+        ogs_list_for_each(&area->enb_list, node) {
+            s1apbuf = ogs_pkbuf_clone(mme_ue->t3413.pkbuf);
+            if (!s1apbuf) {
+                ogs_error("ogs_pkbuf_clone() failed");
+                return OGS_ERROR;
+            }
+
+            rv = s1ap_send_to_enb(node->enb, s1apbuf, S1AP_NON_UE_SIGNALLING);
+            if (rv != OGS_OK) {
+                ogs_error("s1ap_send_to_enb() failed");
+                return rv;
             }
         }
     }
@@ -36,6 +36,8 @@ typedef struct nrf_event_s {
     ogs_sbi_subscription_data_t *subscription_data;
 } nrf_event_t;
 
+OGS_STATIC_ASSERT(OGS_EVENT_SIZE >= sizeof(nrf_event_t));
+
 nrf_event_t *nrf_event_new(int id);
 
 const char *nrf_event_get_name(nrf_event_t *e);
@@ -20,41 +20,25 @@
 #include "event.h"
 #include "context.h"
 
-static OGS_POOL(pool, sgwc_event_t);
-
-void sgwc_event_init(void)
-{
-    ogs_pool_init(&pool, ogs_app()->pool.event);
-}
-
 void sgwc_event_term(void)
 {
     ogs_queue_term(ogs_app()->queue);
     ogs_pollset_notify(ogs_app()->pollset);
 }
 
-void sgwc_event_final(void)
-{
-    ogs_pool_final(&pool);
-}
-
 sgwc_event_t *sgwc_event_new(sgwc_event_e id)
 {
     sgwc_event_t *e = NULL;
 
-    ogs_pool_alloc(&pool, &e);
+    e = ogs_event_size(id, sizeof(*e));
     ogs_assert(e);
-    memset(e, 0, sizeof(*e));
-
-    e->id = id;
 
     return e;
 }
 
 void sgwc_event_free(sgwc_event_t *e)
 {
-    ogs_assert(e);
-    ogs_pool_free(&pool, e);
+    ogs_event_free(e);
 }
 
 const char *sgwc_event_get_name(sgwc_event_t *e)
@@ -65,9 +65,7 @@ typedef struct sgwc_event_s {
 
 OGS_STATIC_ASSERT(OGS_EVENT_SIZE >= sizeof(sgwc_event_t));
 
-void sgwc_event_init(void);
 void sgwc_event_term(void);
-void sgwc_event_final(void);
 
 sgwc_event_t *sgwc_event_new(sgwc_event_e id);
 void sgwc_event_free(sgwc_event_t *e);
@@ -35,7 +35,6 @@ int sgwc_initialize(void)
     ogs_pfcp_context_init();
 
     sgwc_context_init();
-    sgwc_event_init();
 
     rv = ogs_gtp_xact_init();
     if (rv != OGS_OK) return rv;
@@ -88,8 +87,6 @@ void sgwc_terminate(void)
 
     ogs_pfcp_xact_final();
     ogs_gtp_xact_final();
-
-    sgwc_event_final();
 }
 
 static void sgwc_main(void *data)
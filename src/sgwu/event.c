@@ -20,41 +20,25 @@
 #include "event.h"
 #include "context.h"
 
-static OGS_POOL(pool, sgwu_event_t);
-
-void sgwu_event_init(void)
-{
-    ogs_pool_init(&pool, ogs_app()->pool.event);
-}
-
 void sgwu_event_term(void)
 {
     ogs_queue_term(ogs_app()->queue);
     ogs_pollset_notify(ogs_app()->pollset);
 }
 
-void sgwu_event_final(void)
-{
-    ogs_pool_final(&pool);
-}
-
 sgwu_event_t *sgwu_event_new(sgwu_event_e id)
 {
     sgwu_event_t *e = NULL;
 
-    ogs_pool_alloc(&pool, &e);
+    e = ogs_event_size(id, sizeof(*e));
     ogs_assert(e);
-    memset(e, 0, sizeof(*e));
-
-    e->id = id;
 
     return e;
 }
 
 void sgwu_event_free(sgwu_event_t *e)
 {
-    ogs_assert(e);
-    ogs_pool_free(&pool, e);
+    ogs_event_free(e);
 }
 
 const char *sgwu_event_get_name(sgwu_event_t *e)
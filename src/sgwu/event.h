@@ -60,9 +60,7 @@ typedef struct sgwu_event_s {
 
 OGS_STATIC_ASSERT(OGS_EVENT_SIZE >= sizeof(sgwu_event_t));
 
-void sgwu_event_init(void);
 void sgwu_event_term(void);
-void sgwu_event_final(void);
 
 sgwu_event_t *sgwu_event_new(sgwu_event_e id);
 void sgwu_event_free(sgwu_event_t *e);
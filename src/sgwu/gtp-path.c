@@ -139,7 +139,6 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     if (gtp_h->type == OGS_GTPU_MSGTYPE_END_MARKER) {
         ogs_pfcp_object_t *pfcp_object = NULL;
         ogs_pfcp_pdr_t *pdr = NULL;
-        ogs_pkbuf_t *sendbuf = NULL;
 
         pfcp_object = ogs_pfcp_object_find_by_teid(teid);
         if (!pfcp_object) {
@@ -179,11 +178,9 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
 
         ogs_assert(pdr);
 
-        sendbuf = ogs_pkbuf_copy(pkbuf);
-        ogs_assert(sendbuf);
-
-        /* Forward packet */
-        ogs_pfcp_send_g_pdu(pdr, gtp_h->type, sendbuf);
+        /* Forward packet in place */
+        ogs_pfcp_send_g_pdu(pdr, gtp_h->type, pkbuf);
+        pkbuf = NULL;
 
     } else if (gtp_h->type == OGS_GTPU_MSGTYPE_ERR_IND) {
         ogs_pfcp_far_t *far = NULL;
@@ -280,8 +277,9 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
         }
 
         ogs_assert(pdr);
-        ogs_assert(true == ogs_pfcp_up_handle_pdr(
+        ogs_assert(true == ogs_pfcp_up_handle_pdr_nocopy(
                                 pdr, gtp_h->type, pkbuf, &report));
+        pkbuf = NULL;
 
         if (report.type.downlink_data_report) {
             ogs_assert(pdr->sess);
@@ -301,7 +299,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     }
 
 cleanup:
-    ogs_pkbuf_free(pkbuf);
+    if (pkbuf)
+        ogs_pkbuf_free(pkbuf);
 }
 
 int sgwu_gtp_init(void)
@@ -312,10 +311,8 @@ int sgwu_gtp_init(void)
     config.cluster_2048_pool = ogs_app()->pool.packet;
 
 #if OGS_USE_TALLOC == 1
-    /* allocate a talloc pool for GTP to ensure it doesn't have to go back
-     * to the libc malloc all the time */
-    packet_pool = talloc_pool(__ogs_talloc_core, 1000*1024);
-    ogs_assert(packet_pool);
+    /* No talloc parent : see the per-thread magazines of ogs-pkbuf.c */
+    packet_pool = NULL;
 #else
     packet_pool = ogs_pkbuf_pool_create(&config);
 #endif
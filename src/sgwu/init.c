@@ -34,7 +34,6 @@ int sgwu_initialize(void)
     ogs_pfcp_context_init();
 
     sgwu_context_init();
-    sgwu_event_init();
     sgwu_gtp_init();
 
     rv = ogs_pfcp_xact_init();
@@ -86,7 +85,6 @@ void sgwu_terminate(void)
     ogs_pfcp_xact_final();
 
     sgwu_gtp_final();
-    sgwu_event_final();
 }
 
 static void sgwu_main(void *data)
@@ -19,6 +19,8 @@
 
 #include "context.h"
 #include "pfcp-path.h"
+#include "worker.h"
+#include "xdp-path.h"
 
 static upf_context_t self;
 
@@ -59,23 +61,18 @@ void upf_context_init(void)
     ogs_assert(self.smf_n4_seid_hash);
     self.smf_n4_f_seid_hash = ogs_hash_make();
     ogs_assert(self.smf_n4_f_seid_hash);
-    self.ipv4_hash = ogs_hash_make();
-    ogs_assert(self.ipv4_hash);
-    self.ipv6_hash = ogs_hash_make();
-    ogs_assert(self.ipv6_hash);
+    self.ipv4_map = ogs_ipmap_create(ogs_app()->pool.sess);
+    ogs_assert(self.ipv4_map);
+    self.ipv6_map = ogs_ipmap_create(ogs_app()->pool.sess);
+    ogs_assert(self.ipv6_map);
+    self.ipv4_framed_routes = upf_lpm_create(AF_INET);
+    ogs_assert(self.ipv4_framed_routes);
+    self.ipv6_framed_routes = upf_lpm_create(AF_INET6);
+    ogs_assert(self.ipv6_framed_routes);
 
     context_initialized = 1;
 }
 
-static void free_upf_route_trie_node(struct upf_route_trie_node *node)
-{
-    if (!node)
-        return;
-    free_upf_route_trie_node(node->left);
-    free_upf_route_trie_node(node->right);
-    ogs_free(node);
-}
-
 void upf_context_final(void)
 {
     ogs_assert(context_initialized == 1);
@@ -88,13 +85,15 @@ void upf_context_final(void)
     ogs_hash_destroy(self.smf_n4_seid_hash);
     ogs_assert(self.smf_n4_f_seid_hash);
     ogs_hash_destroy(self.smf_n4_f_seid_hash);
-    ogs_assert(self.ipv4_hash);
-    ogs_hash_destroy(self.ipv4_hash);
-    ogs_assert(self.ipv6_hash);
-    ogs_hash_destroy(self.ipv6_hash);
+    ogs_assert(self.ipv4_map);
+    ogs_ipmap_destroy(self.ipv4_map);
+    ogs_assert(self.ipv6_map);
+    ogs_ipmap_destroy(self.ipv6_map);
 
-    free_upf_route_trie_node(self.ipv4_framed_routes);
-    free_upf_route_trie_node(self.ipv6_framed_routes);
+    ogs_assert(self.ipv4_framed_routes);
+    upf_lpm_destroy(self.ipv4_framed_routes);
+    ogs_assert(self.ipv6_framed_routes);
+    upf_lpm_destroy(self.ipv6_framed_routes);
 
     ogs_pool_final(&upf_sess_pool);
     ogs_pool_final(&upf_n4_seid_pool);
@@ -109,11 +108,41 @@ upf_context_t *upf_self(void)
 
 static int upf_context_prepare(void)
 {
+    self.gtpu_burst = 1;
+    self.urr_check_bytes = UPF_DEFAULT_URR_CHECK_BYTES;
+    self.xdp.num_of_queue = 1;
+
     return OGS_OK;
 }
 
 static int upf_context_validation(void)
 {
+    if (self.num_of_worker < 0 ||
+        self.num_of_worker > UPF_MAX_NUM_OF_WORKER) {
+        ogs_error("Invalid upf.worker [%d] in '%s' (0..%d)",
+                self.num_of_worker, ogs_app()->file, UPF_MAX_NUM_OF_WORKER);
+        return OGS_ERROR;
+    }
+    if (self.gtpu_burst < 1 ||
+        self.gtpu_burst > OGS_MAX_NUM_OF_SOCKMSG) {
+        ogs_error("Invalid upf.gtpu_burst [%d] in '%s' (1..%d)",
+                self.gtpu_burst, ogs_app()->file, OGS_MAX_NUM_OF_SOCKMSG);
+        return OGS_ERROR;
+    }
+    if (self.urr_check_bytes < 1 ||
+        self.urr_check_bytes > UPF_MAX_URR_CHECK_BYTES) {
+        ogs_error("Invalid upf.urr_check_bytes [%lld] in '%s' (1..%d)",
+                (long long)self.urr_check_bytes, ogs_app()->file,
+                UPF_MAX_URR_CHECK_BYTES);
+        return OGS_ERROR;
+    }
+    if (self.xdp.num_of_queue < 1 ||
+        self.xdp.num_of_queue > UPF_MAX_NUM_OF_XDP_QUEUE) {
+        ogs_error("Invalid upf.xdp.queue [%d] in '%s' (1..%d)",
+                self.xdp.num_of_queue, ogs_app()->file,
+                UPF_MAX_NUM_OF_XDP_QUEUE);
+        return OGS_ERROR;
+    }
     if (ogs_list_first(&ogs_gtp_self()->gtpu_list) == NULL) {
         ogs_error("No upf.gtpu in '%s'", ogs_app()->file);
         return OGS_ERROR;
@@ -153,8 +182,61 @@ int upf_context_parse_config(void)
                     /* handle config in pfcp library */
                 } else if (!strcmp(upf_key, "subnet")) {
                     /* handle config in pfcp library */
+                } else if (!strcmp(upf_key, "buffer")) {
+                    /* handle config in pfcp library */
                 } else if (!strcmp(upf_key, "metrics")) {
                     /* handle config in metrics library */
+                } else if (!strcmp(upf_key, "gtpu_burst")) {
+                    const char *v = ogs_yaml_iter_value(&upf_iter);
+                    if (v) self.gtpu_burst = atoi(v);
+                } else if (!strcmp(upf_key, "urr_check_bytes")) {
+                    const char *v = ogs_yaml_iter_value(&upf_iter);
+                    if (v) self.urr_check_bytes = atoll(v);
+                } else if (!strcmp(upf_key, "worker")) {
+                    const char *v = ogs_yaml_iter_value(&upf_iter);
+                    if (v) self.num_of_worker = atoi(v);
+                } else if (!strcmp(upf_key, "hairpin")) {
+                    ogs_yaml_iter_t dnn_iter;
+                    ogs_yaml_iter_recurse(&upf_iter, &dnn_iter);
+                    ogs_assert(ogs_yaml_iter_type(&dnn_iter) !=
+                        YAML_MAPPING_NODE);
+
+                    do {
+                        const char *v = NULL;
+
+                        if (ogs_yaml_iter_type(&dnn_iter) ==
+                                YAML_SEQUENCE_NODE) {
+                            if (!ogs_yaml_iter_next(&dnn_iter))
+                                break;
+                        }
+
+                        v = ogs_yaml_iter_value(&dnn_iter);
+                        if (v) {
+                            ogs_assert(self.hairpin.num_of_dnn <
+                                    OGS_MAX_NUM_OF_DNN);
+                            ogs_cpystrn(self.hairpin.dnn[
+                                    self.hairpin.num_of_dnn], v,
+                                    sizeof(self.hairpin.dnn[0]));
+                            self.hairpin.num_of_dnn++;
+                        }
+                    } while (ogs_yaml_iter_type(&dnn_iter) ==
+                            YAML_SEQUENCE_NODE);
+                } else if (!strcmp(upf_key, "xdp")) {
+                    ogs_yaml_iter_t xdp_iter;
+                    ogs_yaml_iter_recurse(&upf_iter, &xdp_iter);
+                    while (ogs_yaml_iter_next(&xdp_iter)) {
+                        const char *xdp_key = ogs_yaml_iter_key(&xdp_iter);
+                        ogs_assert(xdp_key);
+                        if (!strcmp(xdp_key, "dev")) {
+                            const char *v = ogs_yaml_iter_value(&xdp_iter);
+                            if (v) ogs_cpystrn(self.xdp.dev, v,
+                                    sizeof(self.xdp.dev));
+                        } else if (!strcmp(xdp_key, "queue")) {
+                            const char *v = ogs_yaml_iter_value(&xdp_iter);
+                            if (v) self.xdp.num_of_queue = atoi(v);
+                        } else
+                            ogs_warn("unknown key `%s`", xdp_key);
+                    }
                 } else
                     ogs_warn("unknown key `%s`", upf_key);
             }
@@ -213,6 +295,8 @@ int upf_sess_remove(upf_sess_t *sess)
 {
     ogs_assert(sess);
 
+    upf_worker_barrier_sync();
+
     upf_sess_urr_acc_remove_all(sess);
 
     ogs_list_remove(&self.sess_list, sess);
@@ -227,12 +311,13 @@ int upf_sess_remove(upf_sess_t *sess)
             sizeof(sess->smf_n4_f_seid), NULL);
 
     if (sess->ipv4) {
-        ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, NULL);
+        ogs_ipmap_set(self.ipv4_map,
+                ogs_ipmap_key_ipv4(sess->ipv4->addr[0]), NULL);
         ogs_pfcp_ue_ip_free(sess->ipv4);
     }
     if (sess->ipv6) {
-        ogs_hash_set(self.ipv6_hash,
-                sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, NULL);
+        ogs_ipmap_set(self.ipv6_map,
+                ogs_ipmap_key_ipv6(sess->ipv6->addr), NULL);
         ogs_pfcp_ue_ip_free(sess->ipv6);
     }
 
@@ -289,65 +374,41 @@ upf_sess_t *upf_sess_find_by_upf_n4_seid(uint64_t seid)
 upf_sess_t *upf_sess_find_by_ipv4(uint32_t addr)
 {
     upf_sess_t *ret;
-    struct upf_route_trie_node *trie = self.ipv4_framed_routes;
-    const int nbits = sizeof(addr) << 3;
-    int i;
 
-    ogs_assert(self.ipv4_hash);
+    ogs_assert(self.ipv4_map);
 
-    ret = ogs_hash_get(self.ipv4_hash, &addr, OGS_IPV4_LEN);
+    ret = ogs_ipmap_get(self.ipv4_map, ogs_ipmap_key_ipv4(addr));
     if (ret)
         return ret;
 
-    for (i =  0; i <= nbits; i++) {
-        int bit = nbits - i - 1;
-
-        if (!trie)
-            break;
-        if (trie->sess)
-            ret = trie->sess;
-        if (i == nbits)
-            break;
-
-        if ((1 << bit) & be32toh(addr))
-            trie = trie->right;
-        else
-            trie = trie->left;
-    }
-    return ret;
+    return upf_lpm_find(self.ipv4_framed_routes, &addr);
 }
 
 upf_sess_t *upf_sess_find_by_ipv6(uint32_t *addr6)
 {
     upf_sess_t *ret = NULL;
-    struct upf_route_trie_node *trie = self.ipv6_framed_routes;
-    int i;
-    const int chunk_size = sizeof(*addr6) << 3;
 
-    ogs_assert(self.ipv6_hash);
+    ogs_assert(self.ipv6_map);
     ogs_assert(addr6);
-    ret = ogs_hash_get(
-            self.ipv6_hash, addr6, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3);
+    ret = ogs_ipmap_get(self.ipv6_map, ogs_ipmap_key_ipv6(addr6));
     if (ret)
         return ret;
 
-    for (i = 0; i <= OGS_IPV6_128_PREFIX_LEN; i++) {
-        int part = i / chunk_size;
-        int bit = (OGS_IPV6_128_PREFIX_LEN - i - 1) % chunk_size;
+    return upf_lpm_find(self.ipv6_framed_routes, addr6);
+}
 
-        if (!trie)
-            break;
-        if (trie->sess)
-            ret = trie->sess;
-        if (i == OGS_IPV6_128_PREFIX_LEN)
-            break;
+/* Called for a burst of packets before upf_sess_find_by_ipv4/ipv6() */
+void upf_sess_prefetch_by_ipv4(uint32_t addr)
+{
+    ogs_assert(self.ipv4_map);
+    ogs_ipmap_prefetch(self.ipv4_map, ogs_ipmap_key_ipv4(addr));
+}
 
-        if ((1 << bit) & be32toh(addr6[part]))
-            trie = trie->right;
-        else
-            trie = trie->left;
-    }
-    return ret;
+void upf_sess_prefetch_by_ipv6(uint32_t *addr6)
+{
+    ogs_assert(self.ipv6_map);
+    ogs_assert(addr6);
+    ogs_ipmap_prefetch(self.ipv6_map, ogs_ipmap_key_ipv6(addr6));
 }
 
 upf_sess_t *upf_sess_add_by_message(ogs_pfcp_message_t *message)
@@ -395,13 +456,13 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
     ogs_assert(ue_ip);
 
     if (sess->ipv4) {
-        ogs_hash_set(self.ipv4_hash,
-                sess->ipv4->addr, OGS_IPV4_LEN, NULL);
+        ogs_ipmap_set(self.ipv4_map,
+                ogs_ipmap_key_ipv4(sess->ipv4->addr[0]), NULL);
         ogs_pfcp_ue_ip_free(sess->ipv4);
     }
     if (sess->ipv6) {
-        ogs_hash_set(self.ipv6_hash,
-                sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, NULL);
+        ogs_ipmap_set(self.ipv6_map,
+                ogs_ipmap_key_ipv6(sess->ipv6->addr), NULL);
         ogs_pfcp_ue_ip_free(sess->ipv6);
     }
 
@@ -415,7 +476,8 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 return cause_value;
             }
-            ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, sess);
+            ogs_ipmap_set(self.ipv4_map,
+                    ogs_ipmap_key_ipv4(sess->ipv4->addr[0]), sess);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -430,8 +492,8 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 return cause_value;
             }
-            ogs_hash_set(self.ipv6_hash, sess->ipv6->addr,
-                    OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, sess);
+            ogs_ipmap_set(self.ipv6_map,
+                    ogs_ipmap_key_ipv6(sess->ipv6->addr), sess);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -446,7 +508,8 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 return cause_value;
             }
-            ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, sess);
+            ogs_ipmap_set(self.ipv4_map,
+                    ogs_ipmap_key_ipv4(sess->ipv4->addr[0]), sess);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -460,15 +523,15 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_error("ogs_pfcp_ue_ip_alloc() failed[%d]", cause_value);
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 if (sess->ipv4) {
-                    ogs_hash_set(self.ipv4_hash,
-                            sess->ipv4->addr, OGS_IPV4_LEN, NULL);
+                    ogs_ipmap_set(self.ipv4_map,
+                            ogs_ipmap_key_ipv4(sess->ipv4->addr[0]), NULL);
                     ogs_pfcp_ue_ip_free(sess->ipv4);
                     sess->ipv4 = NULL;
                 }
                 return cause_value;
             }
-            ogs_hash_set(self.ipv6_hash, sess->ipv6->addr,
-                    OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, sess);
+            ogs_ipmap_set(self.ipv6_map,
+                    ogs_ipmap_key_ipv6(sess->ipv6->addr), sess);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -490,85 +553,6 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
     return cause_value;
 }
 
-/* Remove amd free framed ROUTE from TRIE. It isn't an error if the framed
-   route doesn't exist in TRIE. */
-static void free_framed_route_from_trie(ogs_ipsubnet_t *route)
-{
-    const int chunk_size = sizeof(route->sub[0]) << 3;
-    const int is_ipv4 = route->family == AF_INET;
-    const int nbits = is_ipv4 ? chunk_size : OGS_IPV6_128_PREFIX_LEN;
-    struct upf_route_trie_node **trie =
-        is_ipv4 ? &self.ipv4_framed_routes : &self.ipv6_framed_routes;
-
-    struct upf_route_trie_node **to_free_tries[OGS_IPV6_128_PREFIX_LEN + 1];
-    int free_from = 0;
-    int i = 0;
-
-    for (i = 0; i <= nbits; i++) {
-        int part = i / chunk_size;
-        int bit = (nbits - i - 1) % chunk_size;
-
-        if (!*trie)
-            break;
-        to_free_tries[i] = trie;
-
-        if (i == nbits ||
-            ((1 << bit) & be32toh(route->mask[part])) == 0) {
-            (*trie)->sess = NULL;
-            if ((*trie)->left || (*trie)->right)
-                free_from = i + 1;
-            i++;
-            break;
-        }
-
-        if ((1 << bit) & be32toh(route->sub[part])) {
-            if ((*trie)->left || (*trie)->sess)
-                free_from = i + 1;
-            trie = &(*trie)->right;
-        } else {
-            if ((*trie)->right || (*trie)->sess)
-                free_from = i + 1;
-            trie = &(*trie)->left;
-        }
-    }
-
-    for (i = i - 1; i >= free_from; i--) {
-        trie = to_free_tries[i];
-        ogs_free(*trie);
-        *trie = NULL;
-    }
-}
-
-static void add_framed_route_to_trie(ogs_ipsubnet_t *route, upf_sess_t *sess)
-{
-    const int chunk_size = sizeof(route->sub[0]) << 3;
-    const int is_ipv4 = route->family == AF_INET;
-    const int nbits = is_ipv4 ? chunk_size : OGS_IPV6_128_PREFIX_LEN;
-    struct upf_route_trie_node **trie =
-        is_ipv4 ? &self.ipv4_framed_routes : &self.ipv6_framed_routes;
-    int i = 0;
-
-    for (i = 0; i <= nbits; i++) {
-        int part = i / chunk_size;
-        int bit = (nbits - i - 1) % chunk_size;
-
-        if (!*trie)
-            *trie = ogs_calloc(1, sizeof(**trie));
-
-        if (i == nbits ||
-            ((1 << bit) & be32toh(route->mask[part])) == 0) {
-            (*trie)->sess = sess;
-            break;
-        }
-
-        if ((1 << bit) & be32toh(route->sub[part])) {
-            trie = &(*trie)->right;
-        } else {
-            trie = &(*trie)->left;
-        }
-    }
-}
-
 static int parse_framed_route(ogs_ipsubnet_t *subnet, const char *framed_route)
 {
     char *mask = ogs_strdup(framed_route);
@@ -591,7 +575,8 @@ uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
     for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
         if (!sess->ipv4_framed_routes || !sess->ipv4_framed_routes[i].family)
             break;
-        free_framed_route_from_trie(&sess->ipv4_framed_routes[i]);
+        upf_lpm_remove(self.ipv4_framed_routes,
+                &sess->ipv4_framed_routes[i], sess);
         memset(&sess->ipv4_framed_routes[i], 0,
                sizeof(sess->ipv4_framed_routes[i]));
     }
@@ -607,6 +592,9 @@ uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
         }
 
         rv = parse_framed_route(&sess->ipv4_framed_routes[j], framed_routes[i]);
+        if (rv == OGS_OK)
+            rv = upf_lpm_add(self.ipv4_framed_routes,
+                    &sess->ipv4_framed_routes[j], sess);
 
         if (rv != OGS_OK) {
             ogs_warn("Ignoring invalid framed route %s", framed_routes[i]);
@@ -614,7 +602,6 @@ uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
                    sizeof(sess->ipv4_framed_routes[j]));
             continue;
         }
-        add_framed_route_to_trie(&sess->ipv4_framed_routes[j], sess);
         j++;
     }
     if (j == 0 && sess->ipv4_framed_routes) {
@@ -636,7 +623,10 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
     for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
         if (!sess->ipv6_framed_routes || !sess->ipv6_framed_routes[i].family)
             break;
-        free_framed_route_from_trie(&sess->ipv6_framed_routes[i]);
+        upf_lpm_remove(self.ipv6_framed_routes,
+                &sess->ipv6_framed_routes[i], sess);
+        memset(&sess->ipv6_framed_routes[i], 0,
+               sizeof(sess->ipv6_framed_routes[i]));
     }
 
     for (i = 0, j = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
@@ -650,6 +640,9 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
         }
 
         rv = parse_framed_route(&sess->ipv6_framed_routes[j], framed_routes[i]);
+        if (rv == OGS_OK)
+            rv = upf_lpm_add(self.ipv6_framed_routes,
+                    &sess->ipv6_framed_routes[j], sess);
 
         if (rv != OGS_OK) {
             ogs_warn("Ignoring invalid framed route %s", framed_routes[i]);
@@ -657,7 +650,6 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
                    sizeof(sess->ipv6_framed_routes[j]));
             continue;
         }
-        add_framed_route_to_trie(&sess->ipv6_framed_routes[j], sess);
         j++;
     }
     if (j == 0 && sess->ipv6_framed_routes) {
@@ -668,10 +660,117 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
     return cause_value;
 }
 
+/* Uplink packets may come from any framed route of the session */
+bool upf_sess_has_framed_route(upf_sess_t *sess, int family, uint32_t *addr)
+{
+    ogs_assert(sess);
+    ogs_assert(addr);
+
+    if (family == AF_INET)
+        return upf_lpm_match(self.ipv4_framed_routes, addr, sess,
+                sess->ipv4_framed_routes, OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI);
+    else
+        return upf_lpm_match(self.ipv6_framed_routes, addr, sess,
+                sess->ipv6_framed_routes, OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI);
+}
+
+/*
+ * UE-to-UE packets are hairpinned in the UPF only between two sessions
+ * of the same DNN listed in upf.hairpin. The DNN is the APN/DNN of the
+ * session, or else the Network Instance of its PDRs.
+ */
+void upf_sess_set_hairpin(upf_sess_t *sess)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    const char *dnn = NULL;
+    int i;
+
+    ogs_assert(sess);
+
+    sess->hairpin = NULL;
+
+    if (!self.hairpin.num_of_dnn)
+        return;
+
+    dnn = sess->apn_dnn;
+    if (!dnn) {
+        ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
+            if (pdr->dnn) {
+                dnn = pdr->dnn;
+                break;
+            }
+        }
+    }
+    if (!dnn)
+        return;
+
+    for (i = 0; i < self.hairpin.num_of_dnn; i++) {
+        if (ogs_strcasecmp(self.hairpin.dnn[i], dnn) == 0) {
+            sess->hairpin = self.hairpin.dnn[i];
+            return;
+        }
+    }
+}
+
+/*
+ * The data path stamps packets with a per-thread clock,
+ * which is refreshed once per receive burst.
+ */
+static ogs_thread_local ogs_time_t urr_acc_clock;
+
+void upf_sess_urr_acc_clock_update(void)
+{
+    urr_acc_clock = ogs_time_now();
+}
+
+static void upf_sess_urr_acc_check(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
+{
+    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    uint64_t vol, remain;
+
+    /* generate report if volume threshold/quota is reached */
+    vol = urr_acc->total_octets - urr_acc->last_report.total_octets;
+    if ((urr->rep_triggers.volume_quota && urr->vol_quota.tovol && vol >= urr->vol_quota.total_volume) ||
+        (urr->rep_triggers.volume_threshold && urr->vol_threshold.tovol && vol >= urr->vol_threshold.total_volume)) {
+        ogs_pfcp_user_plane_report_t report;
+        memset(&report, 0, sizeof(report));
+        upf_sess_urr_acc_fill_usage_report(sess, urr, &report, 0);
+        report.num_of_usage_report = 1;
+        upf_sess_urr_acc_snapshot(sess, urr);
+
+        ogs_assert(OGS_OK ==
+            upf_pfcp_send_session_report_request(sess, &report));
+        /*
+         * Start new report period/iteration:
+         * On a data-plane worker, the main thread does it
+         * once the report has been sent.
+         */
+        if (!upf_worker_self())
+            upf_sess_urr_acc_timers_setup(sess, urr);
+
+        vol = 0;
+    }
+
+    /*
+     * Next check : where the nearest quota/threshold is crossed,
+     * but no further than 'urr_check_bytes', which bounds how late
+     * a change that did not go through upf_sess_urr_acc_check_reset()
+     * is noticed.
+     */
+    remain = upf_self()->urr_check_bytes;
+    if (urr->rep_triggers.volume_quota && urr->vol_quota.tovol &&
+        urr->vol_quota.total_volume > vol)
+        remain = ogs_min(remain, urr->vol_quota.total_volume - vol);
+    if (urr->rep_triggers.volume_threshold && urr->vol_threshold.tovol &&
+        urr->vol_threshold.total_volume > vol)
+        remain = ogs_min(remain, urr->vol_threshold.total_volume - vol);
+
+    urr_acc->next_check_octets = urr_acc->total_octets + remain;
+}
+
 void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink)
 {
     upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
-    uint64_t vol;
 
     /* Increment total & ul octets + pkts */
     urr_acc->total_octets += size;
@@ -684,25 +783,22 @@ void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bo
         urr_acc->dl_pkts++;
     }
 
-    urr_acc->time_of_last_packet = ogs_time_now();
+    if (!urr_acc_clock)
+        upf_sess_urr_acc_clock_update();
+
+    urr_acc->time_of_last_packet = urr_acc_clock;
     if (urr_acc->time_of_first_packet == 0)
         urr_acc->time_of_first_packet = urr_acc->time_of_last_packet;
 
-    /* generate report if volume threshold/quota is reached */
-    vol = urr_acc->total_octets - urr_acc->last_report.total_octets;
-    if ((urr->rep_triggers.volume_quota && urr->vol_quota.tovol && vol >= urr->vol_quota.total_volume) ||
-        (urr->rep_triggers.volume_threshold && urr->vol_threshold.tovol && vol >= urr->vol_threshold.total_volume)) {
-        ogs_pfcp_user_plane_report_t report;
-        memset(&report, 0, sizeof(report));
-        upf_sess_urr_acc_fill_usage_report(sess, urr, &report, 0);
-        report.num_of_usage_report = 1;
-        upf_sess_urr_acc_snapshot(sess, urr);
+    if (urr_acc->total_octets >= urr_acc->next_check_octets)
+        upf_sess_urr_acc_check(sess, urr);
+}
 
-        ogs_assert(OGS_OK ==
-            upf_pfcp_send_session_report_request(sess, &report));
-        /* Start new report period/iteration: */
-        upf_sess_urr_acc_timers_setup(sess, urr);
-    }
+/* Evaluate the volume quota/threshold again on the next packet */
+void upf_sess_urr_acc_check_reset(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
+{
+    upf_sess_urr_acc_t *urr_acc = &sess->urr_acc[urr->id];
+    urr_acc->next_check_octets = 0;
 }
 
 /* report struct must be memzeroed before first use of this function.
@@ -776,6 +872,7 @@ void upf_sess_urr_acc_snapshot(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
     urr_acc->last_report.dl_pkts = urr_acc->dl_pkts;
     urr_acc->last_report.ul_pkts = urr_acc->ul_pkts;
     urr_acc->last_report.timestamp = ogs_time_now();
+    urr_acc->next_check_octets = 0;
 }
 
 static void upf_sess_urr_acc_timers_cb(void *data)
@@ -787,6 +884,9 @@ static void upf_sess_urr_acc_timers_cb(void *data)
 
     ogs_info("upf_time_threshold_cb() triggered! urr=%p", urr);
 
+    /* The usage counters are updated by the owning worker */
+    upf_worker_barrier_sync();
+
     if (urr->rep_triggers.quota_validity_time ||
         urr->rep_triggers.time_quota ||
         urr->rep_triggers.time_threshold) {
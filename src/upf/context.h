@@ -35,6 +35,7 @@
 #include "timer.h"
 #include "upf-sm.h"
 #include "metrics.h"
+#include "lpm.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,29 +46,35 @@ extern int __upf_log_domain;
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __upf_log_domain
 
-struct upf_route_trie_node;
+#define UPF_DEFAULT_URR_CHECK_BYTES (1024*1024)
+#define UPF_MAX_URR_CHECK_BYTES (64*1024*1024)
 
 typedef struct upf_context_s {
     ogs_hash_t *upf_n4_seid_hash;   /* hash table (UPF-N4-SEID) */
     ogs_hash_t *smf_n4_seid_hash;   /* hash table (SMF-N4-SEID) */
     ogs_hash_t *smf_n4_f_seid_hash; /* hash table (SMF-N4-F-SEID) */
-    ogs_hash_t *ipv4_hash;  /* hash table (IPv4 Address) */
-    ogs_hash_t *ipv6_hash;  /* hash table (IPv6 Address) */
+    ogs_ipmap_t *ipv4_map;  /* open-addressing table (IPv4 Address) */
+    ogs_ipmap_t *ipv6_map;  /* open-addressing table (IPv6 /64 Prefix) */
 
-    /* IPv4 framed routes trie */
-    struct upf_route_trie_node *ipv4_framed_routes;
-    /* IPv6 framed routes trie */
-    struct upf_route_trie_node *ipv6_framed_routes;
+    upf_lpm_t *ipv4_framed_routes;  /* LPM table (IPv4 Framed-Route) */
+    upf_lpm_t *ipv6_framed_routes;  /* LPM table (IPv6 Framed-Route) */
 
     ogs_list_t sess_list;
-} upf_context_t;
 
-/* trie mapping from IP framed routes to session. */
-struct upf_route_trie_node {
-    struct upf_route_trie_node *left;
-    struct upf_route_trie_node *right;
-    upf_sess_t *sess;
-};
+    int gtpu_burst; /* Max number of packets per wakeup on N3/N6 */
+    uint64_t urr_check_bytes; /* Max octets between two URR volume checks */
+    int num_of_worker; /* Data-plane worker threads, 0 : run in main */
+
+    struct {
+        char dev[OGS_MAX_IFNAME_LEN]; /* N3 interface, empty : disabled */
+        int num_of_queue; /* RX queues bound to AF_XDP sockets */
+    } xdp;
+
+    struct {
+        char dnn[OGS_MAX_NUM_OF_DNN][OGS_MAX_DNN_LEN+1];
+        int num_of_dnn; /* DNNs forwarding UE-to-UE traffic in the UPF */
+    } hairpin;
+} upf_context_t;
 
 /* Accounting: */
 typedef struct upf_sess_urr_acc_s {
@@ -85,6 +92,8 @@ typedef struct upf_sess_urr_acc_s {
     uint64_t dl_pkts;
     ogs_time_t time_of_first_packet;
     ogs_time_t time_of_last_packet;
+    /* Volume quota/threshold are evaluated when total_octets reaches this */
+    uint64_t next_check_octets;
     /* Snapshot of measurement when last report was sent: */
     struct {
         uint64_t total_octets;
@@ -120,6 +129,9 @@ typedef struct upf_sess_s {
     char            *gx_sid;            /* Gx Session ID */
     ogs_pfcp_node_t *pfcp_node;
 
+    int             worker_id;          /* Data-plane worker owning it */
+    const char      *hairpin;           /* DNN of upf.hairpin, or NULL */
+
     /* Accounting: */
     upf_sess_urr_acc_t urr_acc[OGS_MAX_NUM_OF_URR]; /* FIXME: This probably needs to be mved to a hashtable or alike */
     char            *apn_dnn;            /* APN/DNN Item */
@@ -141,6 +153,8 @@ upf_sess_t *upf_sess_find_by_smf_n4_f_seid(ogs_pfcp_f_seid_t *f_seid);
 upf_sess_t *upf_sess_find_by_upf_n4_seid(uint64_t seid);
 upf_sess_t *upf_sess_find_by_ipv4(uint32_t addr);
 upf_sess_t *upf_sess_find_by_ipv6(uint32_t *addr6);
+void upf_sess_prefetch_by_ipv4(uint32_t addr);
+void upf_sess_prefetch_by_ipv6(uint32_t *addr6);
 
 uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
         uint8_t session_type, ogs_pfcp_pdr_t *pdr);
@@ -148,8 +162,12 @@ uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
         char *framed_routes[]);
 uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
         char *framed_routes[]);
+bool upf_sess_has_framed_route(upf_sess_t *sess, int family, uint32_t *addr);
+void upf_sess_set_hairpin(upf_sess_t *sess);
 
+void upf_sess_urr_acc_clock_update(void);
 void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink);
+void upf_sess_urr_acc_check_reset(upf_sess_t *sess, ogs_pfcp_urr_t *urr);
 void upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *urr,
                                         ogs_pfcp_user_plane_report_t *report, unsigned int idx);
 void upf_sess_urr_acc_snapshot(upf_sess_t *sess, ogs_pfcp_urr_t *urr);
@@ -37,12 +37,8 @@ static void pollset_action_setup(void)
 }
 #endif
 
-static OGS_POOL(pool, upf_event_t);
-
 void upf_event_init(void)
 {
-    ogs_pool_init(&pool, ogs_app()->pool.event);
-
 #if defined(HAVE_KQUEUE)
     ogs_assert(ogs_app()->pollset);
     ogs_pollset_destroy(ogs_app()->pollset);
@@ -60,28 +56,20 @@ void upf_event_term(void)
     ogs_pollset_notify(ogs_app()->pollset);
 }
 
-void upf_event_final(void)
-{
-    ogs_pool_final(&pool);
-}
-
 upf_event_t *upf_event_new(upf_event_e id)
 {
     upf_event_t *e = NULL;
 
-    ogs_pool_alloc(&pool, &e);
+    /* Data-plane workers also raise events */
+    e = ogs_event_size(id, sizeof(*e));
     ogs_assert(e);
-    memset(e, 0, sizeof(*e));
-
-    e->id = id;
 
     return e;
 }
 
 void upf_event_free(upf_event_t *e)
 {
-    ogs_assert(e);
-    ogs_pool_free(&pool, e);
+    ogs_event_free(e);
 }
 
 const char *upf_event_get_name(upf_event_t *e)
@@ -101,6 +89,8 @@ const char *upf_event_get_name(upf_event_t *e)
         return "UPF_EVT_N4_TIMER";
     case UPF_EVT_N4_NO_HEARTBEAT:
         return "UPF_EVT_N4_NO_HEARTBEAT";
+    case UPF_EVT_N4_SESSION_REPORT:
+        return "UPF_EVT_N4_SESSION_REPORT";
 
     default: 
        break;
@@ -30,6 +30,7 @@ typedef struct ogs_pfcp_node_s ogs_pfcp_node_t;
 typedef struct ogs_pfcp_xact_s ogs_pfcp_xact_t;
 typedef struct ogs_pfcp_message_s ogs_pfcp_message_t;
 typedef struct upf_sess_s upf_sess_t;
+typedef struct ogs_pfcp_user_plane_report_s ogs_pfcp_user_plane_report_t;
 
 typedef enum {
     UPF_EVT_BASE = OGS_MAX_NUM_OF_PROTO_EVENT,
@@ -37,6 +38,7 @@ typedef enum {
     UPF_EVT_N4_MESSAGE,
     UPF_EVT_N4_TIMER,
     UPF_EVT_N4_NO_HEARTBEAT,
+    UPF_EVT_N4_SESSION_REPORT,
 
     UPF_EVT_TOP,
 
@@ -51,13 +53,15 @@ typedef struct upf_event_s {
     ogs_pfcp_node_t *pfcp_node;
     ogs_pfcp_xact_t *pfcp_xact;
     ogs_pfcp_message_t *pfcp_message;
+
+    uint64_t upf_n4_seid;
+    ogs_pfcp_user_plane_report_t *report;
 } upf_event_t;
 
 OGS_STATIC_ASSERT(OGS_EVENT_SIZE >= sizeof(upf_event_t));
 
 void upf_event_init(void);
 void upf_event_term(void);
-void upf_event_final(void);
 
 upf_event_t *upf_event_new(upf_event_e id);
 void upf_event_free(upf_event_t *e);
@@ -52,6 +52,8 @@
 #include "gtp-path.h"
 #include "pfcp-path.h"
 #include "rule-match.h"
+#include "worker.h"
+#include "xdp-path.h"
 
 #define UPF_GTP_HANDLED     1
 
@@ -59,36 +61,27 @@ const uint8_t proxy_mac_addr[] = { 0x0e, 0x00, 0x00, 0x00, 0x00, 0x01 };
 
 static ogs_pkbuf_pool_t *packet_pool = NULL;
 
-static void upf_gtp_handle_multicast(ogs_pkbuf_t *recvbuf);
+/* Pre-reserved receive buffers for recvmmsg() on the N3 interface */
+static ogs_thread_local ogs_pkbuf_t *rx_vector[OGS_MAX_NUM_OF_SOCKMSG];
 
-static int check_framed_routes(upf_sess_t *sess, int family, uint32_t *addr)
-{
-    int i = 0;
-    ogs_ipsubnet_t *routes = family == AF_INET ?
-        sess->ipv4_framed_routes : sess->ipv6_framed_routes;
-
-    if (!routes)
-        return false;
+static void upf_gtp_handle_multicast(
+        ogs_pkbuf_t *recvbuf, ogs_pfcp_packet_info_t *info);
+static void upf_gtp_send_multicast(upf_sess_t *sess, ogs_pkbuf_t *sendbuf);
 
-    for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
-        uint32_t *sub = routes[i].sub;
-        uint32_t *mask = routes[i].mask;
-
-        if (!routes[i].family)
-            break;
+/* Each data-plane worker writes to its own queue of the TUN device */
+static ogs_socket_t _get_dev_fd(ogs_pfcp_dev_t *dev)
+{
+    upf_worker_t *worker = upf_worker_self();
+    int i;
 
-        if (family == AF_INET) {
-            if (sub[0] == (addr[0] & mask[0]))
-                return true;
-        } else {
-            if (sub[0] == (addr[0] & mask[0]) &&
-                sub[1] == (addr[1] & mask[1]) &&
-                sub[2] == (addr[2] & mask[2]) &&
-                sub[3] == (addr[3] & mask[3]))
-                return true;
+    if (worker) {
+        for (i = 0; i < worker->num_of_tun; i++) {
+            if (worker->tun[i].dev == dev)
+                return worker->tun[i].fd;
         }
     }
-    return false;
+
+    return dev->fd;
 }
 
 static uint16_t _get_eth_type(uint8_t *data, uint len) {
@@ -99,23 +92,12 @@ static uint16_t _get_eth_type(uint8_t *data, uint len) {
     return 0;
 }
 
-static void _gtpv1_tun_recv_common_cb(
-        short when, ogs_socket_t fd, bool has_eth, void *data)
+/* Returns false once the packet has been answered or dropped */
+static bool _gtpv1_tun_parse_pdu(ogs_socket_t fd, bool has_eth,
+        ogs_pkbuf_t *recvbuf, ogs_pfcp_packet_info_t *info)
 {
-    ogs_pkbuf_t *recvbuf = NULL;
-
-    upf_sess_t *sess = NULL;
-    ogs_pfcp_pdr_t *pdr = NULL;
-    ogs_pfcp_pdr_t *fallback_pdr = NULL;
-    ogs_pfcp_far_t *far = NULL;
-    ogs_pfcp_user_plane_report_t report;
-    int i;
-
-    recvbuf = ogs_tun_read(fd, packet_pool);
-    if (!recvbuf) {
-        ogs_warn("ogs_tun_read() failed");
-        return;
-    }
+    ogs_assert(recvbuf);
+    ogs_assert(info);
 
     if (has_eth) {
         ogs_pkbuf_t *replybuf = NULL;
@@ -163,48 +145,40 @@ static void _gtpv1_tun_recv_common_cb(
         ogs_pkbuf_pull(recvbuf, ETHER_HDR_LEN);
     }
 
-    sess = upf_sess_find_by_ue_ip_address(recvbuf);
-    if (!sess)
+    if (ogs_pfcp_packet_info_parse(info, recvbuf) != OGS_OK)
         goto cleanup;
 
-    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
-        far = pdr->far;
-        ogs_assert(far);
+    return true;
 
-        /* Check if PDR is Downlink */
-        if (pdr->src_if != OGS_PFCP_INTERFACE_CORE)
-            continue;
-
-        /* Save the Fallback PDR : Lowest precedence downlink PDR */
-        fallback_pdr = pdr;
+cleanup:
+    ogs_pkbuf_free(recvbuf);
+    return false;
+}
 
-        /* Check if FAR is Downlink */
-        if (far->dst_if != OGS_PFCP_INTERFACE_ACCESS)
-            continue;
+static void _gtpv1_tun_forward_pdu(upf_sess_t *sess,
+        ogs_pkbuf_t *recvbuf, ogs_pfcp_packet_info_t *info)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_user_plane_report_t report;
+    int i;
 
-        /* Check if Outer header creation */
-        if (far->outer_header_creation.ip4 == 0 &&
-            far->outer_header_creation.ip6 == 0 &&
-            far->outer_header_creation.udp4 == 0 &&
-            far->outer_header_creation.udp6 == 0 &&
-            far->outer_header_creation.gtpu4 == 0 &&
-            far->outer_header_creation.gtpu6 == 0)
-            continue;
+    ogs_assert(recvbuf);
+    ogs_assert(info);
 
-        /* Check if Rule List in PDR */
-        if (ogs_list_first(&pdr->rule_list) &&
-            ogs_pfcp_pdr_rule_find_by_packet(pdr, recvbuf) == NULL)
-            continue;
+    if (!sess)
+        goto cleanup;
 
-        break;
+    if (!upf_worker_owns(sess)) {
+        if (upf_worker_handoff(sess, recvbuf, NULL, NULL))
+            return;
+        goto cleanup;
     }
 
-    if (!pdr)
-        pdr = fallback_pdr;
-
+    /* Falls back to the lowest precedence downlink PDR */
+    pdr = ogs_pfcp_classifier_find_downlink(&sess->pfcp, info);
     if (!pdr) {
         if (ogs_app()->parameter.multicast) {
-            upf_gtp_handle_multicast(recvbuf);
+            upf_gtp_handle_multicast(recvbuf, info);
         }
         goto cleanup;
     }
@@ -213,21 +187,21 @@ static void _gtpv1_tun_recv_common_cb(
     for (i = 0; i < pdr->num_of_urr; i++)
         upf_sess_urr_acc_add(sess, pdr->urr[i], recvbuf->len, false);
 
-    ogs_assert(true == ogs_pfcp_up_handle_pdr(
-                pdr, OGS_GTPU_MSGTYPE_GPDU, recvbuf, &report));
-
     /*
      * Issue #2210, Discussion #2208, #2209
      *
-     * Metrics reduce data plane performance.
-     * It should not be used on the UPF/SGW-U data plane
-     * until this issue is resolved.
+     * Counters are per-thread and only aggregated when scraped,
+     * so they can be updated for every packet.
      */
-#if 0
     upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_GTP_OUTDATAPKTN3UPF);
-    upf_metrics_inst_by_qfi_add(pdr->qer->qfi,
-        UPF_METR_CTR_GTP_OUTDATAVOLUMEQOSLEVELN3UPF, recvbuf->len);
-#endif
+    if (pdr->qer)
+        upf_metrics_inst_by_qfi_add(pdr->qer->qfi,
+            UPF_METR_CTR_GTP_OUTDATAVOLUMEQOSLEVELN3UPF, recvbuf->len);
+
+    /* The packet is forwarded in place */
+    ogs_assert(true == ogs_pfcp_up_handle_pdr_nocopy(
+                pdr, OGS_GTPU_MSGTYPE_GPDU, recvbuf, &report));
+    recvbuf = NULL;
 
     if (report.type.downlink_data_report) {
         ogs_assert(pdr->sess);
@@ -243,7 +217,64 @@ static void _gtpv1_tun_recv_common_cb(
     }
 
 cleanup:
-    ogs_pkbuf_free(recvbuf);
+    if (recvbuf)
+        ogs_pkbuf_free(recvbuf);
+}
+
+static void _gtpv1_tun_handle_pdu(
+        ogs_socket_t fd, bool has_eth, ogs_pkbuf_t *recvbuf)
+{
+    ogs_pfcp_packet_info_t info;
+
+    if (_gtpv1_tun_parse_pdu(fd, has_eth, recvbuf, &info))
+        _gtpv1_tun_forward_pdu(
+                upf_sess_find_by_ue_ip_address(&info), recvbuf, &info);
+}
+
+static void _gtpv1_tun_recv_common_cb(
+        short when, ogs_socket_t fd, bool has_eth, void *data)
+{
+    ogs_pkbuf_t *recvbuf[OGS_MAX_NUM_OF_SOCKMSG];
+    ogs_pfcp_packet_info_t info[OGS_MAX_NUM_OF_SOCKMSG];
+    upf_sess_t *sess[OGS_MAX_NUM_OF_SOCKMSG];
+    ogs_gtp_burst_stat_t stat;
+    int i, num, burst;
+
+    burst = upf_self()->gtpu_burst;
+    ogs_assert(burst > 0 && burst <= OGS_MAX_NUM_OF_SOCKMSG);
+
+    upf_sess_urr_acc_clock_update();
+    ogs_gtp_burst_begin();
+
+    /* Drain up to 'gtpu_burst' packets per wakeup */
+    for (i = 0, num = 0; i < burst; i++) {
+        ogs_pkbuf_t *pkbuf = ogs_tun_read(fd, packet_pool);
+        if (!pkbuf) {
+            if (i == 0)
+                ogs_warn("ogs_tun_read() failed");
+            break;
+        }
+
+        if (_gtpv1_tun_parse_pdu(fd, has_eth, pkbuf, &info[num]))
+            recvbuf[num++] = pkbuf;
+    }
+
+    /* The sessions of the whole burst are looked up at once */
+    upf_sess_find_burst_by_ue_ip_address(info, sess, num);
+
+    for (i = 0; i < num; i++)
+        _gtpv1_tun_forward_pdu(sess[i], recvbuf[i], &info[i]);
+
+    ogs_gtp_burst_end(&stat);
+
+    if (stat.syscalls) {
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDSYSCALL, stat.syscalls);
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDPKT, stat.pkts);
+    }
+
+    upf_metrics_inst_global_add_buffer_stat();
 }
 
 static void _gtpv1_tun_recv_cb(short when, ogs_socket_t fd, void *data)
@@ -256,43 +287,23 @@ static void _gtpv1_tun_recv_eth_cb(short when, ogs_socket_t fd, void *data)
     _gtpv1_tun_recv_common_cb(when, fd, true, data);
 }
 
-static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+static void _gtpv1_u_handle_pdu(
+        ogs_sock_t *sock, ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from)
 {
     int len;
-    ssize_t size;
     char buf1[OGS_ADDRSTRLEN];
     char buf2[OGS_ADDRSTRLEN];
 
     upf_sess_t *sess = NULL;
 
-    ogs_pkbuf_t *pkbuf = NULL;
-    ogs_sock_t *sock = NULL;
-    ogs_sockaddr_t from;
-
     ogs_gtp2_header_t *gtp_h = NULL;
     ogs_pfcp_user_plane_report_t report;
 
     uint32_t teid;
     uint8_t qfi;
 
-    ogs_assert(fd != INVALID_SOCKET);
-    sock = data;
     ogs_assert(sock);
-
-    pkbuf = ogs_pkbuf_alloc(packet_pool, OGS_MAX_PKT_LEN);
-    ogs_assert(pkbuf);
-    ogs_pkbuf_reserve(pkbuf, OGS_TUN_MAX_HEADROOM);
-    ogs_pkbuf_put(pkbuf, OGS_MAX_PKT_LEN-OGS_TUN_MAX_HEADROOM);
-
-    size = ogs_recvfrom(fd, pkbuf->data, pkbuf->len, 0, &from);
-    if (size <= 0) {
-        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
-                "ogs_recv() failed");
-        goto cleanup;
-    }
-
-    ogs_pkbuf_trim(pkbuf, size);
-
+    ogs_assert(from);
     ogs_assert(pkbuf);
     ogs_assert(pkbuf->len);
 
@@ -306,16 +317,17 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     if (gtp_h->type == OGS_GTPU_MSGTYPE_ECHO_REQ) {
         ogs_pkbuf_t *echo_rsp;
 
-        ogs_debug("[RECV] Echo Request from [%s]", OGS_ADDR(&from, buf1));
+        ogs_debug("[RECV] Echo Request from [%s]", OGS_ADDR(from, buf1));
         echo_rsp = ogs_gtp2_handle_echo_req(pkbuf);
         ogs_expect(echo_rsp);
         if (echo_rsp) {
             ssize_t sent;
 
             /* Echo reply */
-            ogs_debug("[SEND] Echo Response to [%s]", OGS_ADDR(&from, buf1));
+            ogs_debug("[SEND] Echo Response to [%s]", OGS_ADDR(from, buf1));
 
-            sent = ogs_sendto(fd, echo_rsp->data, echo_rsp->len, 0, &from);
+            sent = ogs_sendto(sock->fd,
+                    echo_rsp->data, echo_rsp->len, 0, from);
             if (sent < 0 || sent != echo_rsp->len) {
                 ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
                         "ogs_sendto() failed");
@@ -328,7 +340,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     teid = be32toh(gtp_h->teid);
 
     ogs_trace("[RECV] GPU-U Type [%d] from [%s] : TEID[0x%x]",
-            gtp_h->type, OGS_ADDR(&from, buf1), teid);
+            gtp_h->type, OGS_ADDR(from, buf1), teid);
 
     qfi = 0;
     if (gtp_h->flags & OGS_GTPU_FLAGS_E) {
@@ -396,8 +408,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
 
     } else if (gtp_h->type == OGS_GTPU_MSGTYPE_GPDU) {
         uint16_t eth_type = 0;
-        struct ip *ip_h = NULL;
         uint32_t *src_addr = NULL;
+        ogs_pfcp_packet_info_t info;
         ogs_pfcp_object_t *pfcp_object = NULL;
         ogs_pfcp_sess_t *pfcp_sess = NULL;
         ogs_pfcp_pdr_t *pdr = NULL;
@@ -407,22 +419,6 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
         ogs_pfcp_dev_t *dev = NULL;
         int i;
 
-        ip_h = (struct ip *)pkbuf->data;
-        ogs_assert(ip_h);
-
-        /*
-         * Issue #2210, Discussion #2208, #2209
-         *
-         * Metrics reduce data plane performance.
-         * It should not be used on the UPF/SGW-U data plane
-         * until this issue is resolved.
-         */
-#if 0
-        upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_GTP_INDATAPKTN3UPF);
-        upf_metrics_inst_by_qfi_add(qfi,
-                UPF_METR_CTR_GTP_INDATAVOLUMEQOSLEVELN3UPF, pkbuf->len);
-#endif
-
         pfcp_object = ogs_pfcp_object_find_by_teid(teid);
         if (!pfcp_object) {
             /*
@@ -441,12 +437,40 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 ogs_error("[%s] Send Error Indication [TEID:0x%x] to [%s]",
                         OGS_ADDR(&sock->local_addr, buf1),
                         teid,
-                        OGS_ADDR(&from, buf2));
-                ogs_gtp1_send_error_indication(sock, teid, qfi, &from);
+                        OGS_ADDR(from, buf2));
+                ogs_gtp1_send_error_indication(sock, teid, qfi, from);
             }
             goto cleanup;
         }
 
+        if (pfcp_object->type == OGS_PFCP_OBJ_SESS_TYPE) {
+            sess = UPF_SESS((ogs_pfcp_sess_t *)pfcp_object);
+            ogs_assert(sess);
+
+            if (!upf_worker_owns(sess)) {
+                /* The owner parses the GTP-U header again */
+                ogs_assert(ogs_pkbuf_push(pkbuf, len));
+                if (upf_worker_handoff(sess, pkbuf, sock, from))
+                    return;
+                goto cleanup;
+            }
+        }
+
+        /*
+         * Issue #2210, Discussion #2208, #2209
+         *
+         * Counters are per-thread and only aggregated when scraped,
+         * so they can be updated for every packet. A packet handed off
+         * to another worker is counted there.
+         */
+        upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_GTP_INDATAPKTN3UPF);
+        upf_metrics_inst_by_qfi_add(qfi,
+                UPF_METR_CTR_GTP_INDATAVOLUMEQOSLEVELN3UPF, pkbuf->len);
+
+        /* The inner IP header is parsed only once from here on */
+        if (ogs_pfcp_packet_info_parse(&info, pkbuf) != OGS_OK)
+            goto cleanup;
+
         switch(pfcp_object->type) {
         case OGS_PFCP_OBJ_PDR_TYPE:
             /* UPF does not use PDR TYPE */
@@ -458,29 +482,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
             pfcp_sess = (ogs_pfcp_sess_t *)pfcp_object;
             ogs_assert(pfcp_sess);
 
-            ogs_list_for_each(&pfcp_sess->pdr_list, pdr) {
-
-                /* Check if Source Interface */
-                if (pdr->src_if != OGS_PFCP_INTERFACE_ACCESS &&
-                    pdr->src_if != OGS_PFCP_INTERFACE_CP_FUNCTION)
-                    continue;
-
-                /* Check if TEID */
-                if (teid != pdr->f_teid.teid)
-                    continue;
-
-                /* Check if QFI */
-                if (qfi && pdr->qfi != qfi)
-                    continue;
-
-                /* Check if Rule List in PDR */
-                if (ogs_list_first(&pdr->rule_list) &&
-                    ogs_pfcp_pdr_rule_find_by_packet(pdr, pkbuf) == NULL)
-                    continue;
-
-                break;
-            }
-
+            pdr = ogs_pfcp_classifier_find_uplink(
+                    pfcp_sess, teid, qfi, &info);
             if (!pdr) {
                 /*
                  * TS23.527 Restoration procedures
@@ -499,8 +502,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                             "[%s] Send Error Indication [TEID:0x%x] to [%s]",
                             OGS_ADDR(&sock->local_addr, buf1),
                             teid,
-                            OGS_ADDR(&from, buf2));
-                    ogs_gtp1_send_error_indication(sock, teid, qfi, &from);
+                            OGS_ADDR(from, buf2));
+                    ogs_gtp1_send_error_indication(sock, teid, qfi, from);
                 }
                 goto cleanup;
             }
@@ -521,9 +524,9 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
         far = pdr->far;
         ogs_assert(far);
 
-        if (ip_h->ip_v == 4 && sess->ipv4) {
-            src_addr = (void *)&ip_h->ip_src.s_addr;
-            ogs_assert(src_addr);
+        src_addr = info.src_addr;
+
+        if (info.version == 4 && sess->ipv4) {
 
             /*
              * From Issue #1354
@@ -536,11 +539,11 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
 
                 if (src_addr[0] == sess->ipv4->addr[0]) {
                     /* Source IP address should be matched in uplink */
-                } else if (check_framed_routes(sess, AF_INET, src_addr)) {
+                } else if (upf_sess_has_framed_route(sess, AF_INET, src_addr)) {
                     /* Or source IP address should match a framed route */
                 } else {
                     ogs_error("[DROP] Source IP-%d Spoofing APN:%s SrcIf:%d DstIf:%d TEID:0x%x",
-                                ip_h->ip_v, pdr->dnn, pdr->src_if, far->dst_if, teid);
+                                info.version, pdr->dnn, pdr->src_if, far->dst_if, teid);
                     ogs_error("       SRC:%08X, UE:%08X",
                         be32toh(src_addr[0]), be32toh(sess->ipv4->addr[0]));
                     ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
@@ -552,11 +555,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
             subnet = sess->ipv4->subnet;
             eth_type = ETHERTYPE_IP;
 
-        } else if (ip_h->ip_v == 6 && sess->ipv6) {
-            struct ip6_hdr *ip6_h = (struct ip6_hdr *)pkbuf->data;
-            ogs_assert(ip6_h);
-            src_addr = (void *)ip6_h->ip6_src.s6_addr;
-            ogs_assert(src_addr);
+        } else if (info.version == 6 && sess->ipv6) {
 
             /*
              * From Issue #1354
@@ -614,11 +613,11 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                      * If Global address
                      * 64 bit prefix should be matched
                      */
-                } else if (check_framed_routes(sess, AF_INET6, src_addr)) {
+                } else if (upf_sess_has_framed_route(sess, AF_INET6, src_addr)) {
                     /* Or source IP address should match a framed route */
                 } else {
                     ogs_error("[DROP] Source IP-%d Spoofing APN:%s SrcIf:%d DstIf:%d TEID:0x%x",
-                                ip_h->ip_v, pdr->dnn, pdr->src_if, far->dst_if, teid);
+                                info.version, pdr->dnn, pdr->src_if, far->dst_if, teid);
                     ogs_error("SRC:%08x %08x %08x %08x",
                             be32toh(src_addr[0]), be32toh(src_addr[1]),
                             be32toh(src_addr[2]), be32toh(src_addr[3]));
@@ -638,7 +637,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
 
         } else {
             ogs_error("Invalid packet [IP version:%d, Packet Length:%d]",
-                    ip_h->ip_v, pkbuf->len);
+                    info.version, pkbuf->len);
             ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
             goto cleanup;
         }
@@ -648,7 +647,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
             if (!subnet) {
 #if 0 /* It's redundant log message */
                 ogs_error("[DROP] Cannot find subnet V:%d, IPv4:%p, IPv6:%p",
-                        ip_h->ip_v, sess->ipv4, sess->ipv6);
+                        info.version, sess->ipv4, sess->ipv6);
                 ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
 #endif
                 goto cleanup;
@@ -661,6 +660,19 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
             for (i = 0; i < pdr->num_of_urr; i++)
                 upf_sess_urr_acc_add(sess, pdr->urr[i], pkbuf->len, true);
 
+            /* Destined to another UE : hairpin back out */
+            if (sess->hairpin) {
+                upf_sess_t *peer = upf_sess_find_by_ue_ip_address(&info);
+
+                if (peer && peer->hairpin == sess->hairpin) {
+                    upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_HAIRPINPKT);
+
+                    _gtpv1_tun_forward_pdu(peer, pkbuf, &info);
+                    pkbuf = NULL;
+                    goto cleanup;
+                }
+            }
+
             if (dev->is_tap) {
                 ogs_assert(eth_type);
                 eth_type = htobe16(eth_type);
@@ -672,13 +684,13 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 memcpy(pkbuf->data, dev->mac_addr, ETHER_ADDR_LEN);
             }
 
-            /* TODO: if destined to another UE, hairpin back out. */
-            if (ogs_tun_write(dev->fd, pkbuf) != OGS_OK)
+            if (ogs_tun_write(_get_dev_fd(dev), pkbuf) != OGS_OK)
                 ogs_warn("ogs_tun_write() failed");
 
         } else if (far->dst_if == OGS_PFCP_INTERFACE_ACCESS) {
-            ogs_assert(true == ogs_pfcp_up_handle_pdr(
+            ogs_assert(true == ogs_pfcp_up_handle_pdr_nocopy(
                         pdr, gtp_h->type, pkbuf, &report));
+            pkbuf = NULL;
 
             if (report.type.downlink_data_report) {
                 ogs_error("Indirect Data Fowarding Buffered");
@@ -704,8 +716,9 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 goto cleanup;
             }
 
-            ogs_assert(true == ogs_pfcp_up_handle_pdr(
+            ogs_assert(true == ogs_pfcp_up_handle_pdr_nocopy(
                         pdr, gtp_h->type, pkbuf, &report));
+            pkbuf = NULL;
 
             ogs_assert(report.type.downlink_data_report == 0);
 
@@ -719,7 +732,166 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     }
 
 cleanup:
-    ogs_pkbuf_free(pkbuf);
+    if (pkbuf)
+        ogs_pkbuf_free(pkbuf);
+}
+
+static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    ogs_sock_t *sock = NULL;
+    ogs_sockmsg_t msg[OGS_MAX_NUM_OF_SOCKMSG];
+    ogs_gtp_burst_stat_t stat;
+    int i, num, burst;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    sock = data;
+    ogs_assert(sock);
+
+    burst = upf_self()->gtpu_burst;
+    ogs_assert(burst > 0 && burst <= OGS_MAX_NUM_OF_SOCKMSG);
+
+    /* Refill the receive vector consumed by the previous burst */
+    for (i = 0; i < burst; i++) {
+        ogs_pkbuf_t *pkbuf = rx_vector[i];
+
+        if (!pkbuf) {
+            pkbuf = ogs_pkbuf_alloc(packet_pool, OGS_MAX_PKT_LEN);
+            ogs_assert(pkbuf);
+            ogs_pkbuf_reserve(pkbuf, OGS_TUN_MAX_HEADROOM);
+            ogs_pkbuf_put(pkbuf, OGS_MAX_PKT_LEN-OGS_TUN_MAX_HEADROOM);
+            rx_vector[i] = pkbuf;
+        }
+
+        msg[i].buf = pkbuf->data;
+        msg[i].len = pkbuf->len;
+    }
+
+    num = ogs_recvmmsg(fd, msg, burst, 0);
+    upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_GTP_N3_RECVSYSCALL);
+    if (num <= 0) {
+        if (ogs_socket_errno != OGS_EAGAIN)
+            ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                    "ogs_recvmmsg() failed");
+        return;
+    }
+
+    upf_metrics_inst_global_add(UPF_METR_GLOB_CTR_GTP_N3_RECVPKT, num);
+
+    upf_sess_urr_acc_clock_update();
+    ogs_gtp_burst_begin();
+
+    for (i = 0; i < num; i++) {
+        ogs_pkbuf_t *pkbuf = rx_vector[i];
+
+        /* The handler owns the packet from now on */
+        rx_vector[i] = NULL;
+
+        if (msg[i].len == 0) {
+            ogs_error("[DROP] Empty GTPU packet");
+            ogs_pkbuf_free(pkbuf);
+            continue;
+        }
+
+        ogs_pkbuf_trim(pkbuf, msg[i].len);
+        _gtpv1_u_handle_pdu(sock, pkbuf, &msg[i].addr);
+    }
+
+    ogs_gtp_burst_end(&stat);
+
+    if (stat.syscalls) {
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDSYSCALL, stat.syscalls);
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDPKT, stat.pkts);
+    }
+
+    upf_metrics_inst_global_add_buffer_stat();
+}
+
+/* GTP-U datagrams redirected by the XDP program, see xdp-path.c */
+static void _gtpv1_u_xdp_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    upf_xsk_t *xsk = NULL;
+    ogs_pkbuf_t *pkbuf[OGS_MAX_NUM_OF_SOCKMSG];
+    ogs_sockaddr_t from[OGS_MAX_NUM_OF_SOCKMSG];
+    ogs_gtp_burst_stat_t stat;
+    ogs_sock_t *sock = NULL;
+    int i, num, burst;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    xsk = data;
+    ogs_assert(xsk);
+
+    burst = upf_self()->gtpu_burst;
+    ogs_assert(burst > 0 && burst <= OGS_MAX_NUM_OF_SOCKMSG);
+
+    num = upf_xdp_recv(xsk, pkbuf, from, burst);
+    upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_GTP_N3_RECVSYSCALL);
+    if (num <= 0)
+        return;
+
+    upf_metrics_inst_global_add(UPF_METR_GLOB_CTR_GTP_N3_RECVPKT, num);
+
+    upf_sess_urr_acc_clock_update();
+    ogs_gtp_burst_begin();
+
+    for (i = 0; i < num; i++) {
+        /* Responses and N9 traffic leave through the kernel socket */
+        if (from[i].ogs_sa_family == AF_INET)
+            sock = ogs_gtp_self()->gtpu_sock;
+        else
+            sock = ogs_gtp_self()->gtpu_sock6;
+
+        if (!sock) {
+            ogs_error("[DROP] No GTPU socket for family [%d]",
+                    from[i].ogs_sa_family);
+            ogs_pkbuf_free(pkbuf[i]);
+            continue;
+        }
+
+        _gtpv1_u_handle_pdu(sock, pkbuf[i], &from[i]);
+    }
+
+    ogs_gtp_burst_end(&stat);
+
+    if (stat.syscalls) {
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDSYSCALL, stat.syscalls);
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDPKT, stat.pkts);
+    }
+
+    upf_metrics_inst_global_add_buffer_stat();
+}
+
+void upf_gtp_handle_handoff(upf_worker_msg_t *msg)
+{
+    ogs_assert(msg);
+    ogs_assert(msg->pkbuf);
+
+    if (msg->upf_n4_seid) {
+        /* The session may have gone or moved since the handoff */
+        upf_sess_t *sess = upf_sess_find_by_upf_n4_seid(msg->upf_n4_seid);
+        if (sess && upf_worker_owns(sess))
+            upf_gtp_send_multicast(sess, msg->pkbuf);
+        else
+            ogs_pkbuf_free(msg->pkbuf);
+    } else if (msg->sock)
+        _gtpv1_u_handle_pdu(msg->sock, msg->pkbuf, &msg->from);
+    else
+        _gtpv1_tun_handle_pdu(INVALID_SOCKET, false, msg->pkbuf);
+}
+
+static void rx_vector_clear(void)
+{
+    int i;
+
+    for (i = 0; i < OGS_MAX_NUM_OF_SOCKMSG; i++) {
+        if (rx_vector[i]) {
+            ogs_pkbuf_free(rx_vector[i]);
+            rx_vector[i] = NULL;
+        }
+    }
 }
 
 int upf_gtp_init(void)
@@ -730,10 +902,8 @@ int upf_gtp_init(void)
     config.cluster_2048_pool = ogs_app()->pool.packet;
 
 #if OGS_USE_TALLOC == 1
-    /* allocate a talloc pool for GTP to ensure it doesn't have to go back
-     * to the libc malloc all the time */
-    packet_pool = talloc_pool(__ogs_talloc_core, 1000*1024);
-    ogs_assert(packet_pool);
+    /* No talloc parent : see the per-thread magazines of ogs-pkbuf.c */
+    packet_pool = NULL;
 #else
     packet_pool = ogs_pkbuf_pool_create(&config);
 #endif
@@ -743,7 +913,17 @@ int upf_gtp_init(void)
 
 void upf_gtp_final(void)
 {
+    rx_vector_clear();
+
     ogs_pkbuf_pool_destroy(packet_pool);
+
+    /* After the pool, which hands the last UMEM frames back */
+    upf_xdp_final();
+}
+
+void upf_gtp_worker_final(void)
+{
+    rx_vector_clear();
 }
 
 static void _get_dev_mac_addr(char *ifname, uint8_t *mac_addr)
@@ -772,15 +952,99 @@ static void _get_dev_mac_addr(char *ifname, uint8_t *mac_addr)
 #endif
 }
 
+/*
+ * With data-plane workers, worker 0 polls the sockets and TUN queues
+ * kept in the GTP/PFCP context, and the other workers open their own
+ * sockets in the same SO_REUSEPORT group and their own TUN queues.
+ */
+static int worker_gtpu_open(void)
+{
+    upf_worker_t *worker = NULL;
+    ogs_socknode_t *node = NULL, *wnode = NULL;
+    ogs_sock_t *sock = NULL;
+    int i;
+
+    for (i = 1; i < upf_self()->num_of_worker; i++) {
+        worker = upf_worker_get(i);
+        ogs_assert(worker);
+
+        ogs_list_for_each(&ogs_gtp_self()->gtpu_list, node) {
+            wnode = ogs_socknode_add(&worker->gtpu_list,
+                    AF_UNSPEC, node->addr, node->option);
+            ogs_assert(wnode);
+
+            sock = ogs_gtp_server(wnode);
+            if (!sock) return OGS_ERROR;
+
+            wnode->poll = ogs_pollset_add(worker->pollset,
+                    OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
+            ogs_assert(wnode->poll);
+        }
+    }
+
+    ogs_list_for_each(&ogs_gtp_self()->gtpu_list, node) {
+        ogs_assert(node->sock);
+        if (upf_worker_steer_by_teid(node->sock) != OGS_OK)
+            ogs_warn("N3 packets are handed off to the owning worker");
+    }
+
+    return OGS_OK;
+}
+
+static int worker_tun_open(ogs_pfcp_dev_t *dev)
+{
+    upf_worker_t *worker = NULL;
+    ogs_socket_t fd;
+    int i;
+
+    for (i = 1; i < upf_self()->num_of_worker; i++) {
+        worker = upf_worker_get(i);
+        ogs_assert(worker);
+        ogs_assert(worker->num_of_tun < OGS_MAX_NUM_OF_DEV);
+
+        fd = ogs_tun_open_queue(dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
+        if (fd == INVALID_SOCKET) {
+            ogs_error("tun_open_queue(dev:%s) failed", dev->ifname);
+            return OGS_ERROR;
+        }
+
+        worker->tun[worker->num_of_tun].dev = dev;
+        worker->tun[worker->num_of_tun].fd = fd;
+        worker->tun[worker->num_of_tun].poll = ogs_pollset_add(
+                worker->pollset, OGS_POLLIN, fd,
+                dev->is_tap ? _gtpv1_tun_recv_eth_cb : _gtpv1_tun_recv_cb,
+                NULL);
+        ogs_assert(worker->tun[worker->num_of_tun].poll);
+
+        worker->num_of_tun++;
+    }
+
+    return OGS_OK;
+}
+
 int upf_gtp_open(void)
 {
     ogs_pfcp_dev_t *dev = NULL;
     ogs_pfcp_subnet_t *subnet = NULL;
     ogs_socknode_t *node = NULL;
     ogs_sock_t *sock = NULL;
+    ogs_pollset_t *pollset = NULL;
     int rc;
 
+    pollset = ogs_app()->pollset;
+    if (upf_self()->num_of_worker)
+        pollset = upf_worker_get(0)->pollset;
+
     ogs_list_for_each(&ogs_gtp_self()->gtpu_list, node) {
+        if (upf_self()->num_of_worker) {
+            if (!node->option) {
+                node->option = ogs_calloc(1, sizeof(ogs_sockopt_t));
+                ogs_assert(node->option);
+                ogs_sockopt_init(node->option);
+            }
+            node->option->so_reuseport = true;
+        }
+
         sock = ogs_gtp_server(node);
         if (!sock) return OGS_ERROR;
 
@@ -789,13 +1053,25 @@ int upf_gtp_open(void)
         else if (sock->family == AF_INET6)
             ogs_gtp_self()->gtpu_sock6 = sock;
 
-        node->poll = ogs_pollset_add(ogs_app()->pollset,
+        node->poll = ogs_pollset_add(pollset,
                 OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
         ogs_assert(node->poll);
     }
 
+    if (upf_self()->num_of_worker) {
+        rc = worker_gtpu_open();
+        if (rc != OGS_OK) return rc;
+    }
+
     OGS_SETUP_GTPU_SERVER;
 
+    if (upf_self()->xdp.dev[0]) {
+        rc = upf_xdp_open(packet_pool, _gtpv1_u_xdp_recv_cb);
+        if (rc != OGS_OK)
+            ogs_warn("AF_XDP unavailable on %s, N3 uses UDP sockets",
+                    upf_self()->xdp.dev);
+    }
+
     /* NOTE : tun device can be created via following command.
      *
      * $ sudo ip tuntap add name ogstun mode tun
@@ -810,7 +1086,12 @@ int upf_gtp_open(void)
     /* Open Tun interface */
     ogs_list_for_each(&ogs_pfcp_self()->dev_list, dev) {
         dev->is_tap = strstr(dev->ifname, "tap");
-        dev->fd = ogs_tun_open(dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
+        if (upf_self()->num_of_worker)
+            dev->fd = ogs_tun_open_queue(
+                    dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
+        else
+            dev->fd = ogs_tun_open(
+                    dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
         if (dev->fd == INVALID_SOCKET) {
             ogs_error("tun_open(dev:%s) failed", dev->ifname);
             return OGS_ERROR;
@@ -818,16 +1099,21 @@ int upf_gtp_open(void)
 
         if (dev->is_tap) {
             _get_dev_mac_addr(dev->ifname, dev->mac_addr);
-            dev->poll = ogs_pollset_add(ogs_app()->pollset,
+            dev->poll = ogs_pollset_add(pollset,
                     OGS_POLLIN, dev->fd, _gtpv1_tun_recv_eth_cb, NULL);
             ogs_assert(dev->poll);
         } else {
-            dev->poll = ogs_pollset_add(ogs_app()->pollset,
+            dev->poll = ogs_pollset_add(pollset,
                     OGS_POLLIN, dev->fd, _gtpv1_tun_recv_cb, NULL);
             ogs_assert(dev->poll);
         }
 
         ogs_assert(dev->poll);
+
+        if (upf_self()->num_of_worker) {
+            rc = worker_tun_open(dev);
+            if (rc != OGS_OK) return rc;
+        }
     }
 
     /*
@@ -856,6 +1142,24 @@ int upf_gtp_open(void)
 void upf_gtp_close(void)
 {
     ogs_pfcp_dev_t *dev = NULL;
+    upf_worker_t *worker = NULL;
+    int i, j;
+
+    upf_xdp_close();
+
+    for (i = 1; i < upf_self()->num_of_worker; i++) {
+        worker = upf_worker_get(i);
+        ogs_assert(worker);
+
+        ogs_socknode_remove_all(&worker->gtpu_list);
+
+        for (j = 0; j < worker->num_of_tun; j++) {
+            if (worker->tun[j].poll)
+                ogs_pollset_remove(worker->tun[j].poll);
+            ogs_closesocket(worker->tun[j].fd);
+        }
+        worker->num_of_tun = 0;
+    }
 
     ogs_socknode_remove_all(&ogs_gtp_self()->gtpu_list);
 
@@ -866,41 +1170,50 @@ void upf_gtp_close(void)
     }
 }
 
-static void upf_gtp_handle_multicast(ogs_pkbuf_t *recvbuf)
+/* Consumes 'sendbuf' : the first downlink PDR of the session forwards it */
+static void upf_gtp_send_multicast(upf_sess_t *sess, ogs_pkbuf_t *sendbuf)
 {
-    struct ip *ip_h =  NULL;
-    struct ip6_hdr *ip6_h = NULL;
     ogs_pfcp_user_plane_report_t report;
+    ogs_pfcp_pdr_t *pdr = NULL;
 
-    ip_h = (struct ip *)recvbuf->data;
-    if (ip_h->ip_v == 6) {
-#if COMPILE_ERROR_IN_MAC_OS_X  /* Compiler error in Mac OS X platform */
-        ip6_h = (struct ip6_hdr *)recvbuf->data;
-        if (IN6_IS_ADDR_MULTICAST(&ip6_h->ip6_dst))
-#else
-        struct in6_addr ip6_dst;
-        ip6_h = (struct ip6_hdr *)recvbuf->data;
-        memcpy(&ip6_dst, &ip6_h->ip6_dst, sizeof(struct in6_addr));
-        if (IN6_IS_ADDR_MULTICAST(&ip6_dst))
-#endif
-        {
+    ogs_assert(sess);
+    ogs_assert(sendbuf);
+
+    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
+        if (pdr->src_if == OGS_PFCP_INTERFACE_CORE) {
+            ogs_assert(true ==
+                ogs_pfcp_up_handle_pdr_nocopy(pdr,
+                    OGS_GTPU_MSGTYPE_GPDU, sendbuf, &report));
+            return;
+        }
+    }
+
+    ogs_pkbuf_free(sendbuf);
+}
+
+static void upf_gtp_handle_multicast(
+        ogs_pkbuf_t *recvbuf, ogs_pfcp_packet_info_t *info)
+{
+    ogs_assert(info);
+
+    if (info->version == 6) {
+        if (IN6_IS_ADDR_MULTICAST((struct in6_addr *)info->dst_addr)) {
             upf_sess_t *sess = NULL;
 
             /* IPv6 Multicast */
             ogs_list_for_each(&upf_self()->sess_list, sess) {
                 if (sess->ipv6) {
                     /* PDN IPv6 is avaiable */
-                    ogs_pfcp_pdr_t *pdr = NULL;
-
-                    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
-                        if (pdr->src_if == OGS_PFCP_INTERFACE_CORE) {
-                            ogs_assert(true ==
-                                ogs_pfcp_up_handle_pdr(pdr,
-                                    OGS_GTPU_MSGTYPE_GPDU, recvbuf, &report));
-                            break;
-                        }
+                    ogs_pkbuf_t *sendbuf = ogs_pkbuf_copy(recvbuf);
+                    ogs_assert(sendbuf);
+
+                    if (!upf_worker_owns(sess)) {
+                        if (!upf_worker_handoff_multicast(sess, sendbuf))
+                            ogs_pkbuf_free(sendbuf);
+                        return;
                     }
 
+                    upf_gtp_send_multicast(sess, sendbuf);
                     return;
                 }
             }
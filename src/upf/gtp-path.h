@@ -27,12 +27,17 @@
 extern "C" {
 #endif
 
+typedef struct upf_worker_msg_s upf_worker_msg_t;
+
 int upf_gtp_init(void);
 void upf_gtp_final(void);
+void upf_gtp_worker_final(void);
 
 int upf_gtp_open(void);
 void upf_gtp_close(void);
 
+void upf_gtp_handle_handoff(upf_worker_msg_t *msg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,7 @@
 #include "gtp-path.h"
 #include "pfcp-path.h"
 #include "metrics.h"
+#include "worker.h"
 
 static ogs_thread_t *thread;
 static void upf_main(void *data);
@@ -62,6 +63,9 @@ int upf_initialize(void)
     rv = ogs_pfcp_ue_pool_generate();
     if (rv != OGS_OK) return rv;
 
+    rv = upf_worker_init();
+    if (rv != OGS_OK) return rv;
+
     ogs_metrics_context_open(ogs_metrics_self());
 
     rv = upf_pfcp_open();
@@ -70,6 +74,9 @@ int upf_initialize(void)
     rv = upf_gtp_open();
     if (rv != OGS_OK) return rv;
 
+    rv = upf_worker_start();
+    if (rv != OGS_OK) return rv;
+
     thread = ogs_thread_create(upf_main, NULL);
     if (!thread) return OGS_ERROR;
 
@@ -86,6 +93,8 @@ void upf_terminate(void)
 
     ogs_thread_destroy(thread);
 
+    upf_worker_stop();
+
     upf_pfcp_close();
     upf_gtp_close();
 
@@ -98,8 +107,8 @@ void upf_terminate(void)
 
     ogs_pfcp_xact_final();
 
+    upf_worker_final();
     upf_gtp_final();
-    upf_event_final();
 
     upf_metrics_final();
 }
@@ -144,8 +153,15 @@ static void upf_main(void *data)
             ogs_fsm_dispatch(&upf_sm, e);
             upf_event_free(e);
         }
+
+        /* Buffered packets flushed or dropped by N4 requests */
+        upf_metrics_inst_global_add_buffer_stat();
+
+        /* Parked by a handler that changed session state, if any */
+        upf_worker_barrier_release();
     }
 done:
+    upf_worker_barrier_release();
 
     ogs_fsm_fini(&upf_sm, 0);
 }
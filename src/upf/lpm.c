@@ -0,0 +1,441 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lpm.h"
+
+#define LPM_ROOT_STRIDE 16
+#define LPM_STRIDE 8
+
+#define LPM_IPV4_BITS 32
+#define LPM_IPV6_BITS 128
+#define LPM_MAX_LEVEL (1 + (LPM_IPV6_BITS - LPM_ROOT_STRIDE) / LPM_STRIDE)
+
+typedef struct lpm_node_s lpm_node_t;
+
+typedef struct lpm_entry_s {
+    lpm_node_t *child;
+    void *data;             /* Longest prefix of this level, NULL : none */
+} lpm_entry_t;
+
+typedef struct lpm_rule_s {
+    ogs_lnode_t lnode;
+
+    uint32_t prefix[4];     /* host byte order */
+    int plen;
+    void *data;
+} lpm_rule_t;
+
+struct lpm_node_s {
+    lpm_entry_t *entry;
+    uint8_t *plen;          /* Prefix length of each entry */
+    int used;               /* Entries with data or child */
+
+    ogs_list_t rule_list;   /* Prefixes ending in this node */
+};
+
+struct upf_lpm_s {
+    int family;
+    int nbits;
+
+    lpm_node_t *root;
+};
+
+static int level_start(int level)
+{
+    return level ? LPM_ROOT_STRIDE + (level - 1) * LPM_STRIDE : 0;
+}
+
+static int level_stride(int level)
+{
+    return level ? LPM_STRIDE : LPM_ROOT_STRIDE;
+}
+
+/* Level in which a prefix of 'plen' bits is expanded */
+static int level_of(int plen)
+{
+    if (plen <= LPM_ROOT_STRIDE)
+        return 0;
+    return 1 + (plen - LPM_ROOT_STRIDE - 1) / LPM_STRIDE;
+}
+
+/* A stride never crosses a 32-bit word */
+static ogs_inline unsigned int lpm_index(const uint32_t *addr, int level)
+{
+    int start = level_start(level), stride = level_stride(level);
+
+    return (addr[start >> 5] >> (32 - (start & 31) - stride)) &
+        ((1U << stride) - 1);
+}
+
+static void lpm_mask(uint32_t *addr, int plen)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        if (plen >= 32)
+            plen -= 32;
+        else if (plen > 0) {
+            addr[i] &= ~(0xffffffffU >> plen);
+            plen = 0;
+        } else
+            addr[i] = 0;
+    }
+}
+
+static bool lpm_match(const uint32_t *a, const uint32_t *b, int plen)
+{
+    uint32_t x[4], y[4];
+
+    memcpy(x, a, sizeof(x));
+    memcpy(y, b, sizeof(y));
+    lpm_mask(x, plen);
+    lpm_mask(y, plen);
+
+    return memcmp(x, y, sizeof(x)) == 0;
+}
+
+static int route_to_prefix(upf_lpm_t *lpm,
+        ogs_ipsubnet_t *route, uint32_t *prefix)
+{
+    int i, plen = 0;
+
+    ogs_assert(route);
+
+    if (route->family != lpm->family) {
+        ogs_error("Invalid family [%d:%d]", route->family, lpm->family);
+        return -1;
+    }
+
+    memset(prefix, 0, sizeof(uint32_t) * 4);
+    for (i = 0; i < lpm->nbits / 32; i++) {
+        uint32_t mask = be32toh(route->mask[i]);
+
+        prefix[i] = be32toh(route->sub[i]) & mask;
+        while (mask & 0x80000000U) {
+            plen++;
+            mask <<= 1;
+        }
+        if (mask) {
+            ogs_error("Non-contiguous mask [%08x]", be32toh(route->mask[i]));
+            return -1;
+        }
+    }
+    lpm_mask(prefix, plen);
+
+    return plen;
+}
+
+static lpm_node_t *node_create(int level)
+{
+    lpm_node_t *node = NULL;
+    int num = 1 << level_stride(level);
+
+    node = ogs_calloc(1, sizeof(*node));
+    if (!node) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+    node->entry = ogs_calloc(num, sizeof(*node->entry));
+    node->plen = ogs_calloc(num, sizeof(*node->plen));
+    if (!node->entry || !node->plen) {
+        ogs_error("ogs_calloc() failed [num=%d]", num);
+        if (node->entry)
+            ogs_free(node->entry);
+        if (node->plen)
+            ogs_free(node->plen);
+        ogs_free(node);
+        return NULL;
+    }
+    ogs_list_init(&node->rule_list);
+
+    return node;
+}
+
+static void node_destroy(lpm_node_t *node, int level)
+{
+    lpm_rule_t *rule = NULL, *next_rule = NULL;
+    int i, num = 1 << level_stride(level);
+
+    if (!node)
+        return;
+
+    for (i = 0; i < num && node->used; i++) {
+        if (node->entry[i].child)
+            node_destroy(node->entry[i].child, level + 1);
+    }
+    ogs_list_for_each_safe(&node->rule_list, next_rule, rule) {
+        ogs_list_remove(&node->rule_list, rule);
+        ogs_free(rule);
+    }
+
+    ogs_free(node->plen);
+    ogs_free(node->entry);
+    ogs_free(node);
+}
+
+/* Release the nodes left empty from 'node' at 'level' up to the root */
+static void lpm_prune(upf_lpm_t *lpm, lpm_node_t **path,
+        const uint32_t *prefix, lpm_node_t *node, int level)
+{
+    lpm_entry_t *entry = NULL;
+    int l;
+
+    for (l = level; l > 0 && !node->used; l--) {
+        node_destroy(node, l);
+
+        node = path[l - 1];
+        entry = &node->entry[lpm_index(prefix, l - 1)];
+        entry->child = NULL;
+        if (!entry->data)
+            node->used--;
+    }
+    if (!lpm->root->used) {
+        node_destroy(lpm->root, 0);
+        lpm->root = NULL;
+    }
+}
+
+upf_lpm_t *upf_lpm_create(int family)
+{
+    upf_lpm_t *lpm = NULL;
+
+    ogs_assert(family == AF_INET || family == AF_INET6);
+
+    lpm = ogs_calloc(1, sizeof(*lpm));
+    if (!lpm) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+
+    lpm->family = family;
+    lpm->nbits = family == AF_INET ? LPM_IPV4_BITS : LPM_IPV6_BITS;
+
+    return lpm;
+}
+
+void upf_lpm_destroy(upf_lpm_t *lpm)
+{
+    ogs_assert(lpm);
+
+    node_destroy(lpm->root, 0);
+    ogs_free(lpm);
+}
+
+int upf_lpm_add(upf_lpm_t *lpm, ogs_ipsubnet_t *route, void *data)
+{
+    lpm_node_t *path[LPM_MAX_LEVEL];
+    lpm_node_t *node = NULL;
+    lpm_entry_t *entry = NULL;
+    lpm_rule_t *rule = NULL;
+    uint32_t prefix[4];
+    unsigned int i, first, num;
+    int plen, level, l;
+
+    ogs_assert(lpm);
+    ogs_assert(data);
+
+    plen = route_to_prefix(lpm, route, prefix);
+    if (plen < 0)
+        return OGS_ERROR;
+
+    if (!lpm->root) {
+        lpm->root = node_create(0);
+        if (!lpm->root)
+            return OGS_ERROR;
+    }
+
+    level = level_of(plen);
+
+    node = lpm->root;
+    for (l = 0; l < level; l++) {
+        path[l] = node;
+        entry = &node->entry[lpm_index(prefix, l)];
+        if (!entry->child) {
+            entry->child = node_create(l + 1);
+            if (!entry->child) {
+                /* Give back the nodes created for this prefix */
+                lpm_prune(lpm, path, prefix, node, l);
+                return OGS_ERROR;
+            }
+            if (!entry->data)
+                node->used++;
+        }
+        node = entry->child;
+    }
+
+    ogs_list_for_each(&node->rule_list, rule) {
+        if (rule->plen == plen &&
+            memcmp(rule->prefix, prefix, sizeof(prefix)) == 0)
+            break;
+    }
+    if (!rule) {
+        rule = ogs_calloc(1, sizeof(*rule));
+        if (!rule) {
+            ogs_error("ogs_calloc() failed");
+            lpm_prune(lpm, path, prefix, node, level);
+            return OGS_ERROR;
+        }
+        memcpy(rule->prefix, prefix, sizeof(prefix));
+        rule->plen = plen;
+        ogs_list_add(&node->rule_list, rule);
+    }
+    rule->data = data;
+
+    /* Longer prefixes of the same level keep their entries */
+    first = lpm_index(prefix, level);
+    num = 1U << (level_start(level) + level_stride(level) - plen);
+    for (i = first; i < first + num; i++) {
+        entry = &node->entry[i];
+        if (entry->data && node->plen[i] > plen)
+            continue;
+        if (!entry->data && !entry->child)
+            node->used++;
+        entry->data = data;
+        node->plen[i] = plen;
+    }
+
+    return OGS_OK;
+}
+
+void upf_lpm_remove(upf_lpm_t *lpm, ogs_ipsubnet_t *route, void *data)
+{
+    lpm_node_t *path[LPM_MAX_LEVEL];
+    lpm_node_t *node = NULL;
+    lpm_entry_t *entry = NULL;
+    lpm_rule_t *rule = NULL, *shorter = NULL;
+    uint32_t prefix[4];
+    unsigned int i, first, num;
+    int plen, level, l;
+
+    ogs_assert(lpm);
+
+    plen = route_to_prefix(lpm, route, prefix);
+    if (plen < 0)
+        return;
+
+    level = level_of(plen);
+
+    node = lpm->root;
+    for (l = 0; node && l < level; l++) {
+        path[l] = node;
+        node = node->entry[lpm_index(prefix, l)].child;
+    }
+    if (!node)
+        return;
+
+    ogs_list_for_each(&node->rule_list, rule) {
+        if (rule->plen == plen &&
+            memcmp(rule->prefix, prefix, sizeof(prefix)) == 0)
+            break;
+    }
+    /* Another session may have taken the same prefix over */
+    if (!rule || rule->data != data)
+        return;
+
+    ogs_list_remove(&node->rule_list, rule);
+    ogs_free(rule);
+
+    ogs_list_for_each(&node->rule_list, rule) {
+        if (rule->plen < plen && (!shorter || rule->plen > shorter->plen) &&
+            lpm_match(rule->prefix, prefix, rule->plen))
+            shorter = rule;
+    }
+
+    first = lpm_index(prefix, level);
+    num = 1U << (level_start(level) + level_stride(level) - plen);
+    for (i = first; i < first + num; i++) {
+        entry = &node->entry[i];
+        if (!entry->data || node->plen[i] != plen)
+            continue;
+        if (shorter) {
+            entry->data = shorter->data;
+            node->plen[i] = shorter->plen;
+        } else {
+            entry->data = NULL;
+            node->plen[i] = 0;
+            if (!entry->child)
+                node->used--;
+        }
+    }
+
+    lpm_prune(lpm, path, prefix, node, level);
+}
+
+void *upf_lpm_find(upf_lpm_t *lpm, const uint32_t *addr)
+{
+    lpm_node_t *node = NULL;
+    lpm_entry_t *entry = NULL;
+    uint32_t key[4];
+    void *data = NULL;
+    int i, l;
+
+    ogs_assert(lpm);
+    ogs_assert(addr);
+
+    node = lpm->root;
+    if (!node)
+        return NULL;
+
+    for (i = 0; i < lpm->nbits / 32; i++)
+        key[i] = be32toh(addr[i]);
+
+    /* Deeper levels only hold longer prefixes */
+    for (l = 0; node; l++) {
+        entry = &node->entry[lpm_index(key, l)];
+        if (entry->data)
+            data = entry->data;
+        node = entry->child;
+    }
+
+    return data;
+}
+
+bool upf_lpm_match(upf_lpm_t *lpm, const uint32_t *addr,
+        void *data, ogs_ipsubnet_t *routes, int num_of_route)
+{
+    void *found = NULL;
+    int i, j;
+
+    ogs_assert(lpm);
+    ogs_assert(addr);
+    ogs_assert(data);
+
+    found = upf_lpm_find(lpm, addr);
+    if (found == data)
+        return true;
+    if (!routes)
+        return false;
+
+    /*
+     * A longer prefix of another owner, or the same prefix taken over
+     * by another owner and removed since, which leaves no entry at all
+     */
+    for (i = 0; i < num_of_route && routes[i].family; i++) {
+        if (routes[i].family != lpm->family)
+            continue;
+
+        for (j = 0; j < lpm->nbits / 32; j++)
+            if (routes[i].sub[j] != (addr[j] & routes[i].mask[j]))
+                break;
+        if (j == lpm->nbits / 32)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPF_LPM_H
+#define UPF_LPM_H
+
+#include "ogs-core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Longest Prefix Match
+ *
+ * Multibit trie with a 16-bit first level followed by 8-bit levels.
+ * Each prefix is expanded over the entries of the level it ends in,
+ * so an IPv4 lookup visits at most 3 nodes and an IPv6 /64 at most 7.
+ *
+ * The prefixes ending in a node are kept with it, so that removing one
+ * gives its entries back to the next shorter prefix of the same node.
+ * Adding a prefix that already exists replaces its data.
+ */
+typedef struct upf_lpm_s upf_lpm_t;
+
+upf_lpm_t *upf_lpm_create(int family);
+void upf_lpm_destroy(upf_lpm_t *lpm);
+
+int upf_lpm_add(upf_lpm_t *lpm, ogs_ipsubnet_t *route, void *data);
+void upf_lpm_remove(upf_lpm_t *lpm, ogs_ipsubnet_t *route, void *data);
+
+/* Address in network byte order */
+void *upf_lpm_find(upf_lpm_t *lpm, const uint32_t *addr);
+
+/*
+ * True if 'addr' is in one of the 'routes' of 'data'. The table only
+ * answers for the longest prefix and its last owner, so the routes
+ * are scanned whenever it does not point to 'data'.
+ */
+bool upf_lpm_match(upf_lpm_t *lpm, const uint32_t *addr,
+        void *data, ogs_ipsubnet_t *routes, int num_of_route);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UPF_LPM_H */
@@ -61,6 +61,46 @@ upf_metrics_spec_def_t upf_metrics_spec_def_global[_UPF_METR_GLOB_MAX] = {
     .name = "fivegs_ep_n3_gtp_outdatapktn3upf",
     .description = "Number of outgoing GTP data packets on the N3 interface",
 },
+[UPF_METR_GLOB_CTR_GTP_N3_RECVPKT] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_n3_gtp_recvpkt",
+    .description = "Number of GTP-U packets received on the N3 interface",
+},
+[UPF_METR_GLOB_CTR_GTP_N3_RECVSYSCALL] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_n3_gtp_recvsyscall",
+    .description = "Number of receive system calls on the N3 interface",
+},
+[UPF_METR_GLOB_CTR_GTP_N3_SENDPKT] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_n3_gtp_sendpkt",
+    .description = "Number of GTP-U packets sent in bursts on the N3 interface",
+},
+[UPF_METR_GLOB_CTR_GTP_N3_SENDSYSCALL] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_n3_gtp_sendsyscall",
+    .description = "Number of send system calls on the N3 interface",
+},
+[UPF_METR_GLOB_CTR_DL_BUFFERED] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_dl_buffered_pkt",
+    .description = "Number of downlink packets buffered for idle UEs",
+},
+[UPF_METR_GLOB_CTR_DL_BUFFER_DROPPED] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_dl_buffer_dropped_pkt",
+    .description = "Number of buffered downlink packets dropped",
+},
+[UPF_METR_GLOB_CTR_DL_BUFFER_FLUSHED] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_dl_buffer_flushed_pkt",
+    .description = "Number of buffered downlink packets forwarded",
+},
+[UPF_METR_GLOB_CTR_HAIRPINPKT] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "upf_hairpin_pkt",
+    .description = "Number of UE-to-UE packets forwarded without the TUN device",
+},
 [UPF_METR_GLOB_CTR_SM_N4SESSIONESTABREQ] = {
     .type = OGS_METRICS_METRIC_TYPE_COUNTER,
     .name = "fivegs_upffunction_sm_n4sessionestabreq",
@@ -93,6 +133,23 @@ int upf_metrics_free_inst_global(void)
     return upf_metrics_free_inst(upf_metrics_inst_global, _UPF_METR_GLOB_MAX);
 }
 
+void upf_metrics_inst_global_add_buffer_stat(void)
+{
+    ogs_pfcp_buffer_stat_t stat;
+
+    ogs_pfcp_buffer_stat(&stat);
+
+    if (stat.buffered)
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_DL_BUFFERED, stat.buffered);
+    if (stat.dropped)
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_DL_BUFFER_DROPPED, stat.dropped);
+    if (stat.flushed)
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_DL_BUFFER_FLUSHED, stat.flushed);
+}
+
 /* BY_QFI */
 const char *labels_qfi[] = {
     "qfi"
@@ -106,7 +163,13 @@ const char *labels_qfi[] = {
         .labels = labels_qfi, \
     },
 ogs_metrics_spec_t *upf_metrics_spec_by_qfi[_UPF_METR_BY_QFI_MAX];
-ogs_hash_t *metrics_hash_by_qfi = NULL;   /* hash table for QFI label */
+/*
+ * QFI labels are resolved to an instance only once, since these
+ * counters are updated for every packet, possibly by several workers.
+ */
+static ogs_metrics_inst_t *metrics_inst_by_qfi
+    [OGS_MAX_QOS_FLOW_ID+1][_UPF_METR_BY_QFI_MAX];
+static ogs_thread_mutex_t metrics_mutex_by_qfi;
 upf_metrics_spec_def_t upf_metrics_spec_def_by_qfi[_UPF_METR_BY_QFI_MAX] = {
 /* Counters: */
 UPF_METR_BY_QFI_CTR_ENTRY(
@@ -120,44 +183,42 @@ UPF_METR_BY_QFI_CTR_ENTRY(
 };
 void upf_metrics_init_by_qfi(void);
 int upf_metrics_free_inst_by_qfi(ogs_metrics_inst_t **inst);
-typedef struct upf_metric_key_by_qfi_s {
-    uint8_t                     qfi;
-    upf_metric_type_by_qfi_t    t;
-} upf_metric_key_by_qfi_t;
 
 void upf_metrics_init_by_qfi(void)
 {
-    metrics_hash_by_qfi = ogs_hash_make();
-    ogs_assert(metrics_hash_by_qfi);
+    memset(metrics_inst_by_qfi, 0, sizeof(metrics_inst_by_qfi));
+    ogs_thread_mutex_init(&metrics_mutex_by_qfi);
 }
+
 void upf_metrics_inst_by_qfi_add(uint8_t qfi,
         upf_metric_type_by_qfi_t t, int val)
 {
     ogs_metrics_inst_t *metrics = NULL;
-    upf_metric_key_by_qfi_t *qfi_key;
 
-    qfi_key = ogs_calloc(1, sizeof(*qfi_key));
-    ogs_assert(qfi_key);
+    ogs_assert(t < _UPF_METR_BY_QFI_MAX);
+    if (qfi > OGS_MAX_QOS_FLOW_ID) {
+        ogs_error("Invalid QFI [%d]", qfi);
+        return;
+    }
 
-    qfi_key->qfi = qfi;
-    qfi_key->t = t;
+    metrics = ogs_atomic_load(&metrics_inst_by_qfi[qfi][t]);
+    if (!metrics) {
+        ogs_thread_mutex_lock(&metrics_mutex_by_qfi);
 
-    metrics = ogs_hash_get(metrics_hash_by_qfi,
-            qfi_key, sizeof(*qfi_key));
+        metrics = metrics_inst_by_qfi[qfi][t];
+        if (!metrics) {
+            char qfi_str[4];
+            ogs_snprintf(qfi_str, sizeof(qfi_str), "%d", qfi);
 
-    if (!metrics) {
-        char qfi_str[4];
-        ogs_snprintf(qfi_str, sizeof(qfi_str), "%d", qfi);
+            metrics = ogs_metrics_inst_new(upf_metrics_spec_by_qfi[t],
+                    upf_metrics_spec_def_by_qfi->num_labels,
+                    (const char *[]){ qfi_str });
+            ogs_assert(metrics);
 
-        metrics = ogs_metrics_inst_new(upf_metrics_spec_by_qfi[t],
-                upf_metrics_spec_def_by_qfi->num_labels,
-                (const char *[]){ qfi_str });
+            ogs_atomic_store(&metrics_inst_by_qfi[qfi][t], metrics);
+        }
 
-        ogs_assert(metrics);
-        ogs_hash_set(metrics_hash_by_qfi,
-                qfi_key, sizeof(*qfi_key), metrics);
-    } else {
-        ogs_free(qfi_key);
+        ogs_thread_mutex_unlock(&metrics_mutex_by_qfi);
     }
 
     ogs_metrics_inst_add(metrics, val);
@@ -340,21 +401,12 @@ void upf_metrics_final(void)
 {
     ogs_hash_index_t *hi;
 
-    if (metrics_hash_by_qfi) {
-        for (hi = ogs_hash_first(metrics_hash_by_qfi); hi; hi = ogs_hash_next(hi)) {
-            upf_metric_key_by_qfi_t *key =
-                (upf_metric_key_by_qfi_t *)ogs_hash_this_key(hi);
-            //void *val = ogs_hash_this_val(hi);
-
-            ogs_hash_set(metrics_hash_by_qfi, key, sizeof(*key), NULL);
+    /*
+     * The instances by QFI will be free'd by ogs_metrics_context_final()
+     */
+    memset(metrics_inst_by_qfi, 0, sizeof(metrics_inst_by_qfi));
+    ogs_thread_mutex_destroy(&metrics_mutex_by_qfi);
 
-            ogs_free(key);
-            /* don't free val (metric itself) -
-             * it will be free'd by ogs_metrics_context_final() */
-            //ogs_free(val);
-        }
-        ogs_hash_destroy(metrics_hash_by_qfi);
-    }
     if (metrics_hash_by_cause) {
         for (hi = ogs_hash_first(metrics_hash_by_cause); hi; hi = ogs_hash_next(hi)) {
             upf_metric_key_by_cause_t *key =
@@ -11,6 +11,14 @@ extern "C" {
 typedef enum upf_metric_type_global_s {
     UPF_METR_GLOB_CTR_GTP_INDATAPKTN3UPF = 0,
     UPF_METR_GLOB_CTR_GTP_OUTDATAPKTN3UPF,
+    UPF_METR_GLOB_CTR_GTP_N3_RECVPKT,
+    UPF_METR_GLOB_CTR_GTP_N3_RECVSYSCALL,
+    UPF_METR_GLOB_CTR_GTP_N3_SENDPKT,
+    UPF_METR_GLOB_CTR_GTP_N3_SENDSYSCALL,
+    UPF_METR_GLOB_CTR_DL_BUFFERED,
+    UPF_METR_GLOB_CTR_DL_BUFFER_DROPPED,
+    UPF_METR_GLOB_CTR_DL_BUFFER_FLUSHED,
+    UPF_METR_GLOB_CTR_HAIRPINPKT,
     UPF_METR_GLOB_CTR_SM_N4SESSIONESTABREQ,
     UPF_METR_GLOB_CTR_SM_N4SESSIONREPORT,
     UPF_METR_GLOB_CTR_SM_N4SESSIONREPORTSUCC,
@@ -31,6 +39,9 @@ static inline void upf_metrics_inst_global_inc(upf_metric_type_global_t t)
 static inline void upf_metrics_inst_global_dec(upf_metric_type_global_t t)
 { ogs_metrics_inst_dec(upf_metrics_inst_global[t]); }
 
+/* Adds the downlink buffering counters of the calling thread */
+void upf_metrics_inst_global_add_buffer_stat(void);
+
 /* BY QFI */
 typedef enum upf_metric_type_by_qfi_s {
     UPF_METR_CTR_GTP_INDATAVOLUMEQOSLEVELN3UPF = 0,
@@ -21,6 +21,7 @@
 #include "pfcp-path.h"
 #include "gtp-path.h"
 #include "n4-handler.h"
+#include "worker.h"
 
 static void upf_n4_handle_create_urr(upf_sess_t *sess, ogs_pfcp_tlv_create_urr_t *create_urr_arr,
                               uint8_t *cause_value, uint8_t *offending_ie_value)
@@ -191,6 +192,13 @@ void upf_n4_handle_session_establishment_request(
                     OGS_PFCP_OBJ_SESS_TYPE, pdr, restoration_indication);
     }
 
+    /* Compile the PDRs for the data path */
+    ogs_pfcp_classifier_build(&sess->pfcp);
+
+    /* Select the data-plane worker owning this session */
+    upf_worker_assign(sess);
+    upf_sess_set_hairpin(sess);
+
     /* Send Buffered Packet to gNB/SGW */
     ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
         if (pdr->src_if == OGS_PFCP_INTERFACE_CORE) { /* Downlink */
@@ -321,9 +329,14 @@ void upf_n4_handle_session_modification_request(
         goto cleanup;
 
     for (i = 0; i < OGS_MAX_NUM_OF_URR; i++) {
-        if (ogs_pfcp_handle_update_urr(&sess->pfcp, &req->update_urr[i],
-                    &cause_value, &offending_ie_value) == NULL)
+        ogs_pfcp_urr_t *urr = ogs_pfcp_handle_update_urr(
+                &sess->pfcp, &req->update_urr[i],
+                &cause_value, &offending_ie_value);
+        if (!urr)
             break;
+
+        /* Volume quota/threshold may have changed */
+        upf_sess_urr_acc_check_reset(sess, urr);
     }
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
         goto cleanup;
@@ -369,6 +382,11 @@ void upf_n4_handle_session_modification_request(
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
         goto cleanup;
 
+    ogs_pfcp_handle_update_bar(&sess->pfcp, &req->update_bar,
+            &cause_value, &offending_ie_value);
+    if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
+        goto cleanup;
+
     ogs_pfcp_handle_remove_bar(&sess->pfcp, &req->remove_bar,
             &cause_value, &offending_ie_value);
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
@@ -394,6 +412,13 @@ void upf_n4_handle_session_modification_request(
             ogs_pfcp_object_teid_hash_set(OGS_PFCP_OBJ_SESS_TYPE, pdr, false);
     }
 
+    /* Compile the PDRs for the data path */
+    ogs_pfcp_classifier_build(&sess->pfcp);
+
+    /* Select the data-plane worker owning this session */
+    upf_worker_assign(sess);
+    upf_sess_set_hairpin(sess);
+
     /* Send Buffered Packet to gNB/SGW */
     ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
         if (pdr->src_if == OGS_PFCP_INTERFACE_CORE) { /* Downlink */
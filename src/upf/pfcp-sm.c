@@ -24,6 +24,7 @@
 
 #include "pfcp-path.h"
 #include "n4-handler.h"
+#include "worker.h"
 
 static void pfcp_restoration(ogs_pfcp_node_t *node);
 static void node_timeout(ogs_pfcp_xact_t *xact, void *data);
@@ -281,6 +282,7 @@ void upf_pfcp_state_associated(ogs_fsm_t *s, upf_event_t *e)
                     &message->pfcp_association_setup_response);
             break;
         case OGS_PFCP_SESSION_ESTABLISHMENT_REQUEST_TYPE:
+            upf_worker_barrier_sync();
             sess = upf_sess_add_by_message(message);
             if (sess)
                 OGS_SETUP_PFCP_NODE(sess, node);
@@ -288,10 +290,12 @@ void upf_pfcp_state_associated(ogs_fsm_t *s, upf_event_t *e)
                 sess, xact, &message->pfcp_session_establishment_request);
             break;
         case OGS_PFCP_SESSION_MODIFICATION_REQUEST_TYPE:
+            upf_worker_barrier_sync();
             upf_n4_handle_session_modification_request(
                 sess, xact, &message->pfcp_session_modification_request);
             break;
         case OGS_PFCP_SESSION_DELETION_REQUEST_TYPE:
+            upf_worker_barrier_sync();
             upf_n4_handle_session_deletion_request(
                 sess, xact, &message->pfcp_session_deletion_request);
             break;
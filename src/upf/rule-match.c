@@ -17,51 +17,50 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#define _DEFAULT_SOURCE 1
-#define _BSD_SOURCE     1
-
 #include "rule-match.h"
 
-#if HAVE_NETINET_IP_H
-#include <netinet/ip.h>
-#endif
-
-#if HAVE_NETINET_IP6_H
-#include <netinet/ip6.h>
-#endif
-
-upf_sess_t *upf_sess_find_by_ue_ip_address(ogs_pkbuf_t *pkbuf)
+upf_sess_t *upf_sess_find_by_ue_ip_address(ogs_pfcp_packet_info_t *info)
 {
     upf_sess_t *sess = NULL;
 
     char buf[OGS_ADDRSTRLEN];
 
-    struct ip *ip_h = NULL;
-    struct ip6_hdr *ip6_h = NULL;
+    ogs_assert(info);
 
-    ogs_assert(pkbuf);
-    ogs_assert(pkbuf->len);
-    ogs_assert(pkbuf->data);
-
-    ip_h = (struct ip *)pkbuf->data;
-    if (ip_h->ip_v == 4) {
-        ip_h = (struct ip *)pkbuf->data;
-        sess = upf_sess_find_by_ipv4(ip_h->ip_dst.s_addr);
-    } else if (ip_h->ip_v == 6) {
-        ip6_h = (struct ip6_hdr *)pkbuf->data;
-        sess = upf_sess_find_by_ipv6((uint32_t *)ip6_h->ip6_dst.s6_addr);
-    } else {
-        ogs_error("Invalid packet [IP version:%d, Packet Length:%d]",
-                ip_h->ip_v, pkbuf->len);
-        ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
-    }
+    if (info->version == 4)
+        sess = upf_sess_find_by_ipv4(info->dst_addr[0]);
+    else if (info->version == 6)
+        sess = upf_sess_find_by_ipv6(info->dst_addr);
 
     if (sess) {
-        if (ip_h && sess->ipv4)
+        if (info->version == 4 && sess->ipv4)
             ogs_trace("PAA IPv4:%s", OGS_INET_NTOP(&sess->ipv4->addr, buf));
-        if (ip6_h && sess->ipv6)
+        if (info->version == 6 && sess->ipv6)
             ogs_trace("PAA IPv6:%s", OGS_INET6_NTOP(&sess->ipv6->addr, buf));
     }
 
     return sess;
 }
+
+/*
+ * The table slots of the whole burst are prefetched before the first
+ * lookup, so that their cache misses overlap instead of adding up.
+ */
+void upf_sess_find_burst_by_ue_ip_address(
+        ogs_pfcp_packet_info_t *info, upf_sess_t **sess, int num)
+{
+    int i;
+
+    ogs_assert(info);
+    ogs_assert(sess);
+
+    for (i = 0; i < num; i++) {
+        if (info[i].version == 4)
+            upf_sess_prefetch_by_ipv4(info[i].dst_addr[0]);
+        else if (info[i].version == 6)
+            upf_sess_prefetch_by_ipv6(info[i].dst_addr);
+    }
+
+    for (i = 0; i < num; i++)
+        sess[i] = upf_sess_find_by_ue_ip_address(&info[i]);
+}
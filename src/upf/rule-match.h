@@ -26,7 +26,9 @@
 extern "C" {
 #endif
 
-upf_sess_t *upf_sess_find_by_ue_ip_address(ogs_pkbuf_t *pkbuf);
+upf_sess_t *upf_sess_find_by_ue_ip_address(ogs_pfcp_packet_info_t *info);
+void upf_sess_find_burst_by_ue_ip_address(
+        ogs_pfcp_packet_info_t *info, upf_sess_t **sess, int num);
 
 #ifdef __cplusplus
 }
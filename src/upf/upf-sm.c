@@ -22,6 +22,7 @@
 #include "event.h"
 #include "pfcp-path.h"
 #include "gtp-path.h"
+#include "worker.h"
 
 void upf_state_initial(ogs_fsm_t *s, upf_event_t *e)
 {
@@ -42,12 +43,16 @@ void upf_state_final(ogs_fsm_t *s, upf_event_t *e)
 void upf_state_operational(ogs_fsm_t *s, upf_event_t *e)
 {
     int rv;
+    unsigned int i;
     ogs_pkbuf_t *recvbuf = NULL;
 
     ogs_pfcp_message_t *pfcp_message = NULL;
     ogs_pfcp_node_t *node = NULL;
     ogs_pfcp_xact_t *xact = NULL;
 
+    upf_sess_t *sess = NULL;
+    ogs_pfcp_urr_t *urr = NULL;
+
     upf_sm_debug(e);
 
     ogs_assert(s);
@@ -104,6 +109,30 @@ void upf_state_operational(ogs_fsm_t *s, upf_event_t *e)
 
         ogs_fsm_dispatch(&node->sm, e);
         break;
+    case UPF_EVT_N4_SESSION_REPORT:
+        /* Report raised by a data-plane worker */
+        ogs_assert(e->report);
+
+        sess = upf_sess_find_by_upf_n4_seid(e->upf_n4_seid);
+        if (!sess) {
+            ogs_warn("Session has already been removed");
+            ogs_free(e->report);
+            break;
+        }
+
+        ogs_assert(OGS_OK ==
+            upf_pfcp_send_session_report_request(sess, e->report));
+
+        /* Start new report period/iteration: */
+        upf_worker_barrier_sync();
+        for (i = 0; i < e->report->num_of_usage_report; i++) {
+            urr = ogs_pfcp_urr_find(&sess->pfcp, e->report->usage_report[i].id);
+            if (urr)
+                upf_sess_urr_acc_timers_setup(sess, urr);
+        }
+
+        ogs_free(e->report);
+        break;
     default:
         ogs_error("No handler for event %s", upf_event_get_name(e));
         break;
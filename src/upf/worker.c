@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "context.h"
+
+#if HAVE_LINUX_FILTER_H
+#include <linux/filter.h>
+#endif
+
+#include "event.h"
+#include "gtp-path.h"
+#include "worker.h"
+
+static upf_worker_t worker[UPF_MAX_NUM_OF_WORKER];
+static int num_of_worker;
+
+static ogs_thread_local upf_worker_t *self_worker;
+
+/*
+ * Worker Barrier
+ *
+ * The main thread raises 'requested' and waits until every worker
+ * has parked itself. Workers only check the flag between two bursts,
+ * so the fast path never takes a lock.
+ *
+ * It is taken on demand by the handlers that change session state,
+ * so timers and wakeups that leave it alone never stop the workers.
+ */
+static struct {
+    ogs_thread_mutex_t mutex;
+    ogs_thread_cond_t release;
+    ogs_thread_cond_t parked;
+
+    int requested;
+    int num_of_parked;
+
+    bool running;   /* Workers are started and not stopped yet */
+    bool held;      /* Only read and written by the main thread */
+} barrier;
+
+static void worker_main(void *data);
+
+int upf_worker_init(void)
+{
+    int i;
+
+    num_of_worker = upf_self()->num_of_worker;
+    ogs_assert(num_of_worker >= 0 && num_of_worker <= UPF_MAX_NUM_OF_WORKER);
+
+    if (!num_of_worker)
+        return OGS_OK;
+
+    ogs_thread_mutex_init(&barrier.mutex);
+    ogs_thread_cond_init(&barrier.release);
+    ogs_thread_cond_init(&barrier.parked);
+
+    for (i = 0; i < num_of_worker; i++) {
+        int j;
+
+        memset(&worker[i], 0, sizeof(worker[i]));
+        worker[i].id = i;
+
+        worker[i].pollset = ogs_pollset_create(ogs_app()->pool.socket);
+        if (!worker[i].pollset) {
+            ogs_error("ogs_pollset_create() failed");
+            return OGS_ERROR;
+        }
+
+        worker[i].queue = ogs_queue_create(UPF_WORKER_QUEUE_SIZE);
+        if (!worker[i].queue) {
+            ogs_error("ogs_queue_create() failed");
+            return OGS_ERROR;
+        }
+
+        worker[i].free_queue = ogs_queue_create(UPF_WORKER_QUEUE_SIZE);
+        if (!worker[i].free_queue) {
+            ogs_error("ogs_queue_create() failed");
+            return OGS_ERROR;
+        }
+
+        worker[i].msg = ogs_calloc(
+                UPF_WORKER_QUEUE_SIZE, sizeof(upf_worker_msg_t));
+        if (!worker[i].msg) {
+            ogs_error("ogs_calloc() failed");
+            return OGS_ERROR;
+        }
+        for (j = 0; j < UPF_WORKER_QUEUE_SIZE; j++)
+            ogs_assert(OGS_OK == ogs_queue_trypush(
+                        worker[i].free_queue, &worker[i].msg[j]));
+    }
+
+    return OGS_OK;
+}
+
+void upf_worker_final(void)
+{
+    int i;
+
+    if (!num_of_worker)
+        return;
+
+    for (i = 0; i < num_of_worker; i++) {
+        if (worker[i].queue) {
+            upf_worker_msg_t *msg = NULL;
+
+            while (ogs_queue_trypop(worker[i].queue, (void **)&msg) == OGS_OK)
+                ogs_pkbuf_free(msg->pkbuf);
+            ogs_queue_destroy(worker[i].queue);
+        }
+        if (worker[i].free_queue)
+            ogs_queue_destroy(worker[i].free_queue);
+        if (worker[i].msg)
+            ogs_free(worker[i].msg);
+        if (worker[i].pollset)
+            ogs_pollset_destroy(worker[i].pollset);
+    }
+
+    ogs_thread_cond_destroy(&barrier.parked);
+    ogs_thread_cond_destroy(&barrier.release);
+    ogs_thread_mutex_destroy(&barrier.mutex);
+
+    num_of_worker = 0;
+}
+
+int upf_worker_start(void)
+{
+    int i;
+
+    for (i = 0; i < num_of_worker; i++) {
+        worker[i].thread = ogs_thread_create(worker_main, &worker[i]);
+        if (!worker[i].thread) {
+            ogs_error("ogs_thread_create() failed");
+            return OGS_ERROR;
+        }
+    }
+
+    if (num_of_worker) {
+        barrier.running = true;
+        ogs_info("%d data-plane workers started", num_of_worker);
+    }
+
+    return OGS_OK;
+}
+
+void upf_worker_stop(void)
+{
+    int i;
+
+    barrier.running = false;
+
+    for (i = 0; i < num_of_worker; i++) {
+        if (!worker[i].thread)
+            continue;
+
+        ogs_queue_term(worker[i].queue);
+        ogs_pollset_notify(worker[i].pollset);
+
+        ogs_thread_destroy(worker[i].thread);
+        worker[i].thread = NULL;
+    }
+}
+
+upf_worker_t *upf_worker_get(int id)
+{
+    ogs_assert(id >= 0 && id < num_of_worker);
+    return &worker[id];
+}
+
+upf_worker_t *upf_worker_self(void)
+{
+    return self_worker;
+}
+
+void upf_worker_barrier_sync(void)
+{
+    int i;
+
+    if (!barrier.running || barrier.held)
+        return;
+
+    barrier.held = true;
+
+    ogs_thread_mutex_lock(&barrier.mutex);
+    ogs_atomic_store(&barrier.requested, 1);
+    ogs_thread_mutex_unlock(&barrier.mutex);
+
+    /* Wake up the workers sleeping in ogs_pollset_poll() */
+    for (i = 0; i < num_of_worker; i++)
+        ogs_pollset_notify(worker[i].pollset);
+
+    ogs_thread_mutex_lock(&barrier.mutex);
+    while (barrier.num_of_parked < num_of_worker)
+        ogs_thread_cond_wait(&barrier.parked, &barrier.mutex);
+    ogs_thread_mutex_unlock(&barrier.mutex);
+}
+
+void upf_worker_barrier_release(void)
+{
+    if (!barrier.held)
+        return;
+
+    barrier.held = false;
+
+    ogs_thread_mutex_lock(&barrier.mutex);
+    ogs_atomic_store(&barrier.requested, 0);
+    ogs_thread_cond_broadcast(&barrier.release);
+    ogs_thread_mutex_unlock(&barrier.mutex);
+}
+
+static void barrier_wait(void)
+{
+    if (!ogs_atomic_load(&barrier.requested))
+        return;
+
+    ogs_thread_mutex_lock(&barrier.mutex);
+
+    barrier.num_of_parked++;
+    ogs_thread_cond_signal(&barrier.parked);
+
+    while (barrier.requested)
+        ogs_thread_cond_wait(&barrier.release, &barrier.mutex);
+
+    barrier.num_of_parked--;
+
+    ogs_thread_mutex_unlock(&barrier.mutex);
+}
+
+/*
+ * The owner follows the first uplink TEID of the session, which is
+ * also what the SO_REUSEPORT steering program uses to pick the socket.
+ * Sessions without an uplink TEID are spread by their UPF-N4-SEID.
+ */
+void upf_worker_assign(upf_sess_t *sess)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+
+    ogs_assert(sess);
+
+    if (!num_of_worker)
+        return;
+
+    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
+        if (pdr->src_if == OGS_PFCP_INTERFACE_ACCESS && pdr->f_teid_len) {
+            sess->worker_id = pdr->f_teid.teid % num_of_worker;
+            return;
+        }
+    }
+
+    sess->worker_id = sess->upf_n4_seid % num_of_worker;
+}
+
+bool upf_worker_owns(upf_sess_t *sess)
+{
+    ogs_assert(sess);
+
+    /* The main thread only touches a session with every worker parked */
+    if (!self_worker)
+        return true;
+
+    return sess->worker_id == self_worker->id;
+}
+
+static bool worker_handoff(upf_sess_t *sess, ogs_pkbuf_t *pkbuf,
+        ogs_sock_t *sock, ogs_sockaddr_t *from, uint64_t upf_n4_seid)
+{
+    upf_worker_t *owner = NULL;
+    upf_worker_msg_t *msg = NULL;
+
+    ogs_assert(sess);
+    ogs_assert(pkbuf);
+
+    owner = upf_worker_get(sess->worker_id);
+    ogs_assert(owner != self_worker);
+
+    /* The queue has room for every message taken from the free list */
+    if (ogs_queue_trypop(owner->free_queue, (void **)&msg) != OGS_OK)
+        return false;
+
+    ogs_assert(msg);
+    msg->pkbuf = pkbuf;
+    msg->sock = sock;
+    if (from)
+        memcpy(&msg->from, from, sizeof(msg->from));
+    msg->upf_n4_seid = upf_n4_seid;
+
+    /* Only fails once the owner is stopping */
+    if (ogs_queue_trypush(owner->queue, msg) != OGS_OK) {
+        ogs_assert(OGS_OK == ogs_queue_trypush(owner->free_queue, msg));
+        return false;
+    }
+
+    /* Only the first packet since the owner last drained needs a wakeup */
+    if (ogs_atomic_exchange(&owner->notified, 1) == 0)
+        ogs_pollset_notify(owner->pollset);
+
+    return true;
+}
+
+bool upf_worker_handoff(upf_sess_t *sess,
+        ogs_pkbuf_t *pkbuf, ogs_sock_t *sock, ogs_sockaddr_t *from)
+{
+    return worker_handoff(sess, pkbuf, sock, from, 0);
+}
+
+/*
+ * The destination of a multicast packet does not lead to the session,
+ * so the owner is told which session the copy is for.
+ */
+bool upf_worker_handoff_multicast(upf_sess_t *sess, ogs_pkbuf_t *pkbuf)
+{
+    ogs_assert(sess);
+
+    return worker_handoff(sess, pkbuf, NULL, NULL, sess->upf_n4_seid);
+}
+
+/*
+ * Classic BPF program for the SO_REUSEPORT group of an N3 address.
+ *
+ * It returns 'TEID % number of workers' as the socket index, so that
+ * the uplink of a session is received by the worker that owns it.
+ * The sockets of the group are bound in worker order.
+ */
+int upf_worker_steer_by_teid(ogs_sock_t *sock)
+{
+#if HAVE_LINUX_FILTER_H && defined(SO_ATTACH_REUSEPORT_CBPF)
+    int rc;
+    struct sock_filter code[] = {
+        /* A = TEID (offset 4 of the UDP payload) */
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 4),
+        /* A = A % number of workers */
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, 0),
+        /* Return A as the index of the socket */
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct sock_fprog prog;
+
+    ogs_assert(sock);
+    ogs_assert(num_of_worker);
+
+    code[1].k = num_of_worker;
+
+    prog.len = OGS_ARRAY_SIZE(code);
+    prog.filter = code;
+
+    rc = setsockopt(sock->fd, SOL_SOCKET,
+            SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog));
+    if (rc != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "setsockopt(SO_ATTACH_REUSEPORT_CBPF) failed");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+#else
+    ogs_error("SO_ATTACH_REUSEPORT_CBPF is not supported on this platform");
+    return OGS_ERROR;
+#endif
+}
+
+int upf_worker_post_session_report(
+        upf_sess_t *sess, ogs_pfcp_user_plane_report_t *report)
+{
+    int rv;
+    upf_event_t *e = NULL;
+
+    ogs_assert(sess);
+    ogs_assert(report);
+
+    e = upf_event_new(UPF_EVT_N4_SESSION_REPORT);
+    ogs_assert(e);
+
+    e->upf_n4_seid = sess->upf_n4_seid;
+    e->report = ogs_memdup(report, sizeof(*report));
+    ogs_assert(e->report);
+
+    /*
+     * Never block here : the main thread may be waiting
+     * in upf_worker_barrier_sync() for this worker to park.
+     */
+    rv = ogs_queue_trypush(ogs_app()->queue, e);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_queue_trypush() failed:%d", (int)rv);
+        ogs_free(e->report);
+        upf_event_free(e);
+        return OGS_ERROR;
+    }
+
+    ogs_pollset_notify(ogs_app()->pollset);
+
+    return OGS_OK;
+}
+
+static int worker_drain(upf_worker_t *worker)
+{
+    int rv;
+    upf_worker_msg_t *msg = NULL;
+    ogs_gtp_burst_stat_t stat;
+
+    ogs_atomic_store(&worker->notified, 0);
+
+    upf_sess_urr_acc_clock_update();
+    ogs_gtp_burst_begin();
+
+    for ( ;; ) {
+        rv = ogs_queue_trypop(worker->queue, (void **)&msg);
+        ogs_assert(rv != OGS_ERROR);
+
+        if (rv != OGS_OK)
+            break;
+
+        ogs_assert(msg);
+        upf_gtp_handle_handoff(msg);
+        ogs_assert(OGS_OK == ogs_queue_trypush(worker->free_queue, msg));
+    }
+
+    ogs_gtp_burst_end(&stat);
+
+    if (stat.syscalls) {
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDSYSCALL, stat.syscalls);
+        upf_metrics_inst_global_add(
+                UPF_METR_GLOB_CTR_GTP_N3_SENDPKT, stat.pkts);
+    }
+
+    upf_metrics_inst_global_add_buffer_stat();
+
+    return rv;
+}
+
+static void worker_main(void *data)
+{
+    upf_worker_t *worker = data;
+
+    ogs_assert(worker);
+    self_worker = worker;
+
+    for ( ;; ) {
+        ogs_pollset_poll(worker->pollset, OGS_INFINITE_TIME);
+
+        barrier_wait();
+
+        if (worker_drain(worker) == OGS_DONE)
+            break;
+    }
+
+    upf_gtp_worker_final();
+    self_worker = NULL;
+}
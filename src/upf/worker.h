@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPF_WORKER_H
+#define UPF_WORKER_H
+
+#include "context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPF_MAX_NUM_OF_WORKER 64
+#define UPF_WORKER_QUEUE_SIZE 8192
+
+/*
+ * Data-plane worker
+ *
+ * Each worker polls its own N3 socket (one per GTP-U address, bound with
+ * SO_REUSEPORT) and its own queue of every multi-queue TUN device.
+ *
+ * A session is owned by exactly one worker, which is the only thread
+ * that touches its PDR/FAR/URR state while the data plane is running.
+ * Packets received by any other worker are handed off to the owner.
+ *
+ * The main thread (PFCP and timers) only modifies session state inside
+ * upf_worker_barrier_sync()/upf_worker_barrier_release(), while every
+ * worker is parked between two bursts. Handlers call
+ * upf_worker_barrier_sync() right before such a change; the main loop
+ * releases the workers once its events have been processed.
+ */
+typedef struct upf_worker_s {
+    int id;
+
+    ogs_thread_t *thread;
+    ogs_pollset_t *pollset;
+
+    ogs_queue_t *queue;     /* Packets handed off by other workers */
+    int notified;           /* Pollset has been notified for the queue */
+
+    /* Messages of the queue, allocated once and recycled */
+    struct upf_worker_msg_s *msg;
+    ogs_queue_t *free_queue;
+
+    ogs_list_t gtpu_list;   /* N3 sockets (SO_REUSEPORT) */
+
+    struct {
+        ogs_pfcp_dev_t *dev;
+        ogs_socket_t fd;
+        ogs_poll_t *poll;
+    } tun[OGS_MAX_NUM_OF_DEV];
+    int num_of_tun;
+} upf_worker_t;
+
+typedef struct upf_worker_msg_s {
+    ogs_pkbuf_t *pkbuf;
+
+    ogs_sock_t *sock;       /* N3 socket, NULL for N6 packets */
+    ogs_sockaddr_t from;
+
+    uint64_t upf_n4_seid;   /* Multicast copy for this session, or 0 */
+} upf_worker_msg_t;
+
+int upf_worker_init(void);
+void upf_worker_final(void);
+
+int upf_worker_start(void);
+void upf_worker_stop(void);
+
+upf_worker_t *upf_worker_get(int id);
+upf_worker_t *upf_worker_self(void);
+
+void upf_worker_barrier_sync(void);
+void upf_worker_barrier_release(void);
+
+void upf_worker_assign(upf_sess_t *sess);
+bool upf_worker_owns(upf_sess_t *sess);
+bool upf_worker_handoff(upf_sess_t *sess,
+        ogs_pkbuf_t *pkbuf, ogs_sock_t *sock, ogs_sockaddr_t *from);
+bool upf_worker_handoff_multicast(upf_sess_t *sess, ogs_pkbuf_t *pkbuf);
+
+int upf_worker_steer_by_teid(ogs_sock_t *sock);
+
+int upf_worker_post_session_report(
+        upf_sess_t *sess, ogs_pfcp_user_plane_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UPF_WORKER_H */
@@ -0,0 +1,823 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "context.h"
+
+#if HAVE_LINUX_IF_XDP_H && HAVE_LINUX_BPF_H
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <net/ethernet.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#endif
+
+#include "gtp-path.h"
+#include "worker.h"
+#include "xdp-path.h"
+
+#if HAVE_LINUX_IF_XDP_H && HAVE_LINUX_BPF_H
+
+#define XSK_FRAME_SIZE      OGS_MAX_PKT_LEN
+#define XSK_NUM_OF_FRAME    4096
+#define XSK_RX_RING_SIZE    2048
+#define XSK_COMP_RING_SIZE  64
+
+typedef struct upf_xsk_ring_s {
+    uint32_t *producer;
+    uint32_t *consumer;
+    void *desc;
+    uint32_t mask;
+
+    void *map;
+    size_t map_len;
+} upf_xsk_ring_t;
+
+struct upf_xsk_s {
+    int queue_id;
+    bool zerocopy;
+
+    ogs_socket_t fd;
+    ogs_poll_t *poll;
+
+    unsigned char *umem;
+    upf_xsk_ring_t rx;
+    upf_xsk_ring_t fill;
+
+    /* Frames are returned to the fill ring by whichever thread frees them */
+    ogs_thread_mutex_t mutex;
+    int num_of_held;    /* Frames attached to a pkbuf */
+};
+
+static struct {
+    ogs_pkbuf_pool_t *pool;
+
+    unsigned int ifindex;
+    int map_fd;
+    int addr_fd;        /* IPv4 GTP-U addresses */
+    int addr6_fd;       /* IPv6 GTP-U addresses */
+    int prog_fd;
+    int link_fd;
+
+    upf_xsk_t xsk[UPF_MAX_NUM_OF_XDP_QUEUE];
+    int num_of_xsk;
+} xdp = {
+    .map_fd = -1,
+    .addr_fd = -1,
+    .addr6_fd = -1,
+    .prog_fd = -1,
+    .link_fd = -1,
+};
+
+static int bpf_syscall(int cmd, union bpf_attr *attr)
+{
+    return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static int xdp_map_create(uint32_t map_type,
+        uint32_t key_size, int max_entries, uint32_t map_flags)
+{
+    union bpf_attr attr;
+    int fd;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = map_type;
+    attr.key_size = key_size;
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = max_entries;
+    attr.map_flags = map_flags;
+
+    fd = bpf_syscall(BPF_MAP_CREATE, &attr);
+    if (fd < 0)
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "bpf(BPF_MAP_CREATE) failed");
+
+    return fd;
+}
+
+static int xdp_map_update(int map_fd, const void *key, uint32_t value)
+{
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = map_fd;
+    attr.key = (uint64_t)(uintptr_t)key;
+    attr.value = (uint64_t)(uintptr_t)&value;
+    attr.flags = BPF_ANY;
+
+    if (bpf_syscall(BPF_MAP_UPDATE_ELEM, &attr) != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                "bpf(BPF_MAP_UPDATE_ELEM) failed");
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+/*
+ * GTP-U addresses
+ *
+ * One LPM trie per family, keyed by the destination address, so that
+ * only datagrams to a configured 'upf.gtpu' address are redirected.
+ * A wildcard address is stored with a zero prefix and matches all.
+ */
+typedef struct xdp_addr_key_s {
+    uint32_t prefixlen;
+    uint8_t addr[OGS_IPV6_LEN];
+} xdp_addr_key_t;
+
+static int xdp_addr_open(void)
+{
+    ogs_socknode_t *node = NULL;
+    ogs_sockaddr_t *addr = NULL;
+    xdp_addr_key_t key;
+    int num_of_addr = 0, num_of_addr6 = 0;
+    int fd;
+
+    ogs_list_for_each(&ogs_gtp_self()->gtpu_list, node) {
+        for (addr = node->addr; addr; addr = addr->next) {
+            if (addr->ogs_sa_family == AF_INET)
+                num_of_addr++;
+            else if (addr->ogs_sa_family == AF_INET6)
+                num_of_addr6++;
+        }
+    }
+
+    /* An empty trie still has to exist, it just never matches */
+    xdp.addr_fd = xdp_map_create(BPF_MAP_TYPE_LPM_TRIE,
+            sizeof(uint32_t) + OGS_IPV4_LEN, ogs_max(num_of_addr, 1),
+            BPF_F_NO_PREALLOC);
+    if (xdp.addr_fd < 0) return OGS_ERROR;
+
+    xdp.addr6_fd = xdp_map_create(BPF_MAP_TYPE_LPM_TRIE,
+            sizeof(uint32_t) + OGS_IPV6_LEN, ogs_max(num_of_addr6, 1),
+            BPF_F_NO_PREALLOC);
+    if (xdp.addr6_fd < 0) return OGS_ERROR;
+
+    ogs_list_for_each(&ogs_gtp_self()->gtpu_list, node) {
+        for (addr = node->addr; addr; addr = addr->next) {
+            memset(&key, 0, sizeof(key));
+
+            if (addr->ogs_sa_family == AF_INET) {
+                if (addr->sin.sin_addr.s_addr != INADDR_ANY)
+                    key.prefixlen = OGS_IPV4_LEN * 8;
+                memcpy(key.addr, &addr->sin.sin_addr, OGS_IPV4_LEN);
+                fd = xdp.addr_fd;
+            } else if (addr->ogs_sa_family == AF_INET6) {
+                if (!IN6_IS_ADDR_UNSPECIFIED(&addr->sin6.sin6_addr))
+                    key.prefixlen = OGS_IPV6_LEN * 8;
+                memcpy(key.addr, &addr->sin6.sin6_addr, OGS_IPV6_LEN);
+                fd = xdp.addr6_fd;
+            } else
+                continue;
+
+            if (xdp_map_update(fd, &key, 1) != OGS_OK)
+                return OGS_ERROR;
+        }
+    }
+
+    return OGS_OK;
+}
+
+/*
+ * XDP program
+ *
+ * Redirects UDP datagrams to the GTP-U port of a GTP-U address to the
+ * AF_XDP socket of the receiving queue. IPv4 packets with options or
+ * fragments, and anything else, are passed to the kernel stack, as are
+ * packets received on a queue without a socket (the XDP_PASS flag of
+ * bpf_redirect_map()).
+ *
+ * The program is assembled here, so that neither clang nor libbpf is
+ * needed at build time. Jumps are relative to the next instruction.
+ */
+#define XDP_INSN(_code, _dst, _src, _off, _imm) \
+    { (_code), (_dst), (_src), (_off), (_imm) }
+#define XDP_JMP(_pc, _target) ((_target) - (_pc) - 1)
+
+#define XDP_PROG_IPV4       10
+#define XDP_PROG_IPV6       30
+#define XDP_PROG_LOOKUP     50
+#define XDP_PROG_REDIRECT   52
+#define XDP_PROG_PASS       58
+
+static int xdp_prog_load(int map_fd, int addr_fd, int addr6_fd, uint16_t port)
+{
+    struct bpf_insn insn[] = {
+        /* 0: r6 = ctx, r2 = data_end, r3 = data */
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_6, BPF_REG_1, 0, 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_1,
+                offsetof(struct xdp_md, data_end), 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_3, BPF_REG_1,
+                offsetof(struct xdp_md, data), 0),
+
+        /* 3: Ethernet */
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0,
+                ETHER_HDR_LEN),
+        XDP_INSN(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_2,
+                XDP_JMP(5, XDP_PROG_PASS), 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_3, 12, 0),
+        XDP_INSN(BPF_JMP | BPF_JEQ | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(7, XDP_PROG_IPV4), htons(ETHERTYPE_IP)),
+        XDP_INSN(BPF_JMP | BPF_JEQ | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(8, XDP_PROG_IPV6), htons(ETHERTYPE_IPV6)),
+        XDP_INSN(BPF_JMP | BPF_JA, 0, 0, XDP_JMP(9, XDP_PROG_PASS), 0),
+
+        /* 10: IPv4 without options and not fragmented, UDP to the port */
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0,
+                ETHER_HDR_LEN + 20 + 8),
+        XDP_INSN(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_2,
+                XDP_JMP(12, XDP_PROG_PASS), 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_B, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN, 0),
+        XDP_INSN(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(14, XDP_PROG_PASS), 0x45),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 6, 0),
+        XDP_INSN(BPF_ALU64 | BPF_AND | BPF_K, BPF_REG_5, 0, 0,
+                htons(0x3fff)),
+        XDP_INSN(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(17, XDP_PROG_PASS), 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_B, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 9, 0),
+        XDP_INSN(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(19, XDP_PROG_PASS), IPPROTO_UDP),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 20 + 2, 0),
+        XDP_INSN(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(21, XDP_PROG_PASS), htons(port)),
+
+        /* 22: r2 = fp-8 = { 32, destination address } for the IPv4 trie */
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 16, 0),
+        XDP_INSN(BPF_STX | BPF_MEM | BPF_W, BPF_REG_10, BPF_REG_5, -4, 0),
+        XDP_INSN(BPF_ST | BPF_MEM | BPF_W, BPF_REG_10, 0, -8,
+                OGS_IPV4_LEN * 8),
+        XDP_INSN(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD,
+                0, addr_fd),
+        XDP_INSN(0, 0, 0, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_2, BPF_REG_10, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_2, 0, 0, -8),
+        XDP_INSN(BPF_JMP | BPF_JA, 0, 0, XDP_JMP(29, XDP_PROG_LOOKUP), 0),
+
+        /* 30: IPv6 without extension headers, UDP to the port */
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_4, BPF_REG_3, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_4, 0, 0,
+                ETHER_HDR_LEN + 40 + 8),
+        XDP_INSN(BPF_JMP | BPF_JGT | BPF_X, BPF_REG_4, BPF_REG_2,
+                XDP_JMP(32, XDP_PROG_PASS), 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_B, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 6, 0),
+        XDP_INSN(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(34, XDP_PROG_PASS), IPPROTO_UDP),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_H, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 40 + 2, 0),
+        XDP_INSN(BPF_JMP | BPF_JNE | BPF_K, BPF_REG_5, 0,
+                XDP_JMP(36, XDP_PROG_PASS), htons(port)),
+
+        /* 37: r2 = fp-20 = { 128, destination address } for the IPv6 trie */
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 24, 0),
+        XDP_INSN(BPF_STX | BPF_MEM | BPF_W, BPF_REG_10, BPF_REG_5, -16, 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 28, 0),
+        XDP_INSN(BPF_STX | BPF_MEM | BPF_W, BPF_REG_10, BPF_REG_5, -12, 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 32, 0),
+        XDP_INSN(BPF_STX | BPF_MEM | BPF_W, BPF_REG_10, BPF_REG_5, -8, 0),
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_5, BPF_REG_3,
+                ETHER_HDR_LEN + 36, 0),
+        XDP_INSN(BPF_STX | BPF_MEM | BPF_W, BPF_REG_10, BPF_REG_5, -4, 0),
+        XDP_INSN(BPF_ST | BPF_MEM | BPF_W, BPF_REG_10, 0, -20,
+                OGS_IPV6_LEN * 8),
+        XDP_INSN(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD,
+                0, addr6_fd),
+        XDP_INSN(0, 0, 0, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_X, BPF_REG_2, BPF_REG_10, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_ADD | BPF_K, BPF_REG_2, 0, 0, -20),
+
+        /* 50: pass unless the destination is a GTP-U address */
+        XDP_INSN(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_map_lookup_elem),
+        XDP_INSN(BPF_JMP | BPF_JEQ | BPF_K, BPF_REG_0, 0,
+                XDP_JMP(51, XDP_PROG_PASS), 0),
+
+        /* 52: return bpf_redirect_map(map, ctx->rx_queue_index, XDP_PASS) */
+        XDP_INSN(BPF_LDX | BPF_MEM | BPF_W, BPF_REG_2, BPF_REG_6,
+                offsetof(struct xdp_md, rx_queue_index), 0),
+        XDP_INSN(BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD,
+                0, map_fd),
+        XDP_INSN(0, 0, 0, 0, 0),
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS),
+        XDP_INSN(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+        XDP_INSN(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+
+        /* 58: return XDP_PASS */
+        XDP_INSN(BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_0, 0, 0, XDP_PASS),
+        XDP_INSN(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+    };
+    static char log_buf[4096];
+    union bpf_attr attr;
+    int fd;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (uint64_t)(uintptr_t)insn;
+    attr.insn_cnt = OGS_ARRAY_SIZE(insn);
+    attr.license = (uint64_t)(uintptr_t)"GPL";
+    attr.log_buf = (uint64_t)(uintptr_t)log_buf;
+    attr.log_size = sizeof(log_buf);
+    attr.log_level = 1;
+
+    log_buf[0] = '\0';
+    fd = bpf_syscall(BPF_PROG_LOAD, &attr);
+    if (fd < 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "bpf(BPF_PROG_LOAD) failed");
+        if (log_buf[0])
+            ogs_error("%s", log_buf);
+    }
+
+    return fd;
+}
+
+static int xdp_prog_attach(int prog_fd, unsigned int ifindex)
+{
+    union bpf_attr attr;
+    int fd;
+
+    /* Prefer the driver hook, the generic one works on any device */
+    memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = prog_fd;
+    attr.link_create.target_ifindex = ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = XDP_FLAGS_DRV_MODE;
+
+    fd = bpf_syscall(BPF_LINK_CREATE, &attr);
+    if (fd >= 0)
+        return fd;
+
+    attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+
+    fd = bpf_syscall(BPF_LINK_CREATE, &attr);
+    if (fd < 0)
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                "bpf(BPF_LINK_CREATE) failed");
+
+    return fd;
+}
+
+static int xsk_ring_mmap(upf_xsk_t *xsk, upf_xsk_ring_t *ring,
+        struct xdp_ring_offset *off, uint32_t size, size_t entry_size,
+        off_t pgoff)
+{
+    ring->map_len = off->desc + size * entry_size;
+    ring->map = mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, xsk->fd, pgoff);
+    if (ring->map == MAP_FAILED) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "mmap(XDP ring) failed");
+        ring->map = NULL;
+        return OGS_ERROR;
+    }
+
+    ring->producer = (uint32_t *)((char *)ring->map + off->producer);
+    ring->consumer = (uint32_t *)((char *)ring->map + off->consumer);
+    ring->desc = (char *)ring->map + off->desc;
+    ring->mask = size - 1;
+
+    return OGS_OK;
+}
+
+/* The fill ring can hold every frame of the UMEM, so it never overflows */
+static void xsk_fill(upf_xsk_t *xsk, uint64_t addr)
+{
+    upf_xsk_ring_t *fill = &xsk->fill;
+    uint32_t prod;
+
+    ogs_thread_mutex_lock(&xsk->mutex);
+
+    prod = *fill->producer;
+    ((uint64_t *)fill->desc)[prod & fill->mask] = addr;
+    ogs_atomic_store(fill->producer, prod + 1);
+
+    ogs_thread_mutex_unlock(&xsk->mutex);
+}
+
+static void xsk_frame_free(unsigned char *buf, void *data)
+{
+    upf_xsk_t *xsk = data;
+
+    ogs_assert(xsk);
+    ogs_assert(buf >= xsk->umem);
+
+    xsk_fill(xsk, buf - xsk->umem);
+    ogs_atomic_dec(&xsk->num_of_held);
+}
+
+static void xsk_close(upf_xsk_t *xsk)
+{
+    ogs_assert(xsk);
+
+    if (xsk->poll) {
+        ogs_pollset_remove(xsk->poll);
+        xsk->poll = NULL;
+    }
+
+    /* Frames still referenced by a pkbuf keep the socket and UMEM alive */
+    if (ogs_atomic_load(&xsk->num_of_held)) {
+        ogs_warn("AF_XDP queue %d : %d frames still in use",
+                xsk->queue_id, xsk->num_of_held);
+        return;
+    }
+
+    if (xsk->rx.map)
+        munmap(xsk->rx.map, xsk->rx.map_len);
+    if (xsk->fill.map)
+        munmap(xsk->fill.map, xsk->fill.map_len);
+    if (xsk->fd != INVALID_SOCKET)
+        ogs_closesocket(xsk->fd);
+    if (xsk->umem)
+        munmap(xsk->umem, XSK_NUM_OF_FRAME * XSK_FRAME_SIZE);
+
+    ogs_thread_mutex_destroy(&xsk->mutex);
+
+    memset(xsk, 0, sizeof(*xsk));
+    xsk->fd = INVALID_SOCKET;
+}
+
+static int xsk_open(upf_xsk_t *xsk, int queue_id, uint16_t bind_flags)
+{
+    struct xdp_umem_reg umem_reg;
+    struct xdp_mmap_offsets off;
+    struct sockaddr_xdp sxdp;
+    socklen_t optlen;
+    int size, i;
+
+    ogs_assert(xsk);
+
+    memset(xsk, 0, sizeof(*xsk));
+    xsk->queue_id = queue_id;
+    xsk->fd = INVALID_SOCKET;
+    ogs_thread_mutex_init(&xsk->mutex);
+
+    xsk->umem = mmap(NULL, XSK_NUM_OF_FRAME * XSK_FRAME_SIZE,
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (xsk->umem == MAP_FAILED) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno, "mmap(UMEM) failed");
+        xsk->umem = NULL;
+        goto cleanup;
+    }
+
+    xsk->fd = socket(AF_XDP, SOCK_RAW, 0);
+    if (xsk->fd == INVALID_SOCKET) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "socket(AF_XDP) failed");
+        goto cleanup;
+    }
+
+    /* Keep the same headroom as the socket path for the tunnel headers */
+    memset(&umem_reg, 0, sizeof(umem_reg));
+    umem_reg.addr = (uint64_t)(uintptr_t)xsk->umem;
+    umem_reg.len = XSK_NUM_OF_FRAME * XSK_FRAME_SIZE;
+    umem_reg.chunk_size = XSK_FRAME_SIZE;
+    umem_reg.headroom = OGS_TUN_MAX_HEADROOM;
+
+    if (setsockopt(xsk->fd, SOL_XDP, XDP_UMEM_REG,
+                &umem_reg, sizeof(umem_reg)) != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "setsockopt(XDP_UMEM_REG) failed");
+        goto cleanup;
+    }
+
+    size = XSK_NUM_OF_FRAME;
+    if (setsockopt(xsk->fd, SOL_XDP, XDP_UMEM_FILL_RING,
+                &size, sizeof(size)) != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "setsockopt(XDP_UMEM_FILL_RING) failed");
+        goto cleanup;
+    }
+    /* Nothing is transmitted, but bind() requires a completion ring */
+    size = XSK_COMP_RING_SIZE;
+    if (setsockopt(xsk->fd, SOL_XDP, XDP_UMEM_COMPLETION_RING,
+                &size, sizeof(size)) != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "setsockopt(XDP_UMEM_COMPLETION_RING) failed");
+        goto cleanup;
+    }
+    size = XSK_RX_RING_SIZE;
+    if (setsockopt(xsk->fd, SOL_XDP, XDP_RX_RING,
+                &size, sizeof(size)) != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "setsockopt(XDP_RX_RING) failed");
+        goto cleanup;
+    }
+
+    optlen = sizeof(off);
+    if (getsockopt(xsk->fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) != 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "getsockopt(XDP_MMAP_OFFSETS) failed");
+        goto cleanup;
+    }
+
+    if (xsk_ring_mmap(xsk, &xsk->rx, &off.rx, XSK_RX_RING_SIZE,
+                sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) != OGS_OK)
+        goto cleanup;
+    if (xsk_ring_mmap(xsk, &xsk->fill, &off.fr, XSK_NUM_OF_FRAME,
+                sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) != OGS_OK)
+        goto cleanup;
+
+    memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_ifindex = xdp.ifindex;
+    sxdp.sxdp_queue_id = queue_id;
+    sxdp.sxdp_flags = bind_flags;
+
+    if (bind(xsk->fd, (struct sockaddr *)&sxdp, sizeof(sxdp)) != 0) {
+        ogs_log_message(
+                bind_flags & XDP_ZEROCOPY ? OGS_LOG_DEBUG : OGS_LOG_ERROR,
+                ogs_socket_errno, "bind(AF_XDP, queue:%d, flags:0x%x) failed",
+                queue_id, bind_flags);
+        goto cleanup;
+    }
+    xsk->zerocopy = bind_flags & XDP_ZEROCOPY;
+
+    for (i = 0; i < XSK_NUM_OF_FRAME; i++)
+        xsk_fill(xsk, (uint64_t)i * XSK_FRAME_SIZE);
+
+    return OGS_OK;
+
+cleanup:
+    xsk_close(xsk);
+    return OGS_ERROR;
+}
+
+int upf_xdp_open(ogs_pkbuf_pool_t *pool, ogs_poll_handler_f handler)
+{
+    const char *dev = upf_self()->xdp.dev;
+    int num_of_queue = upf_self()->xdp.num_of_queue;
+    ogs_pollset_t *pollset = NULL;
+    int i;
+
+    ogs_assert(handler);
+    ogs_assert(num_of_queue > 0 && num_of_queue <= UPF_MAX_NUM_OF_XDP_QUEUE);
+
+    xdp.pool = pool;
+
+    xdp.ifindex = if_nametoindex(dev);
+    if (!xdp.ifindex) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_errno,
+                "if_nametoindex(%s) failed", dev);
+        goto cleanup;
+    }
+
+    xdp.map_fd = xdp_map_create(BPF_MAP_TYPE_XSKMAP,
+            sizeof(uint32_t), num_of_queue, 0);
+    if (xdp.map_fd < 0) goto cleanup;
+
+    if (xdp_addr_open() != OGS_OK) goto cleanup;
+
+    xdp.prog_fd = xdp_prog_load(xdp.map_fd,
+            xdp.addr_fd, xdp.addr6_fd, ogs_gtp_self()->gtpu_port);
+    if (xdp.prog_fd < 0) goto cleanup;
+
+    for (i = 0; i < num_of_queue; i++) {
+        pollset = ogs_app()->pollset;
+        if (upf_self()->num_of_worker)
+            pollset = upf_worker_get(i % upf_self()->num_of_worker)->pollset;
+
+        /* Zero-copy needs driver support, veth and many others only copy */
+        if (xsk_open(&xdp.xsk[i], i, XDP_ZEROCOPY) != OGS_OK &&
+            xsk_open(&xdp.xsk[i], i, XDP_COPY) != OGS_OK)
+            goto cleanup;
+
+        xdp.num_of_xsk++;
+
+        if (xdp_map_update(xdp.map_fd, &i, xdp.xsk[i].fd) != OGS_OK)
+            goto cleanup;
+
+        xdp.xsk[i].poll = ogs_pollset_add(pollset,
+                OGS_POLLIN, xdp.xsk[i].fd, handler, &xdp.xsk[i]);
+        ogs_assert(xdp.xsk[i].poll);
+    }
+
+    xdp.link_fd = xdp_prog_attach(xdp.prog_fd, xdp.ifindex);
+    if (xdp.link_fd < 0) goto cleanup;
+
+    ogs_info("AF_XDP on %s : %d queues (%s)", dev, xdp.num_of_xsk,
+            xdp.xsk[0].zerocopy ? "zero-copy" : "copy");
+
+    return OGS_OK;
+
+cleanup:
+    upf_xdp_close();
+    upf_xdp_final();
+
+    return OGS_ERROR;
+}
+
+/* Detach the program so that N3 falls back to the kernel sockets */
+void upf_xdp_close(void)
+{
+    int i;
+
+    for (i = 0; i < xdp.num_of_xsk; i++) {
+        if (xdp.xsk[i].poll) {
+            ogs_pollset_remove(xdp.xsk[i].poll);
+            xdp.xsk[i].poll = NULL;
+        }
+    }
+
+    if (xdp.link_fd >= 0) {
+        close(xdp.link_fd);
+        xdp.link_fd = -1;
+    }
+    if (xdp.prog_fd >= 0) {
+        close(xdp.prog_fd);
+        xdp.prog_fd = -1;
+    }
+    if (xdp.map_fd >= 0) {
+        close(xdp.map_fd);
+        xdp.map_fd = -1;
+    }
+    if (xdp.addr_fd >= 0) {
+        close(xdp.addr_fd);
+        xdp.addr_fd = -1;
+    }
+    if (xdp.addr6_fd >= 0) {
+        close(xdp.addr6_fd);
+        xdp.addr6_fd = -1;
+    }
+}
+
+/* Called once every pkbuf of the packet pool has been freed */
+void upf_xdp_final(void)
+{
+    int i;
+
+    for (i = 0; i < xdp.num_of_xsk; i++)
+        xsk_close(&xdp.xsk[i]);
+
+    xdp.num_of_xsk = 0;
+}
+
+static int xsk_frame_parse(unsigned char *data, uint32_t len,
+        ogs_sockaddr_t *from, uint32_t *offset, uint32_t *size)
+{
+    uint16_t eth_type, udp_len;
+    uint32_t l4;
+
+    if (len < ETHER_HDR_LEN)
+        return OGS_ERROR;
+
+    memset(from, 0, sizeof(*from));
+
+    eth_type = (data[12] << 8) | data[13];
+    if (eth_type == ETHERTYPE_IP) {
+        l4 = ETHER_HDR_LEN + 20;
+        if (len < l4 + 8)
+            return OGS_ERROR;
+
+        from->ogs_sa_family = AF_INET;
+        memcpy(&from->sin.sin_addr, data + ETHER_HDR_LEN + 12, OGS_IPV4_LEN);
+    } else if (eth_type == ETHERTYPE_IPV6) {
+        l4 = ETHER_HDR_LEN + 40;
+        if (len < l4 + 8)
+            return OGS_ERROR;
+
+        from->ogs_sa_family = AF_INET6;
+        memcpy(&from->sin6.sin6_addr, data + ETHER_HDR_LEN + 8, OGS_IPV6_LEN);
+    } else
+        return OGS_ERROR;
+
+    memcpy(&from->ogs_sin_port, data + l4, sizeof(uint16_t));
+
+    /* Ethernet padding is not part of the datagram */
+    udp_len = (data[l4 + 4] << 8) | data[l4 + 5];
+    if (udp_len <= 8 || l4 + udp_len > len)
+        return OGS_ERROR;
+
+    *offset = l4 + 8;
+    *size = udp_len - 8;
+
+    return OGS_OK;
+}
+
+static ogs_pkbuf_t *xsk_frame_pkbuf(upf_xsk_t *xsk,
+        uint64_t frame_addr, uint64_t data_addr, uint32_t size)
+{
+    unsigned char *frame = xsk->umem + frame_addr;
+    unsigned char *data = xsk->umem + data_addr;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    if (ogs_atomic_load(&xsk->num_of_held) < XSK_NUM_OF_FRAME / 2) {
+        pkbuf = ogs_pkbuf_attach(xdp.pool,
+                frame, XSK_FRAME_SIZE, xsk_frame_free, xsk);
+        if (pkbuf) {
+            ogs_atomic_inc(&xsk->num_of_held);
+
+            ogs_pkbuf_reserve(pkbuf, data - frame);
+            ogs_pkbuf_put(pkbuf, size);
+
+            return pkbuf;
+        }
+    }
+
+    /*
+     * Copy once half of the UMEM is held (e.g. by buffered packets),
+     * so that the fill ring never runs dry.
+     */
+    pkbuf = ogs_pkbuf_alloc(xdp.pool, OGS_MAX_PKT_LEN);
+    if (pkbuf) {
+        ogs_pkbuf_reserve(pkbuf, OGS_TUN_MAX_HEADROOM);
+        ogs_pkbuf_put_data(pkbuf, data, size);
+    } else
+        ogs_error("ogs_pkbuf_alloc() failed");
+
+    xsk_fill(xsk, frame_addr);
+
+    return pkbuf;
+}
+
+int upf_xdp_recv(upf_xsk_t *xsk,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *from, int max)
+{
+    upf_xsk_ring_t *rx = NULL;
+    uint32_t cons, avail, i;
+    int num = 0;
+
+    ogs_assert(xsk);
+    ogs_assert(pkbuf);
+    ogs_assert(from);
+
+    rx = &xsk->rx;
+
+    cons = *rx->consumer;
+    avail = ogs_atomic_load(rx->producer) - cons;
+    if (avail > max)
+        avail = max;
+
+    for (i = 0; i < avail; i++) {
+        struct xdp_desc *desc = NULL;
+        uint64_t frame_addr;
+        uint32_t offset, size;
+
+        desc = &((struct xdp_desc *)rx->desc)[(cons + i) & rx->mask];
+        frame_addr = desc->addr & ~((uint64_t)XSK_FRAME_SIZE - 1);
+
+        if (xsk_frame_parse(xsk->umem + desc->addr, desc->len,
+                    &from[num], &offset, &size) != OGS_OK) {
+            ogs_error("[DROP] Invalid GTPU frame [len:%d]", desc->len);
+            xsk_fill(xsk, frame_addr);
+            continue;
+        }
+
+        pkbuf[num] = xsk_frame_pkbuf(xsk,
+                frame_addr, desc->addr + offset, size);
+        if (pkbuf[num])
+            num++;
+    }
+
+    ogs_atomic_store(rx->consumer, cons + avail);
+
+    return num;
+}
+
+#else /* HAVE_LINUX_IF_XDP_H && HAVE_LINUX_BPF_H */
+
+int upf_xdp_open(ogs_pkbuf_pool_t *pool, ogs_poll_handler_f handler)
+{
+    ogs_error("AF_XDP is not supported on this platform");
+    return OGS_ERROR;
+}
+
+void upf_xdp_close(void)
+{
+}
+
+void upf_xdp_final(void)
+{
+}
+
+int upf_xdp_recv(upf_xsk_t *xsk,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *from, int max)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPF_XDP_PATH_H
+#define UPF_XDP_PATH_H
+
+#include "context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UPF_MAX_NUM_OF_XDP_QUEUE 64
+
+/*
+ * AF_XDP backend for N3
+ *
+ * A small XDP program attached to 'upf.xdp.dev' redirects plain
+ * GTP-U datagrams (UDP to the GTP-U port of a 'upf.gtpu' address, no
+ * IP options or fragments) to one AF_XDP socket per RX queue.
+ * Everything else, including traffic on queues without a socket,
+ * still goes up the kernel stack to the regular N3 sockets, which are
+ * also used for transmission.
+ *
+ * Received frames are handed to the GTP-U path in place : the pkbuf
+ * points into the UMEM and the frame returns to the fill ring when
+ * the pkbuf is freed.
+ */
+typedef struct upf_xsk_s upf_xsk_t;
+
+int upf_xdp_open(ogs_pkbuf_pool_t *pool, ogs_poll_handler_f handler);
+void upf_xdp_close(void);
+void upf_xdp_final(void);
+
+int upf_xdp_recv(upf_xsk_t *xsk,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *from, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UPF_XDP_PATH_H */
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+
+/*
+ * Downlink lookup at 1M sessions : ogs_hash_get() against the
+ * open-addressing map, per key and by bursts.
+ *
+ * Not part of the unit tests. Run it with 'meson test --benchmark'
+ * or directly as ./tests/core/ipmap-bench.
+ */
+#define BENCH_NUM (1024*1024)
+#define BENCH_BURST 32
+
+static int bench(void)
+{
+    ogs_ipmap_t *map = NULL;
+    ogs_hash_t *hash = NULL;
+    uint32_t *addr = NULL, *lookup = NULL;
+    uint64_t *key = NULL;
+    void *burst[BENCH_BURST];
+    ogs_time_t start, hash_usec, map_usec, burst_usec;
+    int i, j, found[3];
+
+    addr = ogs_calloc(BENCH_NUM, sizeof(*addr));
+    ogs_assert(addr);
+    lookup = ogs_calloc(BENCH_NUM, sizeof(*lookup));
+    ogs_assert(lookup);
+    key = ogs_calloc(BENCH_NUM, sizeof(*key));
+    ogs_assert(key);
+
+    map = ogs_ipmap_create(BENCH_NUM);
+    ogs_assert(map);
+    hash = ogs_hash_make();
+    ogs_assert(hash);
+
+    /* UE pool 10.0.0.0/8, looked up in random order */
+    for (i = 0; i < BENCH_NUM; i++) {
+        addr[i] = htobe32(0x0a000001 + i);
+        ogs_hash_set(hash, &addr[i], sizeof(uint32_t), &addr[i]);
+        ogs_ipmap_set(map, ogs_ipmap_key_ipv4(addr[i]), &addr[i]);
+    }
+    for (i = 0; i < BENCH_NUM; i++) {
+        lookup[i] = addr[ogs_random32() % BENCH_NUM];
+        key[i] = ogs_ipmap_key_ipv4(lookup[i]);
+    }
+
+    memset(found, 0, sizeof(found));
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < BENCH_NUM; i++)
+        if (ogs_hash_get(hash, &lookup[i], sizeof(uint32_t))) found[0]++;
+    hash_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < BENCH_NUM; i++)
+        if (ogs_ipmap_get(map, key[i])) found[1]++;
+    map_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < BENCH_NUM; i += BENCH_BURST) {
+        ogs_ipmap_get_burst(map, &key[i], burst, BENCH_BURST);
+        for (j = 0; j < BENCH_BURST; j++)
+            if (burst[j]) found[2]++;
+    }
+    burst_usec = ogs_get_monotonic_time() - start;
+
+    printf("%d lookups : ogs_hash %lld usec, ogs_ipmap %lld usec, "
+            "ogs_ipmap burst(%d) %lld usec\n", BENCH_NUM,
+            (long long)hash_usec, (long long)map_usec,
+            BENCH_BURST, (long long)burst_usec);
+
+    ogs_hash_destroy(hash);
+    ogs_ipmap_destroy(map);
+
+    ogs_free(key);
+    ogs_free(lookup);
+    ogs_free(addr);
+
+    for (i = 0; i < 3; i++) {
+        if (found[i] != BENCH_NUM) {
+            fprintf(stderr, "%d of %d keys found\n", found[i], BENCH_NUM);
+            return OGS_ERROR;
+        }
+    }
+
+    return OGS_OK;
+}
+
+int main(void)
+{
+    int rv;
+
+    ogs_core_initialize();
+
+    rv = bench();
+
+    ogs_core_terminate();
+
+    return rv == OGS_OK ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+#include "core/abts.h"
+
+static void ipmap_test1(abts_case *tc, void *data)
+{
+    ogs_ipmap_t *map = NULL;
+    uint32_t addr = htobe32(0x0a2d0001); /* 10.45.0.1 */
+    uint8_t addr6[16] = {
+        0x20, 0x01, 0x0d, 0xb8, 0xca, 0xfe, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    uint8_t other6[16];
+    char a = 'a', b = 'b';
+
+    map = ogs_ipmap_create(0);
+    ABTS_PTR_NOTNULL(tc, map);
+
+    ogs_ipmap_set(map, ogs_ipmap_key_ipv4(addr), &a);
+    ABTS_PTR_EQUAL(tc, &a, ogs_ipmap_get(map, ogs_ipmap_key_ipv4(addr)));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_ipmap_get(map, ogs_ipmap_key_ipv4(addr+1)));
+
+    ogs_ipmap_set(map, ogs_ipmap_key_ipv4(addr), &b);
+    ABTS_PTR_EQUAL(tc, &b, ogs_ipmap_get(map, ogs_ipmap_key_ipv4(addr)));
+    ABTS_INT_EQUAL(tc, 1, ogs_ipmap_count(map));
+
+    /* Only the /64 prefix is the key */
+    ogs_ipmap_set(map, ogs_ipmap_key_ipv6(addr6), &a);
+    memcpy(other6, addr6, sizeof(other6));
+    other6[15] = 0x02;
+    ABTS_PTR_EQUAL(tc, &a, ogs_ipmap_get(map, ogs_ipmap_key_ipv6(other6)));
+    other6[7] = 0x02;
+    ABTS_PTR_EQUAL(tc, NULL, ogs_ipmap_get(map, ogs_ipmap_key_ipv6(other6)));
+    ABTS_INT_EQUAL(tc, 2, ogs_ipmap_count(map));
+
+    ogs_ipmap_set(map, ogs_ipmap_key_ipv4(addr), NULL);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_ipmap_get(map, ogs_ipmap_key_ipv4(addr)));
+    ogs_ipmap_set(map, ogs_ipmap_key_ipv4(addr), NULL);
+    ABTS_INT_EQUAL(tc, 1, ogs_ipmap_count(map));
+
+    ogs_ipmap_destroy(map);
+}
+
+#define TEST2_NUM 4096
+
+/* Random insert/remove checked against ogs_hash_t, with growth */
+static void ipmap_test2(abts_case *tc, void *data)
+{
+    ogs_ipmap_t *map = NULL;
+    ogs_hash_t *hash = NULL;
+    static uint64_t key[TEST2_NUM];
+    static char val[TEST2_NUM];
+    void *burst[TEST2_NUM];
+    int i, n;
+
+    map = ogs_ipmap_create(16);
+    ABTS_PTR_NOTNULL(tc, map);
+    hash = ogs_hash_make();
+    ABTS_PTR_NOTNULL(tc, hash);
+
+    /* A small key space so that inserts and removes collide often */
+    for (i = 0; i < TEST2_NUM; i++)
+        key[i] = ogs_random32() % (TEST2_NUM / 2);
+
+    for (n = 0; n < 4; n++) {
+        for (i = 0; i < TEST2_NUM; i++) {
+            if (ogs_random32() % 3) {
+                ogs_ipmap_set(map, key[i], &val[i]);
+                ogs_hash_set(hash, &key[i], sizeof(key[i]), &val[i]);
+            } else {
+                ogs_ipmap_set(map, key[i], NULL);
+                ogs_hash_set(hash, &key[i], sizeof(key[i]), NULL);
+            }
+        }
+
+        ABTS_INT_EQUAL(tc, ogs_hash_count(hash), ogs_ipmap_count(map));
+
+        ogs_ipmap_get_burst(map, key, burst, TEST2_NUM);
+        for (i = 0; i < TEST2_NUM; i++) {
+            void *expected = ogs_hash_get(hash, &key[i], sizeof(key[i]));
+            ABTS_PTR_EQUAL(tc, expected, ogs_ipmap_get(map, key[i]));
+            ABTS_PTR_EQUAL(tc, expected, burst[i]);
+        }
+    }
+
+    for (i = 0; i < TEST2_NUM; i++)
+        ogs_ipmap_set(map, key[i], NULL);
+    ABTS_INT_EQUAL(tc, 0, ogs_ipmap_count(map));
+
+    ogs_hash_destroy(hash);
+    ogs_ipmap_destroy(map);
+}
+
+/* Removing from the middle of a cluster shifts the rest of it back */
+static void ipmap_test3(abts_case *tc, void *data)
+{
+    ogs_ipmap_t *map = NULL;
+    static char val[12];
+    int i, j;
+
+    for (i = 0; i < 12; i++) {
+        /* 12 keys in 16 slots : some always share a cluster */
+        map = ogs_ipmap_create(0);
+        ABTS_PTR_NOTNULL(tc, map);
+
+        for (j = 0; j < 12; j++)
+            ogs_ipmap_set(map, j + 1, &val[j]);
+
+        ogs_ipmap_set(map, i + 1, NULL);
+        ABTS_INT_EQUAL(tc, 11, ogs_ipmap_count(map));
+
+        for (j = 0; j < 12; j++)
+            ABTS_PTR_EQUAL(tc, j == i ? NULL : &val[j],
+                    ogs_ipmap_get(map, j + 1));
+
+        /* The freed slot is found again */
+        ogs_ipmap_set(map, i + 1, &val[i]);
+        ABTS_PTR_EQUAL(tc, &val[i], ogs_ipmap_get(map, i + 1));
+        ABTS_INT_EQUAL(tc, 12, ogs_ipmap_count(map));
+
+        ogs_ipmap_destroy(map);
+    }
+}
+
+abts_suite *test_ipmap(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, ipmap_test1, NULL);
+    abts_run_test(suite, ipmap_test2, NULL);
+    abts_run_test(suite, ipmap_test3, NULL);
+
+    return suite;
+}
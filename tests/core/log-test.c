@@ -20,6 +20,10 @@
 #include "ogs-core.h"
 #include "core/abts.h"
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#endif
+
 static void test_basic(abts_case *tc, void *data)
 {
     int domain_id = -1;
@@ -103,11 +107,176 @@ static void test_basic(abts_case *tc, void *data)
 #endif
 }
 
+static int test_lazy_count;
+
+static int test_lazy_eval(void)
+{
+    return ++test_lazy_count;
+}
+
+static void test_lazy(abts_case *tc, void *data)
+{
+    int domain_id = ogs_log_get_domain_id("core");
+    int core_level = ogs_log_get_domain_level(domain_id);
+
+    ogs_log_set_domain_level(domain_id, OGS_LOG_INFO);
+    ABTS_TRUE(tc, ogs_log_enabled(OGS_LOG_INFO, domain_id));
+    ABTS_TRUE(tc, !ogs_log_enabled(OGS_LOG_DEBUG, domain_id));
+
+    test_lazy_count = 0;
+    ogs_debug("%d", test_lazy_eval());
+    ogs_trace("%d", test_lazy_eval());
+    ABTS_INT_EQUAL(tc, 0, test_lazy_count);
+
+    ogs_log_set_mask_level("core", OGS_LOG_TRACE);
+    ABTS_TRUE(tc, ogs_log_enabled(OGS_LOG_TRACE, domain_id) ==
+            (OGS_LOG_MAX_LEVEL >= OGS_LOG_TRACE));
+
+    ogs_log_set_domain_level(domain_id, core_level);
+}
+
+#define TEST_ASYNC_FILE     "log-test-async.log"
+#define TEST_ASYNC_LINES    1000
+
+static void test_async(abts_case *tc, void *data)
+{
+    int i, rv, lines = 0;
+    int domain_id = ogs_log_get_domain_id("core");
+    int core_level = ogs_log_get_domain_level(domain_id);
+    char buf[OGS_HUGE_LEN];
+    ogs_log_t *log = NULL;
+    FILE *fp = NULL;
+#if !defined(_WIN32)
+    int saved_stderr = dup(STDERR_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+
+    /* Keep the lines off the console */
+    ABTS_TRUE(tc, saved_stderr >= 0 && devnull >= 0);
+    dup2(devnull, STDERR_FILENO);
+    close(devnull);
+#endif
+
+    remove(TEST_ASYNC_FILE);
+
+    log = ogs_log_add_file(TEST_ASYNC_FILE);
+    ABTS_PTR_NOTNULL(tc, log);
+
+    rv = ogs_log_async_start(0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ogs_log_set_domain_level(domain_id, OGS_LOG_TRACE);
+    for (i = 0; i < TEST_ASYNC_LINES; i++)
+        ogs_log_print(OGS_LOG_TRACE, "async %d\n", i);
+    ogs_log_set_domain_level(domain_id, core_level);
+
+    ABTS_INT_EQUAL(tc, 0, ogs_log_async_dropped());
+
+    ogs_log_async_stop();
+    ogs_log_remove(log);
+
+#if !defined(_WIN32)
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+#endif
+
+    fp = fopen(TEST_ASYNC_FILE, "r");
+    ABTS_PTR_NOTNULL(tc, fp);
+    while (fgets(buf, sizeof(buf), fp)) {
+        ABTS_INT_EQUAL(tc, lines, atoi(buf + strlen("async ")));
+        lines++;
+    }
+    fclose(fp);
+
+    ABTS_INT_EQUAL(tc, TEST_ASYNC_LINES, lines);
+
+    remove(TEST_ASYNC_FILE);
+}
+
+#define TEST_ASYNC_THREADS  4
+
+static void async_thread_main(void *data)
+{
+    int i;
+
+    for (i = 0; i < TEST_ASYNC_LINES; i++)
+        ogs_log_print(OGS_LOG_TRACE, "thread %d\n", i);
+}
+
+static void test_async_thread(abts_case *tc, void *data)
+{
+    int i, rv, lines = 0;
+    int domain_id = ogs_log_get_domain_id("core");
+    int core_level = ogs_log_get_domain_level(domain_id);
+    char buf[OGS_HUGE_LEN];
+    ogs_log_t *log = NULL;
+    ogs_thread_t *thread[TEST_ASYNC_THREADS];
+    FILE *fp = NULL;
+#if !defined(_WIN32)
+    int saved_stderr = dup(STDERR_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+
+    /* Keep the lines off the console */
+    ABTS_TRUE(tc, saved_stderr >= 0 && devnull >= 0);
+    dup2(devnull, STDERR_FILENO);
+    close(devnull);
+#endif
+
+    remove(TEST_ASYNC_FILE);
+
+    log = ogs_log_add_file(TEST_ASYNC_FILE);
+    ABTS_PTR_NOTNULL(tc, log);
+
+    rv = ogs_log_async_start(0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ogs_log_set_domain_level(domain_id, OGS_LOG_TRACE);
+
+    /* The rings of the exited threads are drained, then freed */
+    for (i = 0; i < TEST_ASYNC_THREADS; i++) {
+        thread[i] = ogs_thread_create(async_thread_main, NULL);
+        ABTS_PTR_NOTNULL(tc, thread[i]);
+    }
+    for (i = 0; i < TEST_ASYNC_THREADS; i++)
+        ogs_thread_destroy(thread[i]);
+
+    /* Reopening the file keeps the lines written so far */
+    ogs_log_cycle();
+
+    async_thread_main(NULL);
+
+    ogs_log_set_domain_level(domain_id, core_level);
+
+    ABTS_INT_EQUAL(tc, 0, ogs_log_async_dropped());
+
+    ogs_log_async_stop();
+    ogs_log_remove(log);
+
+#if !defined(_WIN32)
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+#endif
+
+    fp = fopen(TEST_ASYNC_FILE, "r");
+    ABTS_PTR_NOTNULL(tc, fp);
+    while (fgets(buf, sizeof(buf), fp)) {
+        if (!strncmp(buf, "thread ", strlen("thread ")))
+            lines++;
+    }
+    fclose(fp);
+
+    ABTS_INT_EQUAL(tc, (TEST_ASYNC_THREADS + 1) * TEST_ASYNC_LINES, lines);
+
+    remove(TEST_ASYNC_FILE);
+}
+
 abts_suite *test_log(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test_basic, NULL);
+    abts_run_test(suite, test_lazy, NULL);
+    abts_run_test(suite, test_async, NULL);
+    abts_run_test(suite, test_async_thread, NULL);
 
     return suite;
 }
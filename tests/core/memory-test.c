@@ -74,6 +74,89 @@ static void test4_func(abts_case *tc, void *data)
 #endif
 }
 
+#if OGS_USE_TALLOC == 1
+static void test5_thread(void *data)
+{
+    char **ptr = data;
+
+    /* Both were allocated by the main thread */
+    ogs_free(ptr[0]);
+    ptr[1] = ogs_realloc(ptr[1], 64);
+
+    ptr[2] = ogs_strdup("thread");
+}
+
+static void test5_adopt(void *data)
+{
+    ogs_free(ogs_malloc(16));
+}
+#endif
+
+static void test5_func(abts_case *tc, void *data)
+{
+#if OGS_USE_TALLOC == 1
+    char *ptr[3];
+    ogs_thread_t *thread = NULL;
+
+    ptr[0] = ogs_malloc(16);
+    ABTS_PTR_NOTNULL(tc, ptr[0]);
+    ptr[1] = ogs_strdup("open5gs");
+    ABTS_PTR_NOTNULL(tc, ptr[1]);
+    ptr[2] = NULL;
+
+    thread = ogs_thread_create(test5_thread, ptr);
+    ABTS_PTR_NOTNULL(tc, thread);
+    ogs_thread_destroy(thread);
+
+    ABTS_STR_EQUAL(tc, "open5gs", ptr[1]);
+    ABTS_STR_EQUAL(tc, "thread", ptr[2]);
+
+    ptr[1] = ogs_realloc(ptr[1], 4096);
+    ABTS_STR_EQUAL(tc, "open5gs", ptr[1]);
+    ogs_free(ptr[1]);
+
+    /* The context of the exited thread is adopted and drained */
+    ogs_free(ptr[2]);
+
+    thread = ogs_thread_create(test5_adopt, NULL);
+    ABTS_PTR_NOTNULL(tc, thread);
+    ogs_thread_destroy(thread);
+#endif
+}
+
+#if OGS_USE_TALLOC == 1 && !defined(_WIN32)
+static void *test6_thread(void *data)
+{
+    char **ptr = data;
+
+    /* Not an ogs_thread_create() thread, like those of freeDiameter */
+    *ptr = ogs_strdup("pthread");
+
+    return NULL;
+}
+#endif
+
+static void test6_func(abts_case *tc, void *data)
+{
+#if OGS_USE_TALLOC == 1 && !defined(_WIN32)
+    char *ptr = NULL;
+    pthread_t thread;
+    ogs_thread_t *adopt = NULL;
+
+    ABTS_INT_EQUAL(tc, 0,
+            pthread_create(&thread, NULL, test6_thread, &ptr));
+    ABTS_INT_EQUAL(tc, 0, pthread_join(thread, NULL));
+
+    /* The context was orphaned on exit : freed at once */
+    ABTS_STR_EQUAL(tc, "pthread", ptr);
+    ogs_free(ptr);
+
+    adopt = ogs_thread_create(test5_adopt, NULL);
+    ABTS_PTR_NOTNULL(tc, adopt);
+    ogs_thread_destroy(adopt);
+#endif
+}
+
 abts_suite *test_memory(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -82,6 +165,8 @@ abts_suite *test_memory(abts_suite *suite)
     abts_run_test(suite, test2_func, NULL);
     abts_run_test(suite, test3_func, NULL);
     abts_run_test(suite, test4_func, NULL);
+    abts_run_test(suite, test5_func, NULL);
+    abts_run_test(suite, test6_func, NULL);
 
     return suite;
 }
@@ -70,12 +70,175 @@ static void test2_func(abts_case *tc, void *data)
     ogs_pkbuf_free(p3);
 }
 
+#if OGS_USE_TALLOC == 1
+static void test3_free_cb(unsigned char *buf, void *data)
+{
+    *(unsigned char **)data = buf;
+}
+
+static void test3_func(abts_case *tc, void *data)
+{
+    ogs_pkbuf_t *pkbuf = NULL, *p2 = NULL;
+    unsigned char buffer[100];
+    unsigned char *freed = NULL;
+    unsigned char *tmp = NULL;
+
+    memset(buffer, 0x5a, sizeof(buffer));
+
+    pkbuf = ogs_pkbuf_attach(NULL, buffer, sizeof(buffer),
+            test3_free_cb, &freed);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_PTR_EQUAL(tc, buffer, pkbuf->head);
+    ABTS_INT_EQUAL(tc, 0, pkbuf->len);
+    ABTS_INT_EQUAL(tc, 100, (pkbuf->end-pkbuf->head));
+    ogs_pkbuf_reserve(pkbuf, 20);
+    tmp = ogs_pkbuf_put(pkbuf, 60);
+    ABTS_PTR_EQUAL(tc, buffer + 20, tmp);
+
+    p2 = ogs_pkbuf_copy(pkbuf);
+    ABTS_PTR_NOTNULL(tc, p2);
+    ABTS_INT_EQUAL(tc, 60, p2->len);
+    ABTS_INT_EQUAL(tc, 20, (p2->data-p2->head));
+    ABTS_INT_EQUAL(tc, 20, (p2->end-p2->tail));
+    ABTS_INT_EQUAL(tc, 0, memcmp(p2->data, buffer + 20, 60));
+
+    ogs_pkbuf_free(p2);
+    ABTS_PTR_EQUAL(tc, NULL, freed);
+
+    ogs_pkbuf_free(pkbuf);
+    ABTS_PTR_EQUAL(tc, buffer, freed);
+}
+
+#define TEST4_NUM   100
+
+static ogs_pkbuf_t *test4_pkbuf[TEST4_NUM];
+
+static void test4_free_main(void *data)
+{
+    int i;
+
+    for (i = 0; i < TEST4_NUM; i++)
+        ogs_pkbuf_free(test4_pkbuf[i]);
+}
+
+static void test4_func(abts_case *tc, void *data)
+{
+    int i;
+    ogs_pkbuf_t *pkbuf = NULL, *p2 = NULL;
+    ogs_pkbuf_cache_stat_t before, after;
+    ogs_thread_t *thread = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, 1000);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ogs_pkbuf_free(pkbuf);
+
+    ogs_pkbuf_cache_stat(&before);
+
+    /* Recycled from the magazine of this thread */
+    p2 = ogs_pkbuf_alloc(NULL, 600);
+    ABTS_PTR_EQUAL(tc, pkbuf, p2);
+    ABTS_INT_EQUAL(tc, 0, p2->len);
+    ABTS_INT_EQUAL(tc, 600, (p2->end-p2->head));
+    ogs_pkbuf_free(p2);
+
+    ogs_pkbuf_cache_stat(&after);
+    ABTS_TRUE(tc, after.hit == before.hit + 1);
+
+    /* Freed by another thread, then refilled from the depot */
+    for (i = 0; i < TEST4_NUM; i++) {
+        test4_pkbuf[i] = ogs_pkbuf_alloc(NULL, 2000);
+        ABTS_PTR_NOTNULL(tc, test4_pkbuf[i]);
+    }
+
+    thread = ogs_thread_create(test4_free_main, NULL);
+    ABTS_PTR_NOTNULL(tc, thread);
+    ogs_thread_destroy(thread);
+
+    ogs_pkbuf_cache_stat(&before);
+    for (i = 0; i < TEST4_NUM; i++) {
+        test4_pkbuf[i] = ogs_pkbuf_alloc(NULL, 2000);
+        ABTS_PTR_NOTNULL(tc, test4_pkbuf[i]);
+    }
+    ogs_pkbuf_cache_stat(&after);
+    ABTS_TRUE(tc, after.hit > before.hit);
+
+    for (i = 0; i < TEST4_NUM; i++)
+        ogs_pkbuf_free(test4_pkbuf[i]);
+}
+#endif
+
+static void test5_func(abts_case *tc, void *data)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    unsigned char *tmp = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ogs_pkbuf_reserve(pkbuf, 16);
+    tmp = ogs_pkbuf_put(pkbuf, 40);
+    ABTS_PTR_NOTNULL(tc, tmp);
+    memset(tmp, 0xa5, 40);
+
+    pkbuf = ogs_pkbuf_fit(pkbuf, 16, 4);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_INT_EQUAL(tc, 40, pkbuf->len);
+    ABTS_INT_EQUAL(tc, 16, ogs_pkbuf_headroom(pkbuf));
+    ABTS_TRUE(tc, ogs_pkbuf_tailroom(pkbuf) >= 4);
+    ABTS_TRUE(tc, pkbuf->end - pkbuf->head <= 128);
+    ABTS_INT_EQUAL(tc, 0xa5, pkbuf->data[0]);
+    ABTS_INT_EQUAL(tc, 0xa5, pkbuf->data[39]);
+
+    tmp = ogs_pkbuf_push(pkbuf, 16);
+    ABTS_PTR_NOTNULL(tc, tmp);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
+static void test6_func(abts_case *tc, void *data)
+{
+    ogs_pkbuf_t *pkbuf = NULL, *clone1 = NULL, *clone2 = NULL;
+    unsigned char *tmp = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, 128);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ogs_pkbuf_reserve(pkbuf, 16);
+    tmp = ogs_pkbuf_put(pkbuf, 40);
+    ABTS_PTR_NOTNULL(tc, tmp);
+    memset(tmp, 0x5a, 40);
+
+    clone1 = ogs_pkbuf_clone(pkbuf);
+    ABTS_PTR_NOTNULL(tc, clone1);
+    clone2 = ogs_pkbuf_clone(clone1);
+    ABTS_PTR_NOTNULL(tc, clone2);
+
+    ABTS_INT_EQUAL(tc, 40, clone2->len);
+    ABTS_INT_EQUAL(tc, 16, ogs_pkbuf_headroom(clone2));
+    ABTS_INT_EQUAL(tc, 0x5a, clone2->data[0]);
+    ABTS_INT_EQUAL(tc, 0x5a, clone2->data[39]);
+
+    ogs_pkbuf_pull(clone1, 8);
+    ABTS_INT_EQUAL(tc, 32, clone1->len);
+    ABTS_INT_EQUAL(tc, 40, pkbuf->len);
+
+    ogs_pkbuf_free(pkbuf);
+    ABTS_INT_EQUAL(tc, 0x5a, clone2->data[39]);
+    ogs_pkbuf_free(clone1);
+    ABTS_INT_EQUAL(tc, 0x5a, clone2->data[0]);
+    ogs_pkbuf_free(clone2);
+}
+
 abts_suite *test_pkbuf(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test1_func, NULL);
     abts_run_test(suite, test2_func, NULL);
+#if OGS_USE_TALLOC == 1
+    abts_run_test(suite, test3_func, NULL);
+    abts_run_test(suite, test4_func, NULL);
+#endif
+    abts_run_test(suite, test5_func, NULL);
+    abts_run_test(suite, test6_func, NULL);
 
     return suite;
 }
@@ -657,6 +657,59 @@ static void test8_func(abts_case *tc, void *data)
     ogs_pollset_destroy(pollset);
 }
 
+#define TEST9_NUM_THREAD 4
+#define TEST9_NUM_NOTIFY 100000
+
+static ogs_pollset_t *test9_pollset;
+static int test9_done;
+
+static void test9_main(void *data)
+{
+    abts_case *tc = data;
+    int i, rv;
+
+    for (i = 0; i < TEST9_NUM_NOTIFY; i++) {
+        rv = ogs_pollset_notify(test9_pollset);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    }
+
+    ogs_atomic_inc(&test9_done);
+}
+
+static void test9_func(abts_case *tc, void *data)
+{
+    int i, rv;
+    ogs_thread_t *thread[TEST9_NUM_THREAD];
+
+    test9_pollset = ogs_pollset_create(512);
+    ABTS_PTR_NOTNULL(tc, test9_pollset);
+
+    test9_done = 0;
+    for (i = 0; i < TEST9_NUM_THREAD; i++) {
+        thread[i] = ogs_thread_create(test9_main, tc);
+        ABTS_PTR_NOTNULL(tc, thread[i]);
+    }
+
+    while (ogs_atomic_load(&test9_done) < TEST9_NUM_THREAD)
+        ogs_pollset_poll(test9_pollset, ogs_time_from_msec(10));
+
+    for (i = 0; i < TEST9_NUM_THREAD; i++)
+        ogs_thread_destroy(thread[i]);
+
+    do {
+        rv = ogs_pollset_poll(test9_pollset, ogs_time_from_msec(10));
+    } while (rv == OGS_OK);
+    ABTS_INT_EQUAL(tc, OGS_TIMEUP, rv);
+
+    /* A wakeup lost while draining would swallow this one as well */
+    rv = ogs_pollset_notify(test9_pollset);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    rv = ogs_pollset_poll(test9_pollset, ogs_time_from_msec(100));
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ogs_pollset_destroy(test9_pollset);
+}
+
 abts_suite *test_poll(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -672,6 +725,7 @@ abts_suite *test_poll(abts_suite *suite)
     abts_run_test(suite, test6_func, NULL);
     abts_run_test(suite, test7_func, NULL);
     abts_run_test(suite, test8_func, NULL);
+    abts_run_test(suite, test9_func, NULL);
 
     return suite;
 }
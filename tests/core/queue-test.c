@@ -166,12 +166,73 @@ static void test_queue_timeout(abts_case *tc, void *data)
     ogs_queue_destroy(q);
 }
 
+#define MPSC_PRODUCERS      4
+#define MPSC_ITEMS          20000
+
+static void mpsc_producer(void *data)
+{
+    uintptr_t id = (uintptr_t)data;
+    uintptr_t i;
+
+    for (i = 1; i <= MPSC_ITEMS; i++)
+        ogs_assert(ogs_queue_push(queue, (void *)((id << 24) | i)) == OGS_OK);
+}
+
+static void test_queue_mpsc(abts_case *tc, void *data)
+{
+    ogs_thread_t *producer_thread[MPSC_PRODUCERS];
+    uintptr_t last[MPSC_PRODUCERS];
+    uintptr_t i, id, seq;
+    int rv, count = 0, in_order = 1;
+    void *v;
+
+    queue = ogs_queue_create(64);
+    ABTS_PTR_NOTNULL(tc, queue);
+
+    memset(last, 0, sizeof(last));
+
+    for (i = 0; i < MPSC_PRODUCERS; i++) {
+        producer_thread[i] = ogs_thread_create(mpsc_producer, (void *)i);
+        ABTS_PTR_NOTNULL(tc, producer_thread[i]);
+    }
+
+    while (count < MPSC_PRODUCERS * MPSC_ITEMS) {
+        rv = ogs_queue_pop(queue, &v);
+        if (rv == OGS_ERROR)
+            continue;
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+        id = (uintptr_t)v >> 24;
+        seq = (uintptr_t)v & 0xffffff;
+        if (id >= MPSC_PRODUCERS || seq != last[id] + 1)
+            in_order = 0;
+        else
+            last[id] = seq;
+
+        count++;
+    }
+    ABTS_TRUE(tc, in_order);
+
+    rv = ogs_queue_trypop(queue, &v);
+    ABTS_INT_EQUAL(tc, OGS_RETRY, rv);
+    ABTS_INT_EQUAL(tc, 0, ogs_queue_size(queue));
+
+    for (i = 0; i < MPSC_PRODUCERS; i++)
+        ogs_thread_destroy(producer_thread[i]);
+
+    rv = ogs_queue_term(queue);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ogs_queue_destroy(queue);
+}
+
 abts_suite *test_queue(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test_queue_producer_consumer, NULL);
     abts_run_test(suite, test_queue_timeout, NULL);
+    abts_run_test(suite, test_queue_mpsc, NULL);
 
     return suite;
 }
@@ -424,6 +424,52 @@ static void test8_func(abts_case *tc, void *data)
     ABTS_INT_EQUAL(tc, OGS_OK, rv);
 }
 
+static void test9_func(abts_case *tc, void *data)
+{
+    int rv, i, n;
+    ogs_sock_t *server, *client;
+    ogs_sockaddr_t *addr;
+    ogs_sockmsg_t msg[4];
+    char rbuf[4][STRLEN];
+
+    rv = ogs_getaddrinfo(&addr, AF_INET, "127.0.0.1", PORT, 0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    server = ogs_udp_server(addr, NULL);
+    ABTS_PTR_NOTNULL(tc, server);
+
+    client = ogs_sock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ABTS_PTR_NOTNULL(tc, client);
+
+    for (i = 0; i < 4; i++) {
+        msg[i].buf = DATASTR;
+        msg[i].len = i+1;
+        memcpy(&msg[i].addr, addr, sizeof(msg[i].addr));
+    }
+    n = ogs_sendmmsg(client->fd, msg, 4, 0);
+    ABTS_INT_EQUAL(tc, 4, n);
+
+    n = 0;
+    while (n < 4) {
+        for (i = n; i < 4; i++) {
+            msg[i].buf = rbuf[i];
+            msg[i].len = STRLEN;
+        }
+        rv = ogs_recvmmsg(server->fd, &msg[n], 4-n, 0);
+        ABTS_TRUE(tc, rv > 0);
+        n += rv;
+    }
+    for (i = 0; i < 4; i++) {
+        ABTS_INT_EQUAL(tc, i+1, msg[i].len);
+        ABTS_TRUE(tc, memcmp(rbuf[i], DATASTR, i+1) == 0);
+        ABTS_INT_EQUAL(tc, AF_INET, msg[i].addr.ogs_sa_family);
+    }
+
+    ogs_sock_destroy(client);
+    ogs_sock_destroy(server);
+    ogs_freeaddrinfo(addr);
+}
+
 abts_suite *test_socket(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -436,6 +482,7 @@ abts_suite *test_socket(abts_suite *suite)
     abts_run_test(suite, test6_func, NULL);
     abts_run_test(suite, test7_func, NULL);
     abts_run_test(suite, test8_func, NULL);
+    abts_run_test(suite, test9_func, NULL);
 
     return suite;
 }
@@ -41,6 +41,14 @@ void test_expire_func_2(void *data)
     expire_check[index]++;
 }
 
+static ogs_timer_mgr_t *test_timer_mgr_create(void *data)
+{
+    if (data)
+        return ogs_timer_mgr_create_wheel(512);
+    else
+        return ogs_timer_mgr_create(512);
+}
+
 /* basic timer Test */
 static void test1_func(abts_case *tc, void *data)
 {
@@ -51,7 +59,7 @@ static void test1_func(abts_case *tc, void *data)
 
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
 
-    timer = ogs_timer_mgr_create(512);
+    timer = test_timer_mgr_create(data);
     pollset = ogs_pollset_create(512);
     ogs_assert(timer);
     for(n = 0; n < sizeof(timer_duration)/sizeof(ogs_time_t); n++) {
@@ -126,7 +134,7 @@ static void test2_func(abts_case *tc, void *data)
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
     memset(tm_num, 0, sizeof(int)*(TEST_DURATION/TEST_TIMER_PRECISION));
 
-    timer = ogs_timer_mgr_create(512);
+    timer = test_timer_mgr_create(data);
     ogs_assert(timer);
 
     for(n = 0; n < TEST_TIMER_NUM; n++) {
@@ -168,7 +176,7 @@ static void test3_func(abts_case *tc, void *data)
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
     memset(tm_num, 0, sizeof(int)*(TEST_DURATION/TEST_TIMER_PRECISION));
 
-    timer = ogs_timer_mgr_create(512);
+    timer = test_timer_mgr_create(data);
     ogs_assert(timer);
 
     for(n = 0; n < TEST_TIMER_NUM; n++) {
@@ -208,6 +216,77 @@ static void test3_func(abts_case *tc, void *data)
     ogs_timer_mgr_destroy(timer);
 }
 
+static ogs_timer_t *test4_timer[2];
+
+void test_expire_func_4(void *data)
+{
+    int index = (uintptr_t)data;
+
+    expire_check[index]++;
+
+    /* Stop the other timer of the same batch */
+    ogs_timer_stop(test4_timer[!index]);
+}
+
+/* timing wheel Test */
+static void test4_func(abts_case *tc, void *data)
+{
+    int n = 0;
+    ogs_time_t next;
+    ogs_timer_mgr_t *timer = NULL;
+    ogs_timer_t *long_timer = NULL;
+
+    memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
+
+    timer = ogs_timer_mgr_create_wheel(512);
+    ogs_assert(timer);
+
+    ABTS_INT_EQUAL(tc, OGS_INFINITE_TIME, ogs_timer_mgr_next(timer));
+
+    /* Cascaded from the upper levels before it expires */
+    long_timer = ogs_timer_add(timer, test_expire_func_1, (void*)(uintptr_t)2);
+    ogs_assert(long_timer);
+    ogs_timer_start(long_timer, ogs_time_from_sec(3600));
+
+    next = ogs_timer_mgr_next(timer);
+    ABTS_TRUE(tc, next > 0);
+    ABTS_TRUE(tc, next <= ogs_time_from_sec(3600));
+
+    for (n = 0; n < 2; n++) {
+        test4_timer[n] = ogs_timer_add(
+                timer, test_expire_func_4, (void*)(uintptr_t)n);
+        ogs_assert(test4_timer[n]);
+        ogs_timer_start(test4_timer[n], TEST_TIMER_PRECISION);
+    }
+
+    ogs_usleep(TEST_TIMER_PRECISION * 2);
+    ogs_timer_mgr_expire(timer);
+
+    ABTS_INT_EQUAL(tc, 1, expire_check[0]);
+    ABTS_INT_EQUAL(tc, 0, expire_check[1]);
+    ABTS_INT_EQUAL(tc, 0, expire_check[2]);
+
+    /* Restart and stop */
+    ogs_timer_start(test4_timer[1], TEST_TIMER_PRECISION);
+    ogs_timer_start(test4_timer[1], TEST_TIMER_PRECISION * 3);
+    ogs_timer_stop(long_timer);
+
+    ogs_usleep(TEST_TIMER_PRECISION * 2);
+    ogs_timer_mgr_expire(timer);
+    ABTS_INT_EQUAL(tc, 0, expire_check[1]);
+
+    ogs_usleep(TEST_TIMER_PRECISION * 2);
+    ogs_timer_mgr_expire(timer);
+    ABTS_INT_EQUAL(tc, 1, expire_check[1]);
+    ABTS_INT_EQUAL(tc, OGS_INFINITE_TIME, ogs_timer_mgr_next(timer));
+
+    ogs_timer_delete(long_timer);
+    for (n = 0; n < 2; n++)
+        ogs_timer_delete(test4_timer[n]);
+
+    ogs_timer_mgr_destroy(timer);
+}
+
 abts_suite *test_timer(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -215,6 +294,9 @@ abts_suite *test_timer(abts_suite *suite)
     abts_run_test(suite, test1_func, NULL);
     abts_run_test(suite, test2_func, NULL);
     abts_run_test(suite, test3_func, NULL);
+    abts_run_test(suite, test2_func, (void *)1);
+    abts_run_test(suite, test3_func, (void *)1);
+    abts_run_test(suite, test4_func, NULL);
 
     return suite;
 }
@@ -25,6 +25,7 @@ extern int __ogs_ngap_domain;
 extern int __ogs_nas_domain;
 extern int __ogs_gtp_domain;
 extern int __ogs_sbi_domain;
+extern int __ogs_pfcp_domain;
 
 void ogs_sbi_message_init(int num_of_request_pool, int num_of_response_pool);
 void ogs_sbi_message_final(void);
@@ -36,6 +37,10 @@ abts_suite *test_ngap_message(abts_suite *suite);
 abts_suite *test_sbi_message(abts_suite *suite);
 abts_suite *test_security(abts_suite *suite);
 abts_suite *test_crash(abts_suite *suite);
+abts_suite *test_pfcp_packet(abts_suite *suite);
+abts_suite *test_pfcp_teid(abts_suite *suite);
+abts_suite *test_pfcp_buffer(abts_suite *suite);
+abts_suite *test_upf_lpm(abts_suite *suite);
 
 const struct testlist {
     abts_suite *(*func)(abts_suite *suite);
@@ -47,6 +52,10 @@ const struct testlist {
     {test_sbi_message},
     {test_security},
     {test_crash},
+    {test_pfcp_packet},
+    {test_pfcp_teid},
+    {test_pfcp_buffer},
+    {test_upf_lpm},
     {NULL},
 };
 
@@ -105,6 +114,7 @@ int main(int argc, const char *const argv[])
     ogs_log_install_domain(&__ogs_nas_domain, "nas", OGS_LOG_ERROR);
     ogs_log_install_domain(&__ogs_gtp_domain, "gtp", OGS_LOG_ERROR);
     ogs_log_install_domain(&__ogs_sbi_domain, "sbi", OGS_LOG_ERROR);
+    ogs_log_install_domain(&__ogs_pfcp_domain, "pfcp", OGS_LOG_ERROR);
 
     atexit(terminate);
 
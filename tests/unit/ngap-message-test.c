@@ -184,6 +184,162 @@ static void ngap_message_test4(abts_case *tc, void *data)
     ogs_pkbuf_free(pkbuf);
 }
 
+/*
+ * ogs_asn_copy_ie() must give the same structure as the former
+ * APER encode/decode round-trip. Both are compared on the wire.
+ */
+static void ngap_copy_ie_test(abts_case *tc,
+        const asn_TYPE_descriptor_t *td, void *src, size_t size)
+{
+    void *copy = NULL, *round_trip = NULL;
+    uint8_t *buf1 = NULL, *buf2 = NULL;
+    asn_enc_rval_t enc_ret = {0};
+    asn_dec_rval_t dec_ret = {0};
+    size_t len;
+    int rv;
+
+    copy = ogs_calloc(1, size);
+    ogs_assert(copy);
+    round_trip = ogs_calloc(1, size);
+    ogs_assert(round_trip);
+    buf1 = ogs_calloc(1, OGS_MAX_SDU_LEN);
+    ogs_assert(buf1);
+    buf2 = ogs_calloc(1, OGS_MAX_SDU_LEN);
+    ogs_assert(buf2);
+
+    rv = ogs_asn_copy_ie(td, src, copy);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    enc_ret = aper_encode_to_buffer(td, NULL, src, buf1, OGS_MAX_SDU_LEN);
+    ABTS_TRUE(tc, enc_ret.encoded > 0);
+    len = (enc_ret.encoded + 7) / 8;
+
+    dec_ret = aper_decode(NULL, td, &round_trip, buf1, len, 0, 0);
+    ABTS_INT_EQUAL(tc, 0, dec_ret.code);
+
+    enc_ret = aper_encode_to_buffer(td, NULL, round_trip, buf1, OGS_MAX_SDU_LEN);
+    ABTS_INT_EQUAL(tc, len, (enc_ret.encoded + 7) / 8);
+    enc_ret = aper_encode_to_buffer(td, NULL, copy, buf2, OGS_MAX_SDU_LEN);
+    ABTS_INT_EQUAL(tc, len, (enc_ret.encoded + 7) / 8);
+    ABTS_TRUE(tc, memcmp(buf1, buf2, len) == 0);
+
+    ogs_asn_free(td, copy);
+    ogs_asn_free(td, round_trip);
+
+    ogs_free(copy);
+    ogs_free(round_trip);
+    ogs_free(buf1);
+    ogs_free(buf2);
+}
+
+static void ngap_message_test5(abts_case *tc, void *data)
+{
+    /* NGSetupRequest */
+    const char *payload =
+        "0015004200000500 1b00090009f10728 000800000052400b 0400354720674e42"
+        "2d43550066000d00 000000010009f107 0000000800154001 0001114009403035"
+        "484c41423032";
+
+    ogs_ngap_message_t message;
+    ogs_pkbuf_t *pkbuf;
+    int result, i;
+    char hexbuf[OGS_HUGE_LEN];
+
+    ogs_plmn_id_t plmn_id;
+    ogs_5gs_tai_t tai;
+
+    NGAP_SONConfigurationTransfer_t SONConfigurationTransfer;
+    NGAP_GlobalRANNodeID_t *globalRANNodeID = NULL;
+    NGAP_GlobalGNB_ID_t *globalGNB_ID = NULL;
+
+    NGAP_RANStatusTransfer_TransparentContainer_t
+        RANStatusTransfer_TransparentContainer;
+    NGAP_DRBsSubjectToStatusTransferItem_t *StatusTransferItem = NULL;
+    NGAP_DRBStatusUL12_t *dRBStatusUL12 = NULL;
+    NGAP_DRBStatusDL18_t *dRBStatusDL18 = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf,
+            ogs_hex_from_string(payload, hexbuf, sizeof(hexbuf)), 70);
+
+    result = ogs_ngap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, 0, result);
+    ngap_copy_ie_test(tc, &asn_DEF_NGAP_NGAP_PDU, &message, sizeof(message));
+    ogs_ngap_free(&message);
+
+    ogs_pkbuf_free(pkbuf);
+
+    /* SONConfigurationTransfer */
+    memset(&SONConfigurationTransfer, 0, sizeof(SONConfigurationTransfer));
+
+    ogs_plmn_id_build(&plmn_id, 999, 70, 2);
+    memcpy(&tai.plmn_id, &plmn_id, OGS_PLMN_ID_LEN);
+    tai.tac.v = 1;
+
+    globalRANNodeID = &SONConfigurationTransfer.targetRANNodeID.globalRANNodeID;
+    globalRANNodeID->present = NGAP_GlobalRANNodeID_PR_globalGNB_ID;
+    globalRANNodeID->choice.globalGNB_ID = globalGNB_ID =
+        CALLOC(1, sizeof(*globalGNB_ID));
+    ogs_asn_buffer_to_OCTET_STRING(
+            &plmn_id, OGS_PLMN_ID_LEN, &globalGNB_ID->pLMNIdentity);
+    ogs_ngap_uint32_to_GNB_ID(0x4000, 22, &globalGNB_ID->gNB_ID);
+    ogs_ngap_5gs_tai_to_ASN(&tai,
+            &SONConfigurationTransfer.targetRANNodeID.selectedTAI);
+
+    globalRANNodeID = &SONConfigurationTransfer.sourceRANNodeID.globalRANNodeID;
+    globalRANNodeID->present = NGAP_GlobalRANNodeID_PR_globalGNB_ID;
+    globalRANNodeID->choice.globalGNB_ID = globalGNB_ID =
+        CALLOC(1, sizeof(*globalGNB_ID));
+    ogs_asn_buffer_to_OCTET_STRING(
+            &plmn_id, OGS_PLMN_ID_LEN, &globalGNB_ID->pLMNIdentity);
+    ogs_ngap_uint32_to_GNB_ID(0x4001, 32, &globalGNB_ID->gNB_ID);
+    ogs_ngap_5gs_tai_to_ASN(&tai,
+            &SONConfigurationTransfer.sourceRANNodeID.selectedTAI);
+
+    SONConfigurationTransfer.sONInformation.present =
+        NGAP_SONInformation_PR_sONInformationRequest;
+    SONConfigurationTransfer.sONInformation.choice.sONInformationRequest =
+        NGAP_SONInformationRequest_xn_TNL_configuration_info;
+
+    ngap_copy_ie_test(tc, &asn_DEF_NGAP_SONConfigurationTransfer,
+            &SONConfigurationTransfer, sizeof(SONConfigurationTransfer));
+    ogs_asn_free(&asn_DEF_NGAP_SONConfigurationTransfer,
+            &SONConfigurationTransfer);
+
+    /* RANStatusTransfer-TransparentContainer */
+    memset(&RANStatusTransfer_TransparentContainer, 0,
+            sizeof(RANStatusTransfer_TransparentContainer));
+
+    for (i = 0; i < 3; i++) {
+        StatusTransferItem = CALLOC(1, sizeof(*StatusTransferItem));
+        ASN_SEQUENCE_ADD(&RANStatusTransfer_TransparentContainer.
+                dRBsSubjectToStatusTransferList.list, StatusTransferItem);
+
+        StatusTransferItem->dRB_ID = i + 1;
+
+        StatusTransferItem->dRBStatusUL.present =
+            NGAP_DRBStatusUL_PR_dRBStatusUL12;
+        StatusTransferItem->dRBStatusUL.choice.dRBStatusUL12 = dRBStatusUL12 =
+            CALLOC(1, sizeof(*dRBStatusUL12));
+        dRBStatusUL12->uL_COUNTValue.pDCP_SN12 = 1;
+        dRBStatusUL12->uL_COUNTValue.hFN_PDCP_SN12 = 2;
+
+        StatusTransferItem->dRBStatusDL.present =
+            NGAP_DRBStatusDL_PR_dRBStatusDL18;
+        StatusTransferItem->dRBStatusDL.choice.dRBStatusDL18 = dRBStatusDL18 =
+            CALLOC(1, sizeof(*dRBStatusDL18));
+        dRBStatusDL18->dL_COUNTValue.pDCP_SN18 = 3;
+        dRBStatusDL18->dL_COUNTValue.hFN_PDCP_SN18 = 4;
+    }
+
+    ngap_copy_ie_test(tc, &asn_DEF_NGAP_RANStatusTransfer_TransparentContainer,
+            &RANStatusTransfer_TransparentContainer,
+            sizeof(RANStatusTransfer_TransparentContainer));
+    ogs_asn_free(&asn_DEF_NGAP_RANStatusTransfer_TransparentContainer,
+            &RANStatusTransfer_TransparentContainer);
+}
+
 abts_suite *test_ngap_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -194,6 +350,7 @@ abts_suite *test_ngap_message(abts_suite *suite)
     abts_run_test(suite, ngap_message_test2, NULL);
     abts_run_test(suite, ngap_message_test3, NULL);
     abts_run_test(suite, ngap_message_test4, NULL);
+    abts_run_test(suite, ngap_message_test5, NULL);
 
     return suite;
 }
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+#define SMALL_SIZE  100
+#define BIG_SIZE    1000
+
+static int64_t saved_budget;
+static int saved_packets;
+
+static void buffer_init(int64_t budget, int packets)
+{
+    ogs_pfcp_buffer_stat_t stat;
+
+    saved_budget = ogs_pfcp_self()->buffer.budget;
+    saved_packets = ogs_pfcp_self()->buffer.packets;
+    ogs_pfcp_self()->buffer.budget = budget;
+    ogs_pfcp_self()->buffer.packets = packets;
+
+    ogs_pfcp_buffer_init();
+    ogs_pfcp_buffer_stat(&stat);
+}
+
+static void buffer_final(void)
+{
+    ogs_pfcp_buffer_final();
+
+    ogs_pfcp_self()->buffer.budget = saved_budget;
+    ogs_pfcp_self()->buffer.packets = saved_packets;
+}
+
+/* Packet carrying its sequence number */
+static ogs_pkbuf_t *packet(unsigned int size, int seq)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, size);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf, &seq, sizeof(seq));
+
+    return pkbuf;
+}
+
+/* Octets charged to the budget for a packet of this size */
+static int64_t packet_octets(unsigned int size)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    int64_t octets;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, size);
+    ogs_assert(pkbuf);
+    octets = pkbuf->end - pkbuf->head;
+    ogs_pkbuf_free(pkbuf);
+
+    return octets;
+}
+
+/* Sequence number of the next packet to flush, or -1 */
+static int pop_seq(ogs_pfcp_far_t *far)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    int seq;
+
+    pkbuf = ogs_pfcp_buffer_pop(far);
+    if (!pkbuf)
+        return -1;
+
+    memcpy(&seq, pkbuf->data, sizeof(seq));
+    ogs_pkbuf_free(pkbuf);
+
+    return seq;
+}
+
+/* Ring growth up to the BAR, or to buffer.packets without it */
+static void pfcp_buffer_test1(abts_case *tc, void *data)
+{
+    ogs_pfcp_sess_t sess;
+    ogs_pfcp_bar_t bar;
+    ogs_pfcp_far_t far1, far2;
+    ogs_pfcp_buffer_stat_t stat;
+    int i;
+
+    buffer_init(OGS_PFCP_DEFAULT_BUFFER_BUDGET, 12);
+
+    memset(&sess, 0, sizeof(sess));
+    memset(&bar, 0, sizeof(bar));
+    memset(&far1, 0, sizeof(far1));
+    memset(&far2, 0, sizeof(far2));
+
+    bar.suggested_buffering_packets_count = 20;
+    sess.bar = &bar;
+    far1.sess = &sess;
+
+    /* Beyond the first ring, then beyond the limit */
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 0)));
+    for (i = 1; i < 25; i++)
+        ABTS_TRUE(tc, !ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, i)));
+
+    for (i = 5; i < 25; i++)
+        ABTS_INT_EQUAL(tc, i, pop_seq(&far1));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far1));
+
+    ogs_pfcp_buffer_stat(&stat);
+    ABTS_INT_EQUAL(tc, 25, stat.buffered);
+    ABTS_INT_EQUAL(tc, 5, stat.dropped);
+    ABTS_INT_EQUAL(tc, 20, stat.flushed);
+
+    /* No session, no BAR */
+    for (i = 0; i < 15; i++)
+        ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, i));
+
+    for (i = 3; i < 15; i++)
+        ABTS_INT_EQUAL(tc, i, pop_seq(&far2));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far2));
+
+    ogs_pfcp_buffer_stat(&stat);
+    ABTS_INT_EQUAL(tc, 15, stat.buffered);
+    ABTS_INT_EQUAL(tc, 3, stat.dropped);
+    ABTS_INT_EQUAL(tc, 12, stat.flushed);
+
+    buffer_final();
+}
+
+/* A full ring gives up its own oldest packet */
+static void pfcp_buffer_test2(abts_case *tc, void *data)
+{
+    ogs_pfcp_far_t far1, far2;
+    ogs_pfcp_buffer_stat_t stat;
+    int i;
+
+    buffer_init(OGS_PFCP_DEFAULT_BUFFER_BUDGET, 3);
+
+    memset(&far1, 0, sizeof(far1));
+    memset(&far2, 0, sizeof(far2));
+
+    for (i = 0; i < 3; i++)
+        ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, i));
+    for (i = 10; i < 12; i++)
+        ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, i));
+
+    ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 3));
+
+    ABTS_INT_EQUAL(tc, 1, pop_seq(&far1));
+    ABTS_INT_EQUAL(tc, 2, pop_seq(&far1));
+    ABTS_INT_EQUAL(tc, 3, pop_seq(&far1));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far1));
+
+    /* The other FAR keeps all of its packets */
+    ABTS_INT_EQUAL(tc, 10, pop_seq(&far2));
+    ABTS_INT_EQUAL(tc, 11, pop_seq(&far2));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far2));
+
+    ogs_pfcp_buffer_stat(&stat);
+    ABTS_INT_EQUAL(tc, 6, stat.buffered);
+    ABTS_INT_EQUAL(tc, 1, stat.dropped);
+    ABTS_INT_EQUAL(tc, 5, stat.flushed);
+
+    buffer_final();
+}
+
+/* The budget is made up from the longest buffering FAR first */
+static void pfcp_buffer_test3(abts_case *tc, void *data)
+{
+    ogs_pfcp_far_t far1, far2, far3;
+    ogs_pfcp_buffer_stat_t stat;
+    int64_t small = packet_octets(SMALL_SIZE);
+    int i;
+
+    buffer_init(small * 10, 100);
+
+    memset(&far1, 0, sizeof(far1));
+    memset(&far2, 0, sizeof(far2));
+    memset(&far3, 0, sizeof(far3));
+
+    for (i = 0; i < 6; i++)
+        ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, i));
+    for (i = 10; i < 14; i++)
+        ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, i));
+
+    /* The oldest packet of far1, not of far2 */
+    ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, 14));
+    ABTS_INT_EQUAL(tc, 1, pop_seq(&far1));
+
+    /* far1 gives up everything else before far2 gives up anything */
+    for (i = 20; i < 25; i++)
+        ogs_pfcp_buffer_push(&far3, packet(SMALL_SIZE, i));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far1));
+    ABTS_INT_EQUAL(tc, 10, pop_seq(&far2));
+
+    /* Then far2, which has been buffering longer than far3 */
+    ogs_pfcp_buffer_push(&far3, packet(SMALL_SIZE, 25));
+    ogs_pfcp_buffer_push(&far3, packet(SMALL_SIZE, 26));
+    for (i = 12; i < 15; i++)
+        ABTS_INT_EQUAL(tc, i, pop_seq(&far2));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far2));
+    for (i = 20; i < 27; i++)
+        ABTS_INT_EQUAL(tc, i, pop_seq(&far3));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far3));
+
+    ogs_pfcp_buffer_stat(&stat);
+    ABTS_INT_EQUAL(tc, 18, stat.buffered);
+    ABTS_INT_EQUAL(tc, 6, stat.dropped);
+    ABTS_INT_EQUAL(tc, 12, stat.flushed);
+
+    buffer_final();
+}
+
+/* A push that drains the ring of its own FAR */
+static void pfcp_buffer_test4(abts_case *tc, void *data)
+{
+    ogs_pfcp_far_t far1, far2;
+    ogs_pfcp_buffer_stat_t stat;
+    int64_t small = packet_octets(SMALL_SIZE);
+    int64_t big = packet_octets(BIG_SIZE);
+    int i, n, seq;
+
+    /* far1 is the oldest, far2 has to give up some packets as well */
+    n = big / small + 4;
+    buffer_init(small * (n + 1), 100);
+
+    memset(&far1, 0, sizeof(far1));
+    memset(&far2, 0, sizeof(far2));
+
+    ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 0));
+    for (i = 0; i < n; i++)
+        ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, 100 + i));
+
+    ogs_pfcp_buffer_push(&far1, packet(BIG_SIZE, 1));
+    ABTS_INT_EQUAL(tc, 1, pop_seq(&far1));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far1));
+
+    /* far2 has given up its oldest packets only */
+    seq = pop_seq(&far2);
+    ABTS_TRUE(tc, seq > 100 && seq < 100 + n);
+    for (i = seq + 1; i < 100 + n; i++)
+        ABTS_INT_EQUAL(tc, i, pop_seq(&far2));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far2));
+
+    ogs_pfcp_buffer_stat(&stat);
+    ABTS_INT_EQUAL(tc, n + 2, stat.buffered);
+    ABTS_INT_EQUAL(tc, 1 + seq - 100, stat.dropped);
+    ABTS_INT_EQUAL(tc, 1 + 100 + n - seq, stat.flushed);
+
+    buffer_final();
+
+    /* far1 is the only FAR : it drains its ring, then drops */
+    buffer_init(big, 100);
+
+    memset(&far1, 0, sizeof(far1));
+
+    ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 0));
+    ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 1));
+    ogs_pfcp_buffer_push(&far1, packet(BIG_SIZE, 2));
+
+    /* Larger than the whole budget */
+    ogs_pfcp_buffer_push(&far1, packet(BIG_SIZE * 2, 3));
+
+    ABTS_INT_EQUAL(tc, 2, pop_seq(&far1));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far1));
+
+    ogs_pfcp_buffer_stat(&stat);
+    ABTS_INT_EQUAL(tc, 3, stat.buffered);
+    ABTS_INT_EQUAL(tc, 3, stat.dropped);
+    ABTS_INT_EQUAL(tc, 1, stat.flushed);
+
+    buffer_final();
+}
+
+/* The report is re-armed by a flush or a clear only */
+static void pfcp_buffer_test5(abts_case *tc, void *data)
+{
+    ogs_pfcp_far_t far1, far2;
+    int64_t small = packet_octets(SMALL_SIZE);
+
+    buffer_init(small * 2, 100);
+
+    memset(&far1, 0, sizeof(far1));
+    memset(&far2, 0, sizeof(far2));
+
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 0)));
+    ABTS_TRUE(tc, !ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 1)));
+
+    /* Every packet of far1 evicted */
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, 10)));
+    ABTS_TRUE(tc, !ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, 11)));
+    ABTS_PTR_EQUAL(tc, NULL, far1.buffer);
+    ABTS_TRUE(tc, far1.buffer_reported);
+    ABTS_TRUE(tc, !ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 2)));
+
+    /* Not by a partial flush */
+    ABTS_INT_EQUAL(tc, 11, pop_seq(&far2));
+    ABTS_TRUE(tc, !ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, 12)));
+
+    ABTS_INT_EQUAL(tc, 12, pop_seq(&far2));
+    ABTS_INT_EQUAL(tc, -1, pop_seq(&far2));
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far2, packet(SMALL_SIZE, 13)));
+
+    ogs_pfcp_buffer_clear(&far1);
+    ABTS_PTR_EQUAL(tc, NULL, far1.buffer);
+    ABTS_TRUE(tc, !far1.buffer_reported);
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far1, packet(SMALL_SIZE, 3)));
+
+    buffer_final();
+}
+
+abts_suite *test_pfcp_buffer(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, pfcp_buffer_test1, NULL);
+    abts_run_test(suite, pfcp_buffer_test2, NULL);
+    abts_run_test(suite, pfcp_buffer_test3, NULL);
+    abts_run_test(suite, pfcp_buffer_test4, NULL);
+    abts_run_test(suite, pfcp_buffer_test5, NULL);
+
+    return suite;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+static ogs_pkbuf_t *packet_from_hex(const char *hex)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    char buf[OGS_HUGE_LEN];
+    int len;
+
+    len = strlen(hex) / 2;
+    ogs_assert(len <= sizeof(buf));
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf, ogs_hex_from_string(hex, buf, len), len);
+
+    return pkbuf;
+}
+
+/* UDP 2000 -> 3000 */
+static void pfcp_packet_test1(abts_case *tc, void *data)
+{
+    int rv;
+    ogs_pfcp_packet_info_t info;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    pkbuf = packet_from_hex(
+        "60000000000811ff"
+        "20010db8000000000000000000000001"
+        "20010db8000000000000000000000002"
+        "07d00bb800080000");
+
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 6, info.version);
+    ABTS_INT_EQUAL(tc, 17, info.proto);
+    ABTS_INT_EQUAL(tc, 40, info.hlen);
+    ABTS_TRUE(tc, info.has_port);
+    ABTS_INT_EQUAL(tc, 2000, info.src_port);
+    ABTS_INT_EQUAL(tc, 3000, info.dst_port);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
+/* Hop-by-Hop Options, then UDP 2000 -> 3000 */
+static void pfcp_packet_test2(abts_case *tc, void *data)
+{
+    int rv;
+    ogs_pfcp_packet_info_t info;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    pkbuf = packet_from_hex(
+        "60000000001000ff"
+        "20010db8000000000000000000000001"
+        "20010db8000000000000000000000002"
+        "1100010400000000"
+        "07d00bb800080000");
+
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 17, info.proto);
+    ABTS_INT_EQUAL(tc, 48, info.hlen);
+    ABTS_TRUE(tc, info.has_port);
+    ABTS_INT_EQUAL(tc, 3000, info.dst_port);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
+/* Zero Payload Length with No Next Header */
+static void pfcp_packet_test3(abts_case *tc, void *data)
+{
+    int rv;
+    ogs_pfcp_packet_info_t info;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    pkbuf = packet_from_hex(
+        "6000000000003bff"
+        "20010db8000000000000000000000001"
+        "20010db8000000000000000000000002");
+
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 59, info.proto);
+    ABTS_INT_EQUAL(tc, 40, info.hlen);
+    ABTS_TRUE(tc, info.has_port == false);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
+/* Truncated extension headers */
+static void pfcp_packet_test4(abts_case *tc, void *data)
+{
+    int rv;
+    ogs_pfcp_packet_info_t info;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    /* Hop-by-Hop Options of 16 octets, but only 8 received */
+    pkbuf = packet_from_hex(
+        "60000000001000ff"
+        "20010db8000000000000000000000001"
+        "20010db8000000000000000000000002"
+        "1101010400000000");
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+    ogs_pkbuf_free(pkbuf);
+
+    /* Destination Options cut within its first 8 octets */
+    pkbuf = packet_from_hex(
+        "6000000000043cff"
+        "20010db8000000000000000000000001"
+        "20010db8000000000000000000000002"
+        "11000104");
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+    ogs_pkbuf_free(pkbuf);
+
+    /* Jumbo Payload without the Hop-by-Hop Options */
+    pkbuf = packet_from_hex(
+        "60000000000000ff"
+        "20010db8000000000000000000000001"
+        "20010db8000000000000000000000002");
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+    ogs_pkbuf_free(pkbuf);
+}
+
+/* IPv4 header length out of range */
+static void pfcp_packet_test5(abts_case *tc, void *data)
+{
+    int rv;
+    ogs_pfcp_packet_info_t info;
+    ogs_pkbuf_t *pkbuf = NULL;
+
+    /* UDP 2000 -> 3000 */
+    pkbuf = packet_from_hex(
+        "45000024000000004011f7d5"
+        "0a2d0002"
+        "08080808"
+        "07d00bb800100000"
+        "0000000000000000");
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 4, info.version);
+    ABTS_INT_EQUAL(tc, 20, info.hlen);
+    ABTS_TRUE(tc, info.has_port);
+    ABTS_INT_EQUAL(tc, 3000, info.dst_port);
+    ogs_pkbuf_free(pkbuf);
+
+    /* IHL of 4 : shorter than the fixed header */
+    pkbuf = packet_from_hex(
+        "44000024000000004011f7d5"
+        "0a2d0002"
+        "08080808"
+        "07d00bb800100000"
+        "0000000000000000");
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+    ogs_pkbuf_free(pkbuf);
+
+    /* IHL of 15 : options beyond the end of the packet */
+    pkbuf = packet_from_hex(
+        "4f000024000000004011f7d5"
+        "0a2d0002"
+        "08080808"
+        "07d00bb800100000"
+        "0000000000000000");
+    rv = ogs_pfcp_packet_info_parse(&info, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+    ogs_pkbuf_free(pkbuf);
+}
+
+abts_suite *test_pfcp_packet(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, pfcp_packet_test1, NULL);
+    abts_run_test(suite, pfcp_packet_test2, NULL);
+    abts_run_test(suite, pfcp_packet_test3, NULL);
+    abts_run_test(suite, pfcp_packet_test4, NULL);
+    abts_run_test(suite, pfcp_packet_test5, NULL);
+
+    return suite;
+}
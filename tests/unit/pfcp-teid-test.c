@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+static ogs_pfcp_sess_t sess;
+static ogs_gtpu_resource_t resource;
+static uint64_t saved_pool_sess, saved_pool_nf;
+
+/* One session worth of PDRs, so that a TEID index is soon taken again */
+static void teid_context_init(uint8_t teidri, uint8_t teid_range)
+{
+    ogs_log_level_e level = ogs_log_get_domain_level(__ogs_pfcp_domain);
+
+    saved_pool_sess = ogs_app()->pool.sess;
+    saved_pool_nf = ogs_app()->pool.nf;
+    ogs_app()->pool.sess = 1;
+    ogs_app()->pool.nf = 1;
+
+    /* The context installs the pfcp domain again with the core level */
+    ogs_pfcp_context_init();
+    ogs_log_set_domain_level(__ogs_pfcp_domain, level);
+
+    ogs_pfcp_self()->up_function_features.ftup = 1;
+
+    memset(&sess, 0, sizeof(sess));
+    ogs_pfcp_pool_init(&sess);
+
+    memset(&resource, 0, sizeof(resource));
+    resource.info.v4 = 1;
+    resource.info.addr = htobe32(0x7f000001);
+    resource.info.teidri = teidri;
+    resource.info.teid_range = teid_range;
+    ogs_list_add(&ogs_gtp_self()->gtpu_resource_list, &resource);
+}
+
+static void teid_context_final(void)
+{
+    ogs_list_remove(&ogs_gtp_self()->gtpu_resource_list, &resource);
+
+    ogs_pfcp_pdr_remove_all(&sess);
+    ogs_pfcp_pool_final(&sess);
+
+    ogs_pfcp_context_final();
+
+    ogs_app()->pool.sess = saved_pool_sess;
+    ogs_app()->pool.nf = saved_pool_nf;
+}
+
+/* F-TEID with CH=1, or CHOOSE-ID if choose_id is not 0 */
+static ogs_pfcp_pdr_t *pdr_add_ch(uint8_t choose_id)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+
+    pdr = ogs_pfcp_pdr_add(&sess);
+    ogs_assert(pdr);
+
+    pdr->f_teid.ipv4 = 1;
+    pdr->f_teid.ch = 1;
+    if (choose_id) {
+        pdr->f_teid.chid = 1;
+        pdr->f_teid.choose_id = choose_id;
+    }
+    ogs_pfcp_object_teid_hash_set(OGS_PFCP_OBJ_PDR_TYPE, pdr, false);
+
+    return pdr;
+}
+
+/* F-TEID allocated by the CP function (CH=0) */
+static ogs_pfcp_pdr_t *pdr_add_teid(uint32_t teid)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+
+    pdr = ogs_pfcp_pdr_add(&sess);
+    ogs_assert(pdr);
+
+    pdr->f_teid.ipv4 = 1;
+    pdr->f_teid.teid = teid;
+    ogs_pfcp_object_teid_hash_set(OGS_PFCP_OBJ_PDR_TYPE, pdr, false);
+
+    return pdr;
+}
+
+/* Cycles through the free ids until the TEID index 'id' is taken again */
+static ogs_pfcp_pdr_t *pdr_add_ch_at(ogs_pool_id_t id)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    int i;
+
+    for (i = 0; i < OGS_MAX_NUM_OF_PDR; i++) {
+        pdr = ogs_pfcp_pdr_add(&sess);
+        ogs_assert(pdr);
+        if (pdr->teid == id)
+            break;
+        ogs_pfcp_pdr_remove(pdr);
+        pdr = NULL;
+    }
+    ogs_assert(pdr);
+
+    pdr->f_teid.ipv4 = 1;
+    pdr->f_teid.ch = 1;
+    ogs_pfcp_object_teid_hash_set(OGS_PFCP_OBJ_PDR_TYPE, pdr, false);
+
+    return pdr;
+}
+
+/* Stale generation */
+static void pfcp_teid_test1(abts_case *tc, void *data)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pool_id_t id;
+    uint32_t teid;
+
+    teid_context_init(0, 0);
+
+    pdr = pdr_add_ch(0);
+    id = pdr->teid;
+    teid = pdr->f_teid.teid;
+    ABTS_PTR_EQUAL(tc, &pdr->obj, ogs_pfcp_object_find_by_teid(teid));
+
+    ogs_pfcp_pdr_remove(pdr);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_object_find_by_teid(teid));
+
+    pdr = pdr_add_ch_at(id);
+    ABTS_TRUE(tc, pdr->f_teid.teid != teid);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_object_find_by_teid(teid));
+    ABTS_PTR_EQUAL(tc, &pdr->obj,
+            ogs_pfcp_object_find_by_teid(pdr->f_teid.teid));
+
+    teid_context_final();
+}
+
+/* CH=0 TEID with the index of a live slot */
+static void pfcp_teid_test2(abts_case *tc, void *data)
+{
+    ogs_pfcp_pdr_t *pdr1 = NULL, *pdr2 = NULL;
+    uint32_t teid1, teid2;
+
+    teid_context_init(0, 0);
+
+    pdr1 = pdr_add_ch(0);
+    teid1 = pdr1->f_teid.teid;
+
+    /* Same index, another generation */
+    teid2 = teid1 ^ (1 << 24);
+    pdr2 = pdr_add_teid(teid2);
+
+    ABTS_PTR_EQUAL(tc, &pdr1->obj, ogs_pfcp_object_find_by_teid(teid1));
+    ABTS_PTR_EQUAL(tc, &pdr2->obj, ogs_pfcp_object_find_by_teid(teid2));
+
+    ogs_pfcp_pdr_remove(pdr2);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_object_find_by_teid(teid2));
+    ABTS_PTR_EQUAL(tc, &pdr1->obj, ogs_pfcp_object_find_by_teid(teid1));
+
+    ogs_pfcp_pdr_remove(pdr1);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_object_find_by_teid(teid1));
+
+    teid_context_final();
+}
+
+/* TEIDRI:3, TEID Range:5 */
+static void pfcp_teid_test3(abts_case *tc, void *data)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    uint32_t teid;
+
+    teid_context_init(3, 5);
+
+    pdr = pdr_add_ch(0);
+    teid = pdr->f_teid.teid;
+    ABTS_INT_EQUAL(tc, 5, teid >> 29);
+
+    ABTS_PTR_EQUAL(tc, &pdr->obj, ogs_pfcp_object_find_by_teid(teid));
+    ABTS_PTR_EQUAL(tc, NULL,
+            ogs_pfcp_object_find_by_teid(teid & ~(7U << 29)));
+    ABTS_PTR_EQUAL(tc, NULL,
+            ogs_pfcp_object_find_by_teid(teid ^ (1U << 29)));
+
+    ogs_pfcp_pdr_remove(pdr);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_object_find_by_teid(teid));
+
+    teid_context_final();
+}
+
+/* Removal while the TEID is shared through CHOOSE-ID */
+static void pfcp_teid_test4(abts_case *tc, void *data)
+{
+    ogs_pfcp_pdr_t *pdr1 = NULL, *pdr2 = NULL, *pdr3 = NULL;
+    ogs_pool_id_t id;
+    uint32_t teid, teid3;
+
+    teid_context_init(0, 0);
+
+    pdr1 = pdr_add_ch(5);
+    pdr2 = pdr_add_ch(5);
+    id = pdr1->teid;
+    teid = pdr1->f_teid.teid;
+    ABTS_INT_EQUAL(tc, teid, pdr2->f_teid.teid);
+
+    /* The id of pdr1 is released, the TEID is still used by pdr2 */
+    ogs_pfcp_pdr_remove(pdr1);
+    ABTS_PTR_EQUAL(tc, &pdr2->obj, ogs_pfcp_object_find_by_teid(teid));
+
+    pdr3 = pdr_add_ch_at(id);
+    teid3 = pdr3->f_teid.teid;
+    ABTS_TRUE(tc, teid3 != teid);
+    ABTS_PTR_EQUAL(tc, &pdr2->obj, ogs_pfcp_object_find_by_teid(teid));
+    ABTS_PTR_EQUAL(tc, &pdr3->obj, ogs_pfcp_object_find_by_teid(teid3));
+
+    ogs_pfcp_pdr_remove(pdr2);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_object_find_by_teid(teid));
+    ABTS_PTR_EQUAL(tc, &pdr3->obj, ogs_pfcp_object_find_by_teid(teid3));
+
+    ogs_pfcp_pdr_remove(pdr3);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_object_find_by_teid(teid3));
+
+    teid_context_final();
+}
+
+abts_suite *test_pfcp_teid(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, pfcp_teid_test1, NULL);
+    abts_run_test(suite, pfcp_teid_test2, NULL);
+    abts_run_test(suite, pfcp_teid_test3, NULL);
+    abts_run_test(suite, pfcp_teid_test4, NULL);
+
+    return suite;
+}
@@ -1330,6 +1330,291 @@ static void s1ap_message_test10(abts_case *tc, void *data)
     ogs_pkbuf_free(s1apbuf);
 }
 
+/*
+ * ogs_asn_copy_ie() must give the same structure as the former
+ * APER encode/decode round-trip. Both are compared on the wire.
+ */
+static void s1ap_copy_ie_test(abts_case *tc,
+        const asn_TYPE_descriptor_t *td, void *src, size_t size)
+{
+    void *copy = NULL, *round_trip = NULL;
+    uint8_t *buf1 = NULL, *buf2 = NULL;
+    asn_enc_rval_t enc_ret = {0};
+    asn_dec_rval_t dec_ret = {0};
+    size_t len;
+    int rv;
+
+    copy = ogs_calloc(1, size);
+    ogs_assert(copy);
+    round_trip = ogs_calloc(1, size);
+    ogs_assert(round_trip);
+    buf1 = ogs_calloc(1, OGS_MAX_SDU_LEN);
+    ogs_assert(buf1);
+    buf2 = ogs_calloc(1, OGS_MAX_SDU_LEN);
+    ogs_assert(buf2);
+
+    rv = ogs_asn_copy_ie(td, src, copy);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    enc_ret = aper_encode_to_buffer(td, NULL, src, buf1, OGS_MAX_SDU_LEN);
+    ABTS_TRUE(tc, enc_ret.encoded > 0);
+    len = (enc_ret.encoded + 7) / 8;
+
+    dec_ret = aper_decode(NULL, td, &round_trip, buf1, len, 0, 0);
+    ABTS_INT_EQUAL(tc, 0, dec_ret.code);
+
+    enc_ret = aper_encode_to_buffer(td, NULL, round_trip, buf1, OGS_MAX_SDU_LEN);
+    ABTS_INT_EQUAL(tc, len, (enc_ret.encoded + 7) / 8);
+    enc_ret = aper_encode_to_buffer(td, NULL, copy, buf2, OGS_MAX_SDU_LEN);
+    ABTS_INT_EQUAL(tc, len, (enc_ret.encoded + 7) / 8);
+    ABTS_TRUE(tc, memcmp(buf1, buf2, len) == 0);
+
+    ogs_asn_free(td, copy);
+    ogs_asn_free(td, round_trip);
+
+    ogs_free(copy);
+    ogs_free(round_trip);
+    ogs_free(buf1);
+    ogs_free(buf2);
+}
+
+static void s1ap_message_test11(abts_case *tc, void *data)
+{
+    /* ENBConfigurationTransfer */
+    const char *payload =
+        "0028"
+        "403b000001008140 3440049699000004 3004969900020004 969900001f200496"
+        "9900020000000098 401341f0ac110e02 0000009940070200 f8ac110e02";
+
+    ogs_s1ap_message_t message;
+    ogs_pkbuf_t *pkbuf;
+    int result, i;
+    char hexbuf[OGS_HUGE_LEN];
+
+    S1AP_ENBConfigurationTransfer_t *ENBConfigurationTransfer = NULL;
+    S1AP_ENBConfigurationTransferIEs_t *ie = NULL;
+
+    S1AP_ENB_StatusTransfer_TransparentContainer_t
+        ENB_StatusTransfer_TransparentContainer;
+    S1AP_Bearers_SubjectToStatusTransfer_ItemIEs_t *ie2 = NULL;
+    S1AP_Bearers_SubjectToStatusTransfer_Item_t *item = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf,
+            ogs_hex_from_string(payload, hexbuf, sizeof(hexbuf)), 63);
+
+    result = ogs_s1ap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, 0, result);
+    s1ap_copy_ie_test(tc, &asn_DEF_S1AP_S1AP_PDU, &message, sizeof(message));
+
+    /* SONConfigurationTransfer */
+    ENBConfigurationTransfer = &message.choice.initiatingMessage->
+        value.choice.ENBConfigurationTransfer;
+    ABTS_INT_EQUAL(tc, 1, ENBConfigurationTransfer->protocolIEs.list.count);
+    ie = ENBConfigurationTransfer->protocolIEs.list.array[0];
+    ABTS_INT_EQUAL(tc,
+            S1AP_ProtocolIE_ID_id_SONConfigurationTransferECT, ie->id);
+    s1ap_copy_ie_test(tc, &asn_DEF_S1AP_SONConfigurationTransfer,
+            &ie->value.choice.SONConfigurationTransfer,
+            sizeof(S1AP_SONConfigurationTransfer_t));
+
+    ogs_s1ap_free(&message);
+    ogs_pkbuf_free(pkbuf);
+
+    /* ENB-StatusTransfer-TransparentContainer */
+    memset(&ENB_StatusTransfer_TransparentContainer, 0,
+            sizeof(ENB_StatusTransfer_TransparentContainer));
+
+    for (i = 0; i < 3; i++) {
+        ie2 = CALLOC(1, sizeof(*ie2));
+        ASN_SEQUENCE_ADD(&ENB_StatusTransfer_TransparentContainer.
+                bearers_SubjectToStatusTransferList.list, ie2);
+
+        ie2->id = S1AP_ProtocolIE_ID_id_Bearers_SubjectToStatusTransfer_Item;
+        ie2->criticality = S1AP_Criticality_ignore;
+        ie2->value.present = S1AP_Bearers_SubjectToStatusTransfer_ItemIEs__value_PR_Bearers_SubjectToStatusTransfer_Item;
+
+        item = &ie2->value.choice.Bearers_SubjectToStatusTransfer_Item;
+        item->e_RAB_ID = i + 5;
+        item->uL_COUNTvalue.pDCP_SN = 75;
+        item->dL_COUNTvalue.pDCP_SN = 17;
+    }
+
+    s1ap_copy_ie_test(tc,
+            &asn_DEF_S1AP_ENB_StatusTransfer_TransparentContainer,
+            &ENB_StatusTransfer_TransparentContainer,
+            sizeof(ENB_StatusTransfer_TransparentContainer));
+    ogs_asn_free(&asn_DEF_S1AP_ENB_StatusTransfer_TransparentContainer,
+            &ENB_StatusTransfer_TransparentContainer);
+}
+
+/* S1SetupRequest */
+static ogs_pkbuf_t *s1ap_setup_request(void)
+{
+    const char *payload =
+        "0011002d000004003b00090000f11040"
+        "54f64010003c400903004a4c542d3632"
+        "3100400007000c0e4000f11000894001"
+        "00";
+
+    ogs_pkbuf_t *pkbuf;
+    char hexbuf[OGS_HUGE_LEN];
+
+    pkbuf = ogs_pkbuf_alloc(NULL, OGS_MAX_SDU_LEN);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf,
+            ogs_hex_from_string(payload, hexbuf, sizeof(hexbuf)), 49);
+
+    return pkbuf;
+}
+
+static void s1ap_message_test12(abts_case *tc, void *data)
+{
+    ogs_s1ap_message_t message;
+    ogs_pkbuf_t *pkbuf;
+    int result;
+
+    pkbuf = s1ap_setup_request();
+
+    /* A failed decode leaves neither an arena nor a partial result */
+    pkbuf->len = 20;
+    result = ogs_s1ap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, result);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_asn_arena_find(&message));
+    ABTS_PTR_EQUAL(tc, NULL, message.choice.initiatingMessage);
+
+    pkbuf->len = 49;
+    result = ogs_s1ap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, result);
+    ABTS_PTR_NOTNULL(tc, ogs_asn_arena_find(&message));
+
+    /* A failed decode into a decoded structure releases the old one */
+    pkbuf->len = 20;
+    result = ogs_s1ap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, result);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_asn_arena_find(&message));
+
+    ogs_s1ap_free(&message);
+    ogs_pkbuf_free(pkbuf);
+}
+
+static void s1ap_message_test13(abts_case *tc, void *data)
+{
+    ogs_s1ap_message_t message;
+    ogs_pkbuf_t *pkbuf, *encoded;
+    ogs_asn_arena_t *arena;
+    S1AP_InitiatingMessage_t *initiatingMessage;
+    int result, i;
+
+    pkbuf = s1ap_setup_request();
+
+    /* Decoding again at the same address replaces the arena */
+    for (i = 0; i < 3; i++) {
+        result = ogs_s1ap_decode(&message, pkbuf);
+        ABTS_INT_EQUAL(tc, OGS_OK, result);
+        arena = ogs_asn_arena_find(&message);
+        ABTS_PTR_NOTNULL(tc, arena);
+        ABTS_TRUE(tc, ogs_asn_arena_attached(arena));
+        ABTS_TRUE(tc, ogs_asn_arena_owns(message.choice.initiatingMessage));
+    }
+    ogs_s1ap_free(&message);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_asn_arena_find(&message));
+
+    /* A heap block stored in a decoded structure once it is detached */
+    result = ogs_s1ap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, result);
+
+    ogs_asn_detach(&message);
+    arena = ogs_asn_arena_find(&message);
+    ABTS_PTR_NOTNULL(tc, arena);
+    ABTS_TRUE(tc, ogs_asn_arena_attached(arena) == false);
+
+    initiatingMessage = CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
+    memcpy(initiatingMessage, message.choice.initiatingMessage,
+            sizeof(*initiatingMessage));
+    message.choice.initiatingMessage = initiatingMessage;
+    ABTS_TRUE(tc, ogs_asn_arena_owns(initiatingMessage) == false);
+
+    /* Freed field by field : the arena blocks below it are left alone */
+    ogs_s1ap_free(&message);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_asn_arena_find(&message));
+
+    /* Never freed, then a structure is built and encoded at that address */
+    result = ogs_s1ap_decode(&message, pkbuf);
+    ABTS_INT_EQUAL(tc, OGS_OK, result);
+
+    memset(&message, 0, sizeof(message));
+    message.present = S1AP_S1AP_PDU_PR_initiatingMessage;
+    message.choice.initiatingMessage =
+        CALLOC(1, sizeof(S1AP_InitiatingMessage_t));
+    ABTS_TRUE(tc,
+            ogs_asn_arena_owns(message.choice.initiatingMessage) == false);
+    message.choice.initiatingMessage->procedureCode =
+        S1AP_ProcedureCode_id_S1Setup;
+    message.choice.initiatingMessage->criticality = S1AP_Criticality_reject;
+    message.choice.initiatingMessage->value.present =
+        S1AP_InitiatingMessage__value_PR_S1SetupRequest;
+
+    encoded = ogs_s1ap_encode(&message);
+    ABTS_PTR_NOTNULL(tc, encoded);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_asn_arena_find(&message));
+
+    ogs_pkbuf_free(encoded);
+    ogs_pkbuf_free(pkbuf);
+}
+
+static void s1ap_message_test14(abts_case *tc, void *data)
+{
+    int owner;
+    ogs_asn_arena_t *arena;
+    char *ptr1, *ptr2, *ptr3, *heap;
+
+    arena = ogs_asn_arena_create(&owner, 0);
+    ABTS_PTR_NOTNULL(tc, arena);
+
+    ogs_asn_arena_enter(arena);
+
+    ptr1 = MALLOC(8);
+    ABTS_TRUE(tc, ogs_asn_arena_owns(ptr1));
+    memcpy(ptr1, "open5gs", 8);
+
+    /* The last block grows in place */
+    ptr2 = REALLOC(ptr1, 64);
+    ABTS_PTR_EQUAL(tc, ptr1, ptr2);
+    ABTS_STR_EQUAL(tc, "open5gs", ptr2);
+
+    ptr3 = CALLOC(1, 16);
+    ABTS_TRUE(tc, ogs_asn_arena_owns(ptr3));
+
+    /* Any other block is copied within the arena */
+    ptr1 = REALLOC(ptr2, 128);
+    ABTS_TRUE(tc, ptr1 != ptr2);
+    ABTS_TRUE(tc, ogs_asn_arena_owns(ptr1));
+    ABTS_STR_EQUAL(tc, "open5gs", ptr1);
+
+    /* Larger than the chunk : a new one is chained */
+    ptr2 = REALLOC(ptr1, 16384);
+    ABTS_TRUE(tc, ogs_asn_arena_owns(ptr2));
+    ABTS_STR_EQUAL(tc, "open5gs", ptr2);
+
+    ogs_asn_arena_leave(arena);
+
+    /* Still within the arena once left */
+    ptr1 = REALLOC(ptr2, 32768);
+    ABTS_TRUE(tc, ogs_asn_arena_owns(ptr1));
+    ABTS_STR_EQUAL(tc, "open5gs", ptr1);
+    FREEMEM(ptr1);
+
+    heap = MALLOC(8);
+    ABTS_TRUE(tc, ogs_asn_arena_owns(heap) == false);
+    heap = REALLOC(heap, 64);
+    ABTS_TRUE(tc, ogs_asn_arena_owns(heap) == false);
+    FREEMEM(heap);
+
+    ogs_asn_arena_destroy(arena);
+}
+
 abts_suite *test_s1ap_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -1346,6 +1631,10 @@ abts_suite *test_s1ap_message(abts_suite *suite)
     abts_run_test(suite, s1ap_message_test8, NULL);
     abts_run_test(suite, s1ap_message_test9, NULL);
     abts_run_test(suite, s1ap_message_test10, NULL);
+    abts_run_test(suite, s1ap_message_test11, NULL);
+    abts_run_test(suite, s1ap_message_test12, NULL);
+    abts_run_test(suite, s1ap_message_test13, NULL);
+    abts_run_test(suite, s1ap_message_test14, NULL);
 
     return suite;
 }
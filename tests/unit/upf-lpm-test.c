@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2019-2023 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+#include "core/abts.h"
+
+#include "upf/lpm.h"
+
+static void lpm_route(ogs_ipsubnet_t *route, const char *addr, int plen)
+{
+    char buf[OGS_ADDRSTRLEN];
+
+    ogs_snprintf(buf, sizeof(buf), "%d", plen);
+    ogs_assert(ogs_ipsubnet(route, addr, buf) == OGS_OK);
+}
+
+static void *lpm_find(upf_lpm_t *lpm, const char *addr)
+{
+    ogs_ipsubnet_t host;
+
+    lpm_route(&host, addr, strchr(addr, ':') ? 128 : 32);
+
+    return upf_lpm_find(lpm, host.sub);
+}
+
+static size_t lpm_memory(void)
+{
+#if OGS_USE_TALLOC == 1
+    return talloc_total_size(__ogs_talloc_core);
+#else
+    return 0;
+#endif
+}
+
+/* Longest match over the levels, and removal back to shorter prefixes */
+static void upf_lpm_test1(abts_case *tc, void *data)
+{
+    upf_lpm_t *lpm = NULL;
+    ogs_ipsubnet_t route[5];
+    char a, b, c, d, e;
+
+    lpm = upf_lpm_create(AF_INET);
+    ABTS_PTR_NOTNULL(tc, lpm);
+
+    lpm_route(&route[0], "10.45.0.0", 16);
+    lpm_route(&route[1], "10.45.1.0", 24);
+    lpm_route(&route[2], "10.45.1.128", 25);
+    lpm_route(&route[3], "10.45.16.0", 20);
+    lpm_route(&route[4], "10.45.17.0", 24);
+
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[0], &a));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[1], &b));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[2], &c));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[3], &d));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[4], &e));
+
+    ABTS_PTR_EQUAL(tc, &a, lpm_find(lpm, "10.45.2.1"));
+    ABTS_PTR_EQUAL(tc, &b, lpm_find(lpm, "10.45.1.1"));
+    ABTS_PTR_EQUAL(tc, &c, lpm_find(lpm, "10.45.1.200"));
+    ABTS_PTR_EQUAL(tc, &d, lpm_find(lpm, "10.45.18.1"));
+    ABTS_PTR_EQUAL(tc, &e, lpm_find(lpm, "10.45.17.1"));
+    ABTS_PTR_EQUAL(tc, NULL, lpm_find(lpm, "10.46.0.1"));
+
+    /* A shorter prefix of the same node takes the entries back */
+    upf_lpm_remove(lpm, &route[4], &e);
+    ABTS_PTR_EQUAL(tc, &d, lpm_find(lpm, "10.45.17.1"));
+
+    /* Or of an upper node */
+    upf_lpm_remove(lpm, &route[2], &c);
+    ABTS_PTR_EQUAL(tc, &b, lpm_find(lpm, "10.45.1.200"));
+    upf_lpm_remove(lpm, &route[1], &b);
+    ABTS_PTR_EQUAL(tc, &a, lpm_find(lpm, "10.45.1.200"));
+
+    upf_lpm_remove(lpm, &route[3], &d);
+    upf_lpm_remove(lpm, &route[0], &a);
+    ABTS_PTR_EQUAL(tc, NULL, lpm_find(lpm, "10.45.17.1"));
+
+    upf_lpm_destroy(lpm);
+}
+
+/* A prefix belongs to the last session that added it */
+static void upf_lpm_test2(abts_case *tc, void *data)
+{
+    upf_lpm_t *lpm = NULL;
+    ogs_ipsubnet_t route[2];
+    char a, b, c;
+
+    lpm = upf_lpm_create(AF_INET6);
+    ABTS_PTR_NOTNULL(tc, lpm);
+
+    lpm_route(&route[0], "2001:db8:cafe::", 48);
+    lpm_route(&route[1], "2001:db8:cafe:1::", 64);
+
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[0], &a));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[1], &b));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[1], &c));
+    ABTS_PTR_EQUAL(tc, &c, lpm_find(lpm, "2001:db8:cafe:1::1"));
+
+    /* The previous owner does not remove it */
+    upf_lpm_remove(lpm, &route[1], &b);
+    ABTS_PTR_EQUAL(tc, &c, lpm_find(lpm, "2001:db8:cafe:1::1"));
+
+    upf_lpm_remove(lpm, &route[1], &c);
+    ABTS_PTR_EQUAL(tc, &a, lpm_find(lpm, "2001:db8:cafe:1::1"));
+
+    upf_lpm_remove(lpm, &route[0], &a);
+    ABTS_PTR_EQUAL(tc, NULL, lpm_find(lpm, "2001:db8:cafe:1::1"));
+
+    upf_lpm_destroy(lpm);
+}
+
+/* Nodes are released with the last prefix going through them */
+static void upf_lpm_test3(abts_case *tc, void *data)
+{
+    upf_lpm_t *lpm = NULL;
+    ogs_ipsubnet_t route[3];
+    size_t memory;
+    char a, b, c;
+
+    lpm = upf_lpm_create(AF_INET6);
+    ABTS_PTR_NOTNULL(tc, lpm);
+
+    memory = lpm_memory();
+
+    lpm_route(&route[0], "2001:db8:cafe:1::", 64);
+    lpm_route(&route[1], "2001:db8:cafe:2::", 64);
+    lpm_route(&route[2], "2001:db8::", 32);
+
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[0], &a));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[1], &b));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[2], &c));
+
+    upf_lpm_remove(lpm, &route[0], &a);
+    ABTS_PTR_EQUAL(tc, &b, lpm_find(lpm, "2001:db8:cafe:2::1"));
+    ABTS_PTR_EQUAL(tc, &c, lpm_find(lpm, "2001:db8:cafe:1::1"));
+
+    upf_lpm_remove(lpm, &route[2], &c);
+    upf_lpm_remove(lpm, &route[1], &b);
+    ABTS_PTR_EQUAL(tc, NULL, lpm_find(lpm, "2001:db8:cafe:2::1"));
+    ABTS_INT_EQUAL(tc, memory, lpm_memory());
+
+    /* And built again */
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &route[0], &a));
+    ABTS_PTR_EQUAL(tc, &a, lpm_find(lpm, "2001:db8:cafe:1::1"));
+
+    upf_lpm_destroy(lpm);
+}
+
+/* The same prefix held by two sessions */
+static void upf_lpm_test4(abts_case *tc, void *data)
+{
+    upf_lpm_t *lpm = NULL;
+    ogs_ipsubnet_t a_route[2], b_route[2], host;
+    char a, b;
+
+    lpm = upf_lpm_create(AF_INET);
+    ABTS_PTR_NOTNULL(tc, lpm);
+
+    memset(a_route, 0, sizeof(a_route));
+    memset(b_route, 0, sizeof(b_route));
+    lpm_route(&a_route[0], "10.45.1.0", 24);
+    lpm_route(&b_route[0], "10.45.1.0", 24);
+    lpm_route(&host, "10.45.1.1", 32);
+
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &a_route[0], &a));
+    ABTS_INT_EQUAL(tc, OGS_OK, upf_lpm_add(lpm, &b_route[0], &b));
+    ABTS_TRUE(tc, upf_lpm_match(lpm, host.sub, &a, a_route, 2));
+    ABTS_TRUE(tc, upf_lpm_match(lpm, host.sub, &b, b_route, 2));
+
+    /* Session B leaves no entry behind, session A still holds the route */
+    upf_lpm_remove(lpm, &b_route[0], &b);
+    ABTS_PTR_EQUAL(tc, NULL, upf_lpm_find(lpm, host.sub));
+    ABTS_TRUE(tc, upf_lpm_match(lpm, host.sub, &a, a_route, 2));
+    ABTS_TRUE(tc, !upf_lpm_match(lpm, host.sub, &b, NULL, 0));
+
+    lpm_route(&host, "10.45.2.1", 32);
+    ABTS_TRUE(tc, !upf_lpm_match(lpm, host.sub, &a, a_route, 2));
+
+    upf_lpm_destroy(lpm);
+}
+
+abts_suite *test_upf_lpm(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, upf_lpm_test1, NULL);
+    abts_run_test(suite, upf_lpm_test2, NULL);
+    abts_run_test(suite, upf_lpm_test3, NULL);
+    abts_run_test(suite, upf_lpm_test4, NULL);
+
+    return suite;
+}